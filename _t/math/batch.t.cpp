@@ -0,0 +1,100 @@
+#include <assert.h>
+#include <math.h>
+#include <math/batch.hpp>
+
+using namespace lib::math;
+
+int main(int argc, char* argv[]){
+	int const count= 1003;
+
+	matrix_batch<3, 3> a(count), b(count);
+	vector_batch<3> x(count);
+
+	assert(a.size() == count && a.stride() % 8 == 0 && a.stride() >= count);
+	assert(a.component(1, 0) == a.data() + 3 * a.stride());
+
+	for(int k= 0; k < count; ++k){
+		double const s= k % 17 + 1.;
+
+		a.assign(k, matrix<3, 3>{{s, 1., 0.}, {0., 2., k % 5 * 1.}, {1., 0., 3.}});
+		b.assign(k, matrix<3, 3>{{1., 0., 2.}, {s, 1., 0.}, {0., k % 3 * 1., 1.}});
+		x.assign(k, vector<3>{1., -s, 2.});
+	}
+	assert(a[10][0][0] == 11.);
+	assert(x.at(1002)[1] == -(1002 % 17 + 1.));
+
+	// per-instance products agree with matrix
+	matrix_batch<3, 3> ab;
+	multiply(a, b, ab);
+	assert(ab.size() == count);
+
+	vector_batch<3> ax;
+	multiply(a, x, ax);
+
+	matrix<3, 3> const t{{0., -1., 0.}, {1., 0., 0.}, {0., 0., 1.}};
+	vector_batch<3> tx;
+	multiply(t, x, tx);
+
+	matrix_batch<3, 3> sum;
+	add(a, b, sum);
+
+	matrix_batch<3, 3> inv;
+	inverse(a, inv);
+
+	for(int k= 0; k < count; ++k){
+		matrix<3, 3> const p= a[k] * b[k];
+		matrix<3, 3> const q= ab[k];
+		matrix<3, 3> const r= sum[k];
+		vector<3> const y= a[k] * x[k];
+		vector<3> const z= t * x[k];
+		matrix<3, 3> const i= inverse(a[k]);
+		matrix<3, 3> const j= inv[k];
+
+		for(int m= 0; m < 3; ++m){
+			assert(y[m] == ax[k][m]);
+			assert(z[m] == tx[k][m]);
+			for(int n= 0; n < 3; ++n){
+				assert(p[m][n] == q[m][n]);
+				assert(r[m][n] == a[k][m][n] + b[k][m][n]);
+				assert(fabs(i[m][n] - j[m][n]) < 1e-12);
+			}
+		}
+	}
+
+	// in place, 4x4 and float
+	matrix_batch<4, 4, float> f(37);
+	for(int k= 0; k < 37; ++k)
+		f.assign(k, matrix<4, 4, float>{{2.f, 0.f, 0.f, k * 1.f}, {0.f, 4.f, 0.f, 0.f}, {0.f, 0.f, .5f, 1.f}, {0.f, 0.f, 0.f, 1.f}});
+	inverse(f, f);
+	assert(f[36][0][0] == .5f && f[36][0][3] == -18.f && f[36][2][3] == -2.f);
+
+	vector_batch<2> v(5), w(5);
+	v.assign(4, vector<2>{1., 2.});
+	w.assign(4, vector<2>{3., 4.});
+	add(v, w, v);
+	assert(v[4][0] == 4. && v[4][1] == 6. && v[0][0] == 0.);
+
+	// resizing keeps existing instances and zero-fills the new ones
+	v.resize(40);
+	assert(v.size() == 40 && v[4][1] == 6. && v[39][0] == 0.);
+
+	// a singular instance is reported
+	matrix_batch<2, 2> s(20);
+	for(int k= 0; k < 20; ++k)
+		s.assign(k, matrix<2, 2>{{1., 0.}, {0., 1.}});
+	s.assign(13, matrix<2, 2>{{1., 2.}, {2., 4.}});
+	try{
+		inverse(s, s);
+		assert(false);
+	}
+	catch(lib::exception::invalid_argument<> const&){
+	}
+	try{
+		multiply(a, matrix_batch<3, 3>(3), ab);
+		assert(false);
+	}
+	catch(lib::exception::invalid_argument<> const&){
+	}
+
+	return 0;
+}
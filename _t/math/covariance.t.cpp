@@ -0,0 +1,112 @@
+#include <math/covariance.hpp>
+#include <assert.h>
+#include <cmath>
+#include <vector>
+
+using namespace lib::math;
+
+namespace{
+
+// 標本i、変数jの値。変数どうしに相関を持たせ、平均を0から離しておく
+double sample(int i, int j){
+	double const common= std::sin(i * .37);
+
+	return 1000. + j + common * (j % 3 + 1) + std::cos(i * 1.3 + j) * .5;
+}
+
+}
+
+int main(int argc, char* argv[]){
+	int const n= 1000, d= 7;
+	dynamic_matrix<double> x(n, d);
+
+	for(int i= 0; i < n; ++i){
+		for(int j= 0; j < d; ++j)
+			x[i][j]= sample(i, j);
+	}
+
+	// 2回の走査で求めた基準値
+	std::vector<double> mean(d, 0.), cov(d * d, 0.);
+
+	for(int i= 0; i < n; ++i){
+		for(int j= 0; j < d; ++j)
+			mean[j]+= x[i][j] / n;
+	}
+	for(int i= 0; i < n; ++i){
+		for(int j= 0; j < d; ++j){
+			for(int k= 0; k < d; ++k)
+				cov[j * d + k]+= (x[i][j] - mean[j]) * (x[i][k] - mean[k]) / n;
+		}
+	}
+
+	covariance_accumulator<double> one(d), batch(d), merged(d), columns(d);
+
+	for(int i= 0; i < n; ++i)
+		one.push(x[i]);
+	batch.push(x);
+
+	// 転置して格納した標本(1列が1標本)もビューで渡せる
+	dynamic_matrix<double> xt(d, n);
+
+	for(int i= 0; i < n; ++i){
+		for(int j= 0; j < d; ++j)
+			xt[j][i]= x[i][j];
+	}
+	columns.push(transpose_view(xt));
+
+	{
+		covariance_accumulator<double> a(d), b(d);
+
+		a.push(block_view(x, 0, 0, 300, d));
+		b.push(block_view(x, 300, 0, n - 300, d));
+		merged.merge(a);
+		merged.merge(b);
+		merged.merge(covariance_accumulator<double>(d));
+	}
+
+	for(covariance_accumulator<double> const* s : {&one, &batch, &merged, &columns}){
+		dynamic_matrix<double> const c= s->covariance();
+		dynamic_matrix<double> const r= s->correlation();
+		dynamic_matrix<double> const u= s->sample_covariance();
+
+		assert(s->size() == n && s->dimension() == d);
+		for(int j= 0; j < d; ++j){
+			assert(std::abs(s->mean()[j] - mean[j]) < 1e-9);
+			for(int k= 0; k < d; ++k){
+				assert(std::abs(c[j][k] - cov[j * d + k]) < 1e-9);
+				assert(std::abs(u[j][k] - cov[j * d + k] * n / (n - 1)) < 1e-9);
+				assert(std::abs(r[j][k] - cov[j * d + k] / std::sqrt(cov[j * d + j] * cov[k * d + k])) < 1e-9);
+				assert(c[j][k] == c[k][j] || std::abs(c[j][k] - c[k][j]) < 1e-12);
+			}
+			assert(r[j][j] == 1.);
+		}
+	}
+
+	// 分散が0の変数
+	{
+		covariance_accumulator<float> s(2);
+
+		s.push(vector<2, float>({1.f, 5.f}));
+		s.push(vector<2, float>({3.f, 5.f}));
+
+		dynamic_matrix<float> const r= s.correlation();
+
+		assert(s.covariance()[0][0] == 1.f && s.covariance()[1][1] == 0.f);
+		assert(r[0][0] == 1.f && r[1][1] == 1.f && r[0][1] == 0.f);
+
+		s.clear();
+		assert(s.size() == 0 && s.mean()[0] == 0.f);
+
+		bool thrown= false;
+
+		try{
+			s.push(vector<3, float>());
+		}
+		catch(lib::exception::invalid_argument<> const&){
+			thrown= true;
+		}
+		assert(thrown);
+	}
+
+	return 0;
+}
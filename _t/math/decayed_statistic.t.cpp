@@ -0,0 +1,67 @@
+#include <math/decayed_statistic.hpp>
+#include <assert.h>
+#include <cmath>
+
+using namespace lib::math;
+
+int main(int argc, char* argv[]){
+	{
+		decayed_statistic s(10.);
+
+		assert(s.mean() == 0. && s.variance() == 0. && s.weight(0.) == 0.);
+
+		// 一定の値なら平均はその値、分散は0
+		for(int i= 0; i < 100; ++i)
+			s.push(i, 3.);
+		assert(std::abs(s.mean() - 3.) < 1e-12 && std::abs(s.variance()) < 1e-12);
+
+		// 重みの合計は1 / (1 - e^(-1/tau))に近づき、時間とともに減る
+		double const limit= 1. / (1. - std::exp(-.1));
+
+		assert(std::abs(s.weight(99.) - limit) < 1e-3);
+		assert(std::abs(s.weight(109.) - limit / std::exp(1.)) < 1e-3);
+
+		// 値が切り替わると時定数の数倍で新しい値に追従する
+		for(int i= 100; i < 200; ++i)
+			s.push(i, 5.);
+		assert(std::abs(s.mean() - 5.) < 2. * std::exp(-9.));
+	}
+	// 重み付き平均と分散は定義どおり
+	{
+		double const tau= 2.;
+		double const t[]= {0., 1., 1.5, 4., 4., 7.};
+		double const x[]= {1., 4., 2., 8., -1., 3.};
+		decayed_statistic s(tau);
+		double w= 0., wx= 0., wxx= 0.;
+
+		for(int i= 0; i < 6; ++i)
+			s.push(t[i], x[i]);
+		for(int i= 0; i < 6; ++i){
+			double const wi= std::exp(-(7. - t[i]) / tau);
+
+			w+= wi;
+			wx+= wi * x[i];
+			wxx+= wi * x[i] * x[i];
+		}
+
+		double const mean= wx / w;
+
+		assert(std::abs(s.weight(7.) - w) < 1e-12);
+		assert(std::abs(s.mean() - mean) < 1e-12);
+		assert(std::abs(s.variance() - (wxx / w - mean * mean)) < 1e-10);
+	}
+	// 一定の割合の発生回数
+	{
+		decayed_rate r(5.);
+
+		for(int i= 0; i < 6000; ++i)
+			r.mark(i * .01);
+		assert(std::abs(r.rate(60.) - 100.) < 1.);
+		assert(std::abs(r.rate(65.) - r.rate(60.) / std::exp(1.)) < 1e-9);
+
+		r.clear();
+		assert(r.rate(0.) == 0.);
+	}
+
+	return 0;
+}
@@ -0,0 +1,72 @@
+#include <assert.h>
+#include <math.h>
+#include <math/decomposition/cholesky.hpp>
+
+using namespace lib::math;
+
+int main(int argc, char* argv[]){
+	matrix<3, 3> const a{{4., 12., -16.}, {12., 37., -43.}, {-16., -43., 98.}};
+	cholesky_decomposition<3> const c(a);
+
+	// the textbook factor
+	assert(c.factor()[0][0] == 2. && c.factor()[1][0] == 6. && c.factor()[2][0] == -8.);
+	assert(c.factor()[1][1] == 1. && c.factor()[2][1] == 5. && c.factor()[2][2] == 3.);
+	assert(c.factor()[0][1] == 0. && c.factor()[0][2] == 0. && c.factor()[1][2] == 0.);
+	assert(fabs(c.determinant() - 36.) < 1e-9);
+
+	vector<3> const x= c.solve(a * vector<3>{1., -1., 2.});
+	assert(fabs(x[0] - 1.) < 1e-9 && fabs(x[1] + 1.) < 1e-9 && fabs(x[2] - 2.) < 1e-9);
+
+	// B^T*B + n*I spans several blocks
+	int const n= 200;
+	dynamic_matrix<> b(n, n);
+	for(int i= 0; i < n; ++i)
+		for(int j= 0; j < n; ++j)
+			b[i][j]= ((i * 13 + j * 7) % 17) / 17. - .5;
+
+	dynamic_matrix<> spd(n, n);
+	for(int i= 0; i < n; ++i){
+		for(int j= 0; j < n; ++j){
+			double s= (i == j) ? n : 0.;
+			for(int k= 0; k < n; ++k)
+				s+= b[k][i] * b[k][j];
+			spd[i][j]= s;
+		}
+	}
+
+	cholesky_decomposition<dynamic> const bc(spd);
+	dynamic_matrix<> const& l= bc.factor();
+	for(int i= 0; i < n; i+= 7){
+		for(int j= 0; j <= i; j+= 5){
+			double s= 0.;
+			for(int k= 0; k <= j; ++k)
+				s+= l[i][k] * l[j][k];
+			assert(fabs(s - spd[i][j]) < 1e-9 * n);
+		}
+	}
+
+	dynamic_matrix<> xs(n, 5);
+	for(int i= 0; i < n; ++i)
+		for(int j= 0; j < 5; ++j)
+			xs[i][j]= (i * 3 + j) % 7 - 3.;
+	dynamic_matrix<> const ys= bc.solve(dynamic_matrix<>(spd * xs));
+	for(int i= 0; i < n; ++i)
+		for(int j= 0; j < 5; ++j)
+			assert(fabs(ys[i][j] - xs[i][j]) < 1e-9);
+
+	dynamic_matrix<> const inv= bc.inverse();
+	dynamic_matrix<> const id= spd * inv;
+	for(int i= 0; i < n; ++i)
+		for(int j= 0; j < n; ++j)
+			assert(fabs(id[i][j] - (i == j ? 1. : 0.)) < 1e-9);
+
+	// not positive definite
+	try{
+		cholesky_decomposition<2>(matrix<2, 2>{{1., 2.}, {2., 1.}});
+		assert(false);
+	}
+	catch(lib::exception::invalid_argument<> const&){
+	}
+
+	return 0;
+}
@@ -0,0 +1,79 @@
+#include <assert.h>
+#include <math.h>
+#include <math/decomposition/lu.hpp>
+
+using namespace lib::math;
+
+template<class M>
+static double max_error(M const& a, M const& b){
+	double e= 0.;
+	for(int i= 0; i < a.rows(); ++i)
+		for(int j= 0; j < a.cols(); ++j)
+			e= fmax(e, fabs(a[i][j] - b[i][j]));
+	return e;
+}
+
+int main(int argc, char* argv[]){
+	// needs pivoting: a[0][0] is zero
+	matrix<3, 3> const a{{0., 2., 1.}, {1., 1., 1.}, {2., 1., 3.}};
+	lu_decomposition<3> const lu(a);
+
+	assert(!lu.singular());
+	assert(fabs(lu.determinant() - determinant(a)) < 1e-12);
+
+	vector<3> const x= lu.solve(vector<3>{3., 3., 6.});
+	assert(fabs(x[0] - 1.) < 1e-12 && fabs(x[1] - 1.) < 1e-12 && fabs(x[2] - 1.) < 1e-12);
+
+	// larger than several blocks, many right hand sides
+	int const n= 300;
+	dynamic_matrix<> big(n, n);
+	for(int i= 0; i < n; ++i)
+		for(int j= 0; j < n; ++j)
+			big[i][j]= ((i * 37 + j * 11) % 23) / 23. - .5 + (i == j ? 2. : 0.);
+
+	lu_decomposition<dynamic> const blu(big);
+	assert(!blu.singular());
+
+	dynamic_matrix<> xs(n, 7);
+	for(int i= 0; i < n; ++i)
+		for(int j= 0; j < 7; ++j)
+			xs[i][j]= (i + j) % 5 - 2.;
+
+	dynamic_matrix<> const bs= big * xs;
+	assert(max_error(blu.solve(bs), xs) < 1e-9);
+
+	dynamic_vector<> xv(n);
+	for(int i= 0; i < n; ++i)
+		xv[i]= i % 3 - 1.;
+	dynamic_vector<> const yv= blu.solve(dynamic_vector<>(big * xv));
+	for(int i= 0; i < n; ++i)
+		assert(fabs(yv[i] - xv[i]) < 1e-9);
+
+	dynamic_matrix<> id(n, n);
+	for(int i= 0; i < n; ++i)
+		id[i][i]= 1.;
+	assert(max_error(dynamic_matrix<>(big * inverse(big)), id) < 1e-9);
+
+	// determinant through LU agrees with the closed form
+	matrix<4, 4> const g{{3., 1., 4., 1.}, {5., 9., 2., 6.}, {5., 3., 5., 8.}, {9., 7., 9., 3.}};
+	assert(fabs(lu_decomposition<4>(g).determinant() - determinant(g)) < 1e-9);
+
+	// singular systems are detected
+	matrix<3, 3> const s{{1., 2., 3.}, {2., 4., 6.}, {1., 0., 1.}};
+	lu_decomposition<3> const slu(s);
+	assert(slu.singular() && slu.determinant() == 0.);
+	try{
+		slu.solve(vector<3>{1., 2., 3.});
+		assert(false);
+	}
+	catch(lib::exception::invalid_argument<> const&){
+	}
+	try{
+		lu_decomposition<dynamic>(dynamic_matrix<>(2, 3));
+		assert(false);
+	}
+	catch(lib::exception::invalid_argument<> const&){
+	}
+
+	return 0;
+}
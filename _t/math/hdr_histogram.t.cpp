@@ -0,0 +1,111 @@
+#include <math/hdr_histogram.hpp>
+#include <time/stop_watch.hpp>
+#include <thread/pool.hpp>
+#include <assert.h>
+#include <cmath>
+#include <vector>
+
+using namespace lib::math;
+
+int main(int argc, char* argv[]){
+	{
+		hdr_histogram h;
+
+		assert(h.size() == 0 && h.min() == 0 && h.max() == 0 && h.mean() == 0.);
+
+		// 2^precision未満は正確に数える
+		for(int i= 1; i <= 100; ++i)
+			h.record(i);
+		assert(h.size() == 100 && h.min() == 1 && h.max() == 100);
+		assert(h.mean() == 50.5);
+		assert(h.quantile(.5) == 50 && h.quantile(.99) == 99 && h.quantile(1.) == 100);
+		assert(h.quantile(0.) == 1);
+		assert(h.count_between(10, 19) == 10);
+
+		h.record(-5);
+		assert(h.min() == 0 && h.size() == 101);
+
+		h.reset();
+		assert(h.size() == 0);
+	}
+	// 区間の幅は値の2^(1-precision)倍以下
+	{
+		hdr_histogram h(7);
+
+		for(int64_t v : {127ll, 128ll, 1000ll, 123456789ll, 1ll << 40, (1ll << 62) + 12345}){
+			int64_t const lo= h.lowest_equivalent(v), hi= h.highest_equivalent(v);
+
+			assert(lo <= v && v <= hi);
+			assert(static_cast<double>(hi - lo + 1) <= std::ldexp(static_cast<double>(v), -6));
+			assert(h.lowest_equivalent(hi + 1) == hi + 1);
+		}
+		assert(h.highest_equivalent(std::numeric_limits<int64_t>::max()) == std::numeric_limits<int64_t>::max());
+	}
+	// 複数スレッドから同時に記録したものと、スレッドごとの記録をmerge()したものは一致する
+	{
+		int const n= 400000;
+		hdr_histogram shared(5), merged(5);
+		std::vector<std::unique_ptr<hdr_histogram>> parts;
+
+		for(int i= 0; i < 8; ++i)
+			parts.emplace_back(new hdr_histogram(5));
+
+		lib::thread::pool workers(3);
+
+		workers.parallel_for(0, 8, 1, [&](int b, int e){
+			for(int p= b; p < e; ++p){
+				for(int i= 0; i < n / 8; ++i){
+					int64_t const v= (static_cast<int64_t>(i) * 8 + p) * 37;
+
+					shared.record(v);
+					parts[p]->record(v);
+				}
+			}
+		});
+		for(auto const& p : parts)
+			merged.merge(*p);
+
+		assert(shared.size() == n && merged.size() == n);
+		assert(shared.max() == (n - 1) * 37ll && merged.min() == 0);
+		assert(shared.mean() == merged.mean());
+		assert(std::abs(merged.mean() - (n - 1) * 37. / 2.) <= (n - 1) * 37. / 2. / 32.);
+
+		std::vector<double> const ps= {.5, .9, .99, .999};
+		std::vector<int64_t> const a= shared.quantiles(ps), b= merged.quantiles(ps);
+
+		for(std::size_t i= 0; i < ps.size(); ++i){
+			double const truth= ps[i] * n * 37.;
+
+			assert(a[i] == b[i]);
+			assert(std::abs(a[i] - truth) <= truth / 16.);
+		}
+
+		bool thrown= false;
+
+		try{
+			merged.merge(hdr_histogram(7));
+		}
+		catch(lib::exception::invalid_argument<> const&){
+			thrown= true;
+		}
+		assert(thrown);
+	}
+	// stop_watchの計測値を直接記録する
+	{
+		hdr_histogram h;
+		lib::time::stop_watch sw= 1e-6;
+
+		sw.record_to(&h);
+		for(int i= 0; i < 10; ++i){
+			sw.start();
+			sw.stop();
+		}
+		sw.record_to(nullptr);
+		sw.start();
+		sw.stop();
+		assert(h.size() == 10);
+		assert(h.max() >= h.min());
+	}
+
+	return 0;
+}
@@ -0,0 +1,167 @@
+#include <math/kll_sketch.hpp>
+#include <assert.h>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+using namespace lib::math;
+
+namespace{
+
+// 0, 1, ..., n-1を並べ替えた列。値と真の順位が一致する
+std::vector<double> permutation(int n, int seed){
+	std::vector<double> v(n);
+
+	for(int i= 0; i < n; ++i)
+		v[i]= static_cast<double>((static_cast<long long>(i) * 7919 + seed) % n);
+
+	return v;
+}
+
+void check_ranks(kll_sketch<double> const& s, long long n){
+	double const bound= kll_sketch<double>::rank_error(s.k()) * 1.5;
+	std::vector<double> const ps= {.01, .1, .25, .5, .75, .9, .99, .999};
+	std::vector<double> const q= s.quantiles(ps);
+
+	for(std::size_t i= 0; i < ps.size(); ++i){
+		assert(std::abs(q[i] / n - ps[i]) <= bound);
+		assert(std::abs(s.cdf(q[i]) - ps[i]) <= bound);
+	}
+}
+
+}
+
+int main(int argc, char* argv[]){
+	{
+		kll_sketch<double> s;
+		bool thrown= false;
+
+		assert(s.empty() && s.cdf(1.) == 0.);
+		try{
+			s.quantile(.5);
+		}
+		catch(std::out_of_range const&){
+			thrown= true;
+		}
+		assert(thrown);
+
+		// 容量に達するまでは正確
+		for(int i= 1; i <= 100; ++i)
+			s.push(static_cast<double>(i));
+		assert(s.size() == 100 && s.retained() == 100);
+		assert(s.quantile(.5) == 50. && s.quantile(.99) == 99.);
+		assert(s.quantile(0.) == 1. && s.quantile(1.) == 100.);
+		assert(s.cdf(25.) == .25 && s.cdf(0.) == 0. && s.cdf(100.) == 1.);
+	}
+	// 保持する値は有界で、順位の誤差は保証の範囲に収まる
+	{
+		int const n= 1000000;
+		std::vector<double> const v= permutation(n, 11);
+		kll_sketch<double> one, batch;
+
+		for(double x : v)
+			one.push(x);
+		batch.push(v.data(), n);
+		assert(batch.retained() == one.retained() && batch.quantile(.9) == one.quantile(.9));
+
+		for(kll_sketch<double> const* s : {&one, &batch}){
+			assert(s->size() == n);
+			assert(s->retained() < 4 * s->k());
+			assert(s->min() == 0. && s->max() == n - 1.);
+			check_ranks(*s, n);
+		}
+	}
+	// 自身とmerge()すると、各値を2回加えたのと同じになる
+	{
+		std::vector<double> const v= permutation(100000, 3);
+		kll_sketch<double> s;
+
+		s.push(v.data(), 100000);
+		s.merge(s);
+		assert(s.size() == 200000 && s.min() == 0. && s.max() == 99999.);
+		assert(s.retained() < 4 * s.k());
+		check_ranks(s, 100000);
+	}
+	// スレッドごとの部分をmerge()したり、serialize()を経由して合わせても誤差は変わらない
+	{
+		int const parts= 16, n= 200000;
+		kll_sketch<double> merged, shipped;
+
+		for(int p= 0; p < parts; ++p){
+			std::vector<double> const v= permutation(n, p);
+			std::vector<double> w(n);
+			kll_sketch<double> part;
+
+			for(int i= 0; i < n; ++i)
+				w[i]= v[i] * parts + p;
+			part.push(w.data(), n);
+			merged.merge(part);
+
+			std::vector<char> const bytes= part.serialize();
+
+			assert(bytes.size() < 64 + (part.retained() + 2) * sizeof(double) + 4 * 64);
+			shipped.merge(kll_sketch<double>::deserialize(bytes.data(), bytes.size()));
+		}
+		assert(merged.size() == static_cast<long long>(parts) * n);
+		assert(merged.retained() < 4 * merged.k());
+		check_ranks(merged, static_cast<long long>(parts) * n);
+		check_ranks(shipped, static_cast<long long>(parts) * n);
+
+		std::vector<char> const bytes= merged.serialize();
+		kll_sketch<double> const copy= kll_sketch<double>::deserialize(bytes.data(), bytes.size());
+
+		assert(copy.size() == merged.size() && copy.retained() == merged.retained());
+		assert(copy.quantile(.99) == merged.quantile(.99));
+
+		bool thrown= false;
+
+		try{
+			kll_sketch<float>::deserialize(bytes.data(), bytes.size());
+		}
+		catch(lib::exception::invalid_argument<> const&){
+			thrown= true;
+		}
+		assert(thrown);
+
+		thrown= false;
+		try{
+			kll_sketch<double>::deserialize(bytes.data(), bytes.size() - 1);
+		}
+		catch(lib::exception::invalid_argument<> const&){
+			thrown= true;
+		}
+		assert(thrown);
+
+		// 個数を書き換えたバイト列は、領域を確保する前に拒む
+		std::size_t const counts= sizeof(detail::kll_header) + 2 * sizeof(double);
+		std::vector<char> forged(bytes.begin(), bytes.begin() + counts + sizeof(uint32_t));
+		uint32_t const huge= 0xffffffffu, one= 1;
+
+		std::memcpy(&forged[counts], &huge, sizeof(huge));
+		std::memcpy(&forged[offsetof(detail::kll_header, levels)], &one, sizeof(one));
+		thrown= false;
+		try{
+			kll_sketch<double>::deserialize(forged.data(), forged.size());
+		}
+		catch(lib::exception::invalid_argument<> const&){
+			thrown= true;
+		}
+		assert(thrown);
+
+		std::vector<char> miscounted(bytes);
+		uint64_t const wrong= merged.size() + 1;
+
+		std::memcpy(&miscounted[offsetof(detail::kll_header, n)], &wrong, sizeof(wrong));
+		thrown= false;
+		try{
+			kll_sketch<double>::deserialize(miscounted.data(), miscounted.size());
+		}
+		catch(lib::exception::invalid_argument<> const&){
+			thrown= true;
+		}
+		assert(thrown);
+	}
+
+	return 0;
+}
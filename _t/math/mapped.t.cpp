@@ -0,0 +1,101 @@
+#include <stdio.h>
+#include <assert.h>
+#include <stdint.h>
+#include <math/mapped.hpp>
+
+using namespace lib::math;
+
+int main(int argc, char* argv[]){
+	char const* const path= "/tmp/lib_math_mapped.t.bin";
+
+	matrix<dynamic, dynamic> m(37, 53);
+	for(int i= 0; i < m.rows(); ++i)
+		for(int j= 0; j < m.cols(); ++j)
+			m[i][j]= i * 100 + j;
+
+	save(path, m);
+	{
+		mapped_matrix<> const mm(path);
+
+		assert(mm.rows() == 37 && mm.cols() == 53);
+		assert(reinterpret_cast<uintptr_t>(mm.data()) % 64 == 0);
+		assert(mm[36][52] == 3652.);
+
+		// the mapping takes part in products without copying
+		vector<dynamic> x(53);
+		for(int j= 0; j < x.size(); ++j)
+			x[j]= j % 3;
+		vector<dynamic> const y= mm.view() * x;
+		vector<dynamic> const y0= m * x;
+		for(int i= 0; i < y.size(); ++i)
+			assert(y[i] == y0[i]);
+
+		// wrong element type or rank
+		try{
+			mapped_matrix<float> f(path);
+			assert(false);
+		}
+		catch(lib::exception::invalid_argument<> const&){
+		}
+		try{
+			mapped_vector<> v(path);
+			assert(false);
+		}
+		catch(lib::exception::invalid_argument<> const&){
+		}
+	}
+
+	// strided views are packed on write
+	save(path, transpose_view(m));
+	{
+		mapped_matrix<> const mt(path);
+
+		assert(mt.rows() == 53 && mt.cols() == 37 && mt[5][7] == 705.);
+	}
+
+	vector<3, int32_t> const v{1, -2, 3};
+	save(path, v);
+	{
+		mapped_vector<int32_t> const mv(path);
+
+		assert(mv.size() == 3 && mv[1] == -2);
+		assert(dot(mv.view(), view(v)) == 14);
+	}
+
+	save(path, column_view(m, 4));
+	{
+		mapped_vector<> const mc(path);
+
+		assert(mc.size() == 37 && mc[10] == 1004.);
+	}
+
+	// a crafted header must not wrap the size check around or overlap the elements with itself
+	for(uint64_t const offset : {UINT64_MAX - 63, static_cast<uint64_t>(0)}){
+		std::fstream fs(path, std::ios::in | std::ios::out | std::ios::binary);
+		mapped_header h;
+
+		fs.read(reinterpret_cast<char*>(&h), sizeof(h));
+		h.data_offset= offset;
+		fs.seekp(0);
+		fs.write(reinterpret_cast<char const*>(&h), sizeof(h));
+		fs.close();
+
+		try{
+			mapped_vector<> v(path);
+			assert(false);
+		}
+		catch(lib::exception::invalid_argument<> const&){
+		}
+	}
+
+	std::remove(path);
+
+	try{
+		mapped_vector<> v(path);
+		assert(false);
+	}
+	catch(lib::exception::invalid_argument<> const&){
+	}
+
+	return 0;
+}
@@ -1,4 +1,8 @@
 #include <stdio.h>
+#include <math.h>
+#include <assert.h>
+#include <stdint.h>
+#include <type_traits>
 #include <math/matrix.hpp>
 
 using namespace lib::math;
@@ -24,6 +28,180 @@ int main(int argc, char* argv[]){
 			added[1][0], added[1][1], added[1][2],
 			added[2][0], added[2][1], added[2][2]);
 
+	// rows are stored contiguously in row-major order
+	matrix<3, 3> sum= m0 + m1;
+	assert(&sum[1][0] == sum.data() + 3);
+
+	auto const copied= sum;
+	assert(copied[2][2] == 18.);
+	assert(copied.data() != sum.data());
+
+	// whole expressions are evaluated in one pass, aliasing the destination is fine
+	sum= sum - m0 + 2. * m1 - m1;
+	assert(sum[0][0] == 2. && sum[1][2] == 12. && sum[2][1] == 16.);
+	sum-= m0;
+	assert(sum[0][1] == 2. && sum[2][2] == 9.);
+
+	matrix<3, 2> m2;
+
+	m2[0][0]= 1.; m2[0][1]= 0.;
+	m2[1][0]= 0.; m2[1][1]= 1.;
+	m2[2][0]= 1.; m2[2][1]= 1.;
+
+	auto const product= m0 * m2;
+	assert(product[0][0] == 4. && product[0][1] == 5.);
+	assert(product[1][0] == 10. && product[1][1] == 11.);
+	assert(product[2][0] == 16. && product[2][1] == 17.);
+
+	// large enough to go through the blocked kernel
+	matrix<70, 90> a;
+	matrix<90, 50> b;
+
+	for(int i= 0; i < 70; ++i)
+		for(int j= 0; j < 90; ++j)
+			a[i][j]= (i * 7 + j * 3) % 11 - 5;
+	for(int i= 0; i < 90; ++i)
+		for(int j= 0; j < 50; ++j)
+			b[i][j]= (i * 5 + j * 13) % 7 - 3;
+
+	assert(reinterpret_cast<uintptr_t>(a.data()) % 64 == 0);
+
+	auto const ab= a * b;
+	for(int i= 0; i < 70; ++i){
+		for(int j= 0; j < 50; ++j){
+			double expected= 0.;
+			for(int k= 0; k < 90; ++k)
+				expected+= a[i][k] * b[k][j];
+			assert(ab[i][j] == expected);
+		}
+	}
+
+	// runtime sized matrices
+	dynamic_matrix<> da(70, 90), db(90, 50);
+	for(int i= 0; i < 70; ++i)
+		for(int j= 0; j < 90; ++j)
+			da[i][j]= a[i][j];
+	for(int i= 0; i < 90; ++i)
+		for(int j= 0; j < 50; ++j)
+			db[i][j]= b[i][j];
+
+	dynamic_matrix<> const dab= da * db;
+	assert(dab.rows() == 70 && dab.cols() == 50);
+	for(int i= 0; i < 70; ++i)
+		for(int j= 0; j < 50; ++j)
+			assert(dab[i][j] == ab[i][j]);
+
+	dynamic_matrix<> const twice= dab + dab;
+	assert(twice.rows() == 70 && twice[69][49] == 2. * ab[69][49]);
+
+	// matrix-vector products
+	vector<90> x;
+	vector<70> y;
+	for(int j= 0; j < 90; ++j)
+		x[j]= j % 5 - 2;
+	for(int i= 0; i < 70; ++i)
+		y[i]= i % 3;
+
+	vector<70> const ax= a * x;
+	vector<90> const aty= transpose_product(a, y);
+	for(int i= 0; i < 70; ++i){
+		double expected= 0.;
+		for(int j= 0; j < 90; ++j)
+			expected+= a[i][j] * x[j];
+		assert(ax[i] == expected);
+	}
+	for(int j= 0; j < 90; ++j){
+		double expected= 0.;
+		for(int i= 0; i < 70; ++i)
+			expected+= a[i][j] * y[i];
+		assert(aty[j] == expected);
+	}
+
+	vector<70> fused= y;
+	gemv(2., a, x, -1., fused);
+	for(int i= 0; i < 70; ++i)
+		assert(fused[i] == 2. * ax[i] - y[i]);
+
+	vector<90> fused_t= x;
+	gemv_t(.5, a, y, 3., fused_t);
+	for(int j= 0; j < 90; ++j)
+		assert(fused_t[j] == .5 * aty[j] + 3. * x[j]);
+
+	matrix<70, 90> updated= a;
+	ger(2., y, x, updated);
+	for(int i= 0; i < 70; ++i)
+		for(int j= 0; j < 90; ++j)
+			assert(updated[i][j] == a[i][j] + 2. * y[i] * x[j]);
+
+	// small matrices are stored inline and evaluated at compile time
+	static_assert(std::is_trivially_copyable<matrix<4, 4>>::value, "");
+	static_assert(sizeof(matrix<3, 3, float>) == 9 * sizeof(float), "");
+
+	constexpr matrix<3, 3> rot{{0., -1., 0.}, {1., 0., 0.}, {0., 0., 1.}};
+	constexpr matrix<3, 3> trans{{2., 0., 1.}, {0., 3., -2.}, {0., 0., 1.}};
+	constexpr matrix<3, 3> chain= rot * trans;
+	static_assert(chain[0][1] == -3. && chain[0][2] == 2. && chain[1][2] == 1., "");
+	static_assert((chain * vector<3>{1., 1., 1.})[0] == -1., "");
+	static_assert(transpose(rot)[0][1] == 1. && transpose(rot)[1][0] == -1., "");
+	static_assert(determinant(trans) == 6., "");
+	static_assert(determinant(matrix<2, 2>{{1., 2.}, {3., 4.}}) == -2., "");
+	static_assert(inverse(trans)[0][0] == .5 && inverse(trans)[0][2] == -.5, "");
+
+	constexpr matrix<4, 4> affine{{2., 0., 0., 1.}, {0., 4., 0., 2.}, {0., 0., 8., 3.}, {0., 0., 0., 1.}};
+	static_assert(determinant(affine) == 64., "");
+	static_assert((affine * inverse(affine))[0][3] == 0. && (affine * inverse(affine))[2][2] == 1., "");
+
+	matrix<4, 4> g{{3., 1., 4., 1.}, {5., 9., 2., 6.}, {5., 3., 5., 8.}, {9., 7., 9., 3.}};
+	matrix<4, 4> const gi= inverse(g) * g;
+	for(int i= 0; i < 4; ++i)
+		for(int j= 0; j < 4; ++j)
+			assert(fabs(gi[i][j] - (i == j ? 1. : 0.)) < 1e-12);
+	assert(determinant(transpose(g)) == determinant(g));
+	try{
+		inverse(matrix<3, 3>{{1., 2., 3.}, {2., 4., 6.}, {0., 0., 1.}});
+		assert(false);
+	}
+	catch(lib::exception::invalid_argument<> const&){
+	}
+
+	dynamic_matrix<> const dm{{1., 2., 3.}, {4., 5., 6.}};
+	dynamic_matrix<> const dmt= transpose(dm);
+	assert(dmt.rows() == 3 && dmt.cols() == 2 && dmt[2][0] == 3. && dmt[0][1] == 4.);
+
+	dynamic_vector<> dx(x.data(), x.data() + 90);
+	dynamic_vector<> const dax= da * dx;
+	assert(dax.size() == 70 && dax[69] == ax[69]);
+	try{
+		da * dynamic_vector<>(89);
+		assert(false);
+	}
+	catch(lib::exception::invalid_argument<> const&){
+	}
+
+	// the element type is kept through rows, products and expressions
+	static_assert(std::is_same<decltype(matrix<5, 5, float>()[0]), vector<5, float>&>::value, "");
+	static_assert(std::is_same<decltype(dynamic_matrix<float>() * dynamic_vector<float>()), vector<dynamic, float> const>::value, "");
+	static_assert(std::is_same<decltype((2. * dynamic_matrix<float>()).element(0, 0)), float>::value, "");
+
+	// float and int32_t take the narrow gemm tiles, including partial edge panels
+	dynamic_matrix<float> fa(131, 517), fb(517, 77);
+	dynamic_matrix<int32_t> ia(131, 517), ib(517, 77);
+	for(int i= 0; i < fa.rows(); ++i)
+		for(int j= 0; j < fa.cols(); ++j)
+			ia[i][j]= (i * 3 + j) % 7 - 3, fa[i][j]= ia[i][j];
+	for(int i= 0; i < fb.rows(); ++i)
+		for(int j= 0; j < fb.cols(); ++j)
+			ib[i][j]= (i + j * 5) % 9 - 4, fb[i][j]= ib[i][j];
+	dynamic_matrix<float> const fc= fa * fb;
+	dynamic_matrix<int32_t> const ic= ia * ib;
+	for(int i= 0; i < fc.rows(); ++i){
+		for(int j= 0; j < fc.cols(); ++j){
+			int32_t e= 0;
+			for(int p= 0; p < fa.cols(); ++p)
+				e+= ia[i][p] * ib[p][j];
+			assert(ic[i][j] == e && fc[i][j] == static_cast<float>(e));
+		}
+	}
 
 	return 0;
 }
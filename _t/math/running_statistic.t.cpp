@@ -0,0 +1,81 @@
+#include <math/running_statistic.hpp>
+#include <thread/pool.hpp>
+#include <assert.h>
+#include <cmath>
+#include <vector>
+
+using namespace lib::math;
+
+int main(int argc, char* argv[]){
+	{
+		running_statistic<int> stat;
+		std::vector<int> const v= {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+
+		assert(stat.size() == 0 && stat.mean() == 0. && stat.variance() == 0.);
+
+		stat.push(v.begin(), v.end());
+		assert(stat.size() == 10 && "size != 10");
+		assert(stat.min() == 1 && "min != 1");
+		assert(stat.max() == 10 && "max != 10");
+		assert(stat.sum() == 55. && "sum != 55");
+		assert(std::abs(stat.mean() - 5.5) < 1e-12 && "mean != 5.5");
+		assert(std::abs(stat.variance() - 8.25) < 1e-12 && "variance != 8.25");
+		assert(std::abs(stat.sample_variance() - 55. / 6.) < 1e-12);
+		assert(std::abs(stat.standard_deviation() - std::sqrt(8.25)) < 1e-12);
+
+		stat.clear();
+		assert(stat.size() == 0 && stat.sum() == 0.);
+	}
+	// 大きなオフセットでも桁落ちしない
+	{
+		running_statistic<double> stat;
+
+		for(int i= 0; i < 1000; ++i)
+			stat.push(1e9 + (i % 2));
+		assert(std::abs(stat.mean() - (1e9 + 0.5)) < 1e-6);
+		assert(std::abs(stat.variance() - 0.25) < 1e-9);
+	}
+	// 配列のpush()とmerge()は1つずつpush()した結果と一致する
+	{
+		int const n= 100000;
+		std::vector<double> v(n);
+
+		for(int i= 0; i < n; ++i)
+			v[i]= std::sin(i * 0.37) * 100. + (i % 13);
+
+		running_statistic<double> one, batch, merged;
+
+		for(int i= 0; i < n; ++i)
+			one.push(v[i]);
+		batch.push(v.data(), 10);
+		batch.push(v.data() + 10, n - 10);
+
+		merged= lib::thread::parallel_reduce(0, n, 4096, running_statistic<double>(),
+			[&](int b, int e){
+				running_statistic<double> part;
+
+				part.push(v.data() + b, e - b);
+				return part;
+			},
+			[](running_statistic<double> l, running_statistic<double> const& r){
+				l.merge(r);
+				return l;
+			});
+
+		for(running_statistic<double> const* s : {&batch, &merged}){
+			assert(s->size() == n);
+			assert(s->min() == one.min() && s->max() == one.max());
+			assert(std::abs(s->sum() - one.sum()) < 1e-6);
+			assert(std::abs(s->mean() - one.mean()) < 1e-9);
+			assert(std::abs(s->variance() - one.variance()) / one.variance() < 1e-12);
+		}
+
+		running_statistic<double> empty;
+
+		empty.merge(one);
+		one.merge(running_statistic<double>());
+		assert(empty.size() == one.size() && empty.variance() == one.variance());
+	}
+
+	return 0;
+}
@@ -0,0 +1,75 @@
+#include <math/sliding_window.hpp>
+#include <math/running_statistic.hpp>
+#include <math/kll_sketch.hpp>
+#include <assert.h>
+#include <cmath>
+#include <vector>
+
+using namespace lib::math;
+
+int main(int argc, char* argv[]){
+	{
+		// 1秒ごとの小区間10個で直近10秒
+		sliding_window<running_statistic<double>> w(10, 1.);
+
+		assert(w.buckets() == 10 && w.width() == 1.);
+		assert(w.snapshot().size() == 0);
+
+		// 時刻tに値tを1秒あたり4回
+		for(int i= 0; i < 200; ++i)
+			w.push(i / 4., i / 4.);
+
+		running_statistic<double> const s= w.snapshot();
+
+		// 40..49.75の40個
+		assert(s.size() == 40);
+		assert(s.min() == 40. && s.max() == 49.75);
+		assert(std::abs(s.mean() - 44.875) < 1e-12);
+		assert(w.bucket(0).size() == 4 && w.bucket(0).min() == 49.);
+
+		// 窓の中の過去の時刻は該当する小区間へ、窓より古い時刻は捨てる
+		w.push(45.5, 1000.);
+		w.push(39.9, -1000.);
+		assert(w.snapshot().size() == 41 && w.snapshot().max() == 1000.);
+		assert(w.snapshot().min() == 40.);
+
+		// 時刻が進むと古い小区間から外れる
+		w.advance(52.);
+		assert(w.snapshot().size() == 29 && w.snapshot().min() == 43.);
+		w.advance(1000.);
+		assert(w.snapshot().size() == 0);
+
+		w.push(1000.5, 1.);
+		w.clear();
+		assert(w.snapshot().size() == 0);
+
+		bool thrown= false;
+
+		try{
+			sliding_window<running_statistic<double>>(0, 1.);
+		}
+		catch(lib::exception::invalid_argument<> const&){
+			thrown= true;
+		}
+		assert(thrown);
+	}
+	// 分位数の窓と、配列をまとめて加えるpush()
+	{
+		sliding_window<kll_sketch<double>> w(6, 10., kll_sketch<double>(100));
+		std::vector<double> v(1000);
+
+		for(int t= 0; t < 120; t+= 10){
+			for(int i= 0; i < 1000; ++i)
+				v[i]= t * 100 + i;
+			w.push(t, v.data(), 1000);
+		}
+
+		kll_sketch<double> const s= w.snapshot();
+
+		assert(s.k() == 100);
+		assert(s.size() == 6000 && s.min() == 6000. && s.max() == 11999.);
+		assert(std::abs(s.quantile(.5) - 9000.) <= 6000. * kll_sketch<double>::rank_error(100) * 1.5);
+	}
+
+	return 0;
+}
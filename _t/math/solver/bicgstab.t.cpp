@@ -0,0 +1,52 @@
+#include <assert.h>
+#include <math.h>
+#include <vector>
+#include <math/solver/bicgstab.hpp>
+
+using namespace lib::math;
+
+int main(int argc, char* argv[]){
+	// 1D convection-diffusion: nonsymmetric, diagonally dominant
+	int const n= 500;
+	std::vector<triplet<>> entries;
+	for(int i= 0; i < n; ++i){
+		entries.push_back(triplet<>{i, i, 2.5 + (i % 5)});
+		if(i > 0)     entries.push_back(triplet<>{i, i - 1, -1.6});
+		if(i < n - 1) entries.push_back(triplet<>{i, i + 1, -.4});
+	}
+	csr_matrix<> const a(n, n, entries.begin(), entries.end());
+
+	dynamic_vector<> expected(n);
+	for(int i= 0; i < n; ++i)
+		expected[i]= cos(i * .05);
+	dynamic_vector<> const b= a * expected;
+
+	solver_options<> const opt(1e-12, 1000);
+
+	dynamic_vector<> x(n);
+	solver_result<> const plain= bicgstab(a, b, x, opt);
+	assert(plain.converged && plain.residuals.back() <= 1e-12);
+	assert(static_cast<int>(plain.residuals.size()) == plain.iterations + 1);
+	for(int i= 0; i < n; ++i)
+		assert(fabs(x[i] - expected[i]) < 1e-9);
+
+	dynamic_vector<> xp(n);
+	solver_result<> const pre= bicgstab(a, b, xp, jacobi_preconditioner<>(a), opt);
+	assert(pre.converged && pre.iterations <= plain.iterations);
+	for(int i= 0; i < n; ++i)
+		assert(fabs(xp[i] - expected[i]) < 1e-9);
+
+	dynamic_matrix<> const d= a.to_dense();
+	dynamic_vector<> xd(n);
+	assert(bicgstab(d, b, xd, opt).converged);
+	for(int i= 0; i < n; ++i)
+		assert(fabs(xd[i] - expected[i]) < 1e-9);
+
+	// the right-hand side 0 has the solution 0
+	dynamic_vector<> xz(n);
+	xz[3]= 1.;
+	solver_result<> const zero= bicgstab(a, dynamic_vector<>(n), xz, opt);
+	assert(zero.converged && zero.iterations == 0 && xz[3] == 0.);
+
+	return 0;
+}
@@ -0,0 +1,79 @@
+#include <assert.h>
+#include <math.h>
+#include <vector>
+#include <math/solver/cg.hpp>
+
+using namespace lib::math;
+
+int main(int argc, char* argv[]){
+	// 2D Poisson on a k x k grid, scaled so the diagonal varies by orders of magnitude
+	int const k= 30, n= k * k;
+	std::vector<triplet<>> entries;
+	dynamic_vector<> scale(n);
+	for(int i= 0; i < n; ++i)
+		scale[i]= 1. + (i % 7) * 10.;
+	for(int i= 0; i < n; ++i){
+		int const r= i / k, c= i % k;
+		entries.push_back(triplet<>{i, i, 4. * scale[i] * scale[i]});
+		if(c > 0)     entries.push_back(triplet<>{i, i - 1, -scale[i] * scale[i - 1]});
+		if(c < k - 1) entries.push_back(triplet<>{i, i + 1, -scale[i] * scale[i + 1]});
+		if(r > 0)     entries.push_back(triplet<>{i, i - k, -scale[i] * scale[i - k]});
+		if(r < k - 1) entries.push_back(triplet<>{i, i + k, -scale[i] * scale[i + k]});
+	}
+	csr_matrix<> const a(n, n, entries.begin(), entries.end());
+
+	dynamic_vector<> expected(n);
+	for(int i= 0; i < n; ++i)
+		expected[i]= sin(i * .1);
+	dynamic_vector<> const b= a * expected;
+
+	solver_options<> const opt(1e-10, 5000);
+
+	dynamic_vector<> x(n);
+	solver_result<> const plain= conjugate_gradient(a, b, x, opt);
+	assert(plain.converged);
+	assert(static_cast<int>(plain.residuals.size()) == plain.iterations + 1);
+	assert(plain.residuals.front() == 1. && plain.residuals.back() <= 1e-10);
+	for(int i= 0; i < n; ++i)
+		assert(fabs(x[i] - expected[i]) < 1e-6);
+
+	// Jacobi preconditioning undoes the scaling
+	dynamic_vector<> xp(n);
+	solver_result<> const pre= conjugate_gradient(a, b, xp, jacobi_preconditioner<>(a), opt);
+	assert(pre.converged && pre.iterations * 2 < plain.iterations);
+	for(int i= 0; i < n; ++i)
+		assert(fabs(xp[i] - expected[i]) < 1e-6);
+
+	// dense matrices and callbacks are accepted as the operator
+	dynamic_matrix<> const d= a.to_dense();
+	dynamic_vector<> xd(n);
+	assert(conjugate_gradient(d, b, xd, jacobi_preconditioner<>(d), opt).iterations == pre.iterations);
+
+	int calls= 0;
+	auto const op= [&](dynamic_vector<> const& v, dynamic_vector<>& y){ ++calls; y= a * v; };
+	dynamic_vector<> xc(n);
+	solver_result<> const cb= conjugate_gradient(op, b, xc, opt);
+	assert(cb.iterations == plain.iterations && calls == cb.iterations + 1);
+
+	// a converged starting point needs no iterations
+	solver_result<> const again= conjugate_gradient(a, b, x, opt);
+	assert(again.converged && again.iterations == 0);
+
+	// fixed-size systems
+	matrix<3, 3> const s{{4., 1., 0.}, {1., 3., 1.}, {0., 1., 2.}};
+	vector<3> xs;
+	assert(conjugate_gradient(s, vector<3>{1., 2., 3.}, xs).converged);
+	vector<3> const rs= s * xs;
+	assert(fabs(rs[0] - 1.) < 1e-7 && fabs(rs[1] - 2.) < 1e-7 && fabs(rs[2] - 3.) < 1e-7);
+
+	try{
+		matrix<2, 2> const indefinite{{1., 0.}, {0., -1.}};
+		vector<2> xi;
+		conjugate_gradient(indefinite, vector<2>{0., 1.}, xi);
+		assert(false);
+	}
+	catch(lib::exception::invalid_argument<> const&){
+	}
+
+	return 0;
+}
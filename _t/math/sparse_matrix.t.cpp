@@ -0,0 +1,93 @@
+#include <math/sparse_matrix.hpp>
+#include <assert.h>
+#include <vector>
+
+using namespace lib::math;
+
+int main(int argc, char* argv[]){
+	std::vector<triplet<>> const entries= {
+		{0, 0, 1.}, {2, 1, 3.}, {1, 2, 2.}, {0, 3, 4.}, {2, 1, 1.},
+	};
+
+	csr_matrix<> a(3, 4, entries.begin(), entries.end());
+
+	assert(a.rows() == 3 && a.cols() == 4);
+	assert(a.non_zeros() == 4); // duplicated (2, 1) is summed
+	assert(a(2, 1) == 4. && a(0, 3) == 4. && a(1, 1) == 0.);
+
+	vector<4> x= {1., 2., 3., 4.};
+	auto const y= a * x;
+	assert(y.size() == 3 && y[0] == 17. && y[1] == 6. && y[2] == 8.);
+
+	csc_matrix<> const b(a);
+	assert(b.non_zeros() == 4 && b(2, 1) == 4. && b(1, 2) == 2.);
+	auto const yb= b * x;
+	assert(yb[0] == 17. && yb[1] == 6. && yb[2] == 8.);
+
+	matrix<3, 4> const dense= a.to_dense<3, 4>();
+	assert(dense[0][3] == 4. && dense[1][0] == 0.);
+	csr_matrix<> const back(dense);
+	assert(back.non_zeros() == 4 && back(1, 2) == 2.);
+
+	matrix<4, 2> m;
+	for(int i= 0; i < 4; ++i){
+		m[i][0]= 1.;
+		m[i][1]= i;
+	}
+	auto const am= a * m;
+	auto const bm= b * m;
+	assert(am[0][0] == 5. && am[0][1] == 12. && am[2][1] == 4.);
+	assert(bm[0][0] == 5. && bm[0][1] == 12. && bm[2][1] == 4.);
+
+	// large enough to be split across threads
+	int const n= 100000;
+	std::vector<triplet<>> band;
+	for(int i= 0; i < n; ++i){
+		band.push_back(triplet<>{i, i, 2.});
+		if(i > 0)
+			band.push_back(triplet<>{i, i - 1, -1.});
+		if(i + 1 < n)
+			band.push_back(triplet<>{i, i + 1, -1.});
+	}
+	csr_matrix<> const lap(n, n, band.begin(), band.end());
+	csc_matrix<> const lap_c(lap);
+	dynamic_vector<> ones(n);
+	for(int i= 0; i < n; ++i)
+		ones[i]= 1.;
+
+	auto const r= lap * ones;
+	auto const rc= lap_c * ones;
+	assert(r[0] == 1. && r[n - 1] == 1. && r[n / 2] == 0.);
+	for(int i= 0; i < n; ++i)
+		assert(r[i] == rc[i]);
+
+	// a wide csc matrix is split by column, each non-zero is visited once
+	{
+		int const rows= 64, cols= 200000;
+		std::vector<triplet<>> wide;
+		for(int j= 0; j < cols; ++j)
+			wide.push_back(triplet<>{(j * 7) % rows, j, (j % 3) + 1.});
+		csc_matrix<> const w(rows, cols, wide.begin(), wide.end());
+		csr_matrix<> const wr(w);
+		dynamic_vector<> x(cols);
+		dynamic_matrix<> b(cols, 3);
+		for(int j= 0; j < cols; ++j){
+			x[j]= (j % 5) - 2.;
+			for(int k= 0; k < 3; ++k)
+				b[j][k]= ((j + k) % 4) - 1.;
+		}
+
+		auto const y= w * x;
+		auto const y0= wr * x;
+		for(int i= 0; i < rows; ++i)
+			assert(y[i] == y0[i]);
+
+		auto const c= w * b;
+		auto const c0= wr * b;
+		for(int i= 0; i < rows; ++i)
+			for(int k= 0; k < 3; ++k)
+				assert(c[i][k] == c0[i][k]);
+	}
+
+	return 0;
+}
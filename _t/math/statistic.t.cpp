@@ -1,6 +1,8 @@
 #include <math/statistic.hpp>
+#include <math/matrix.hpp>
 #include <assert.h>
 #include <cmath>
+#include <vector>
 
 using namespace lib::math;
 
@@ -11,8 +13,134 @@ int main(int argc, char* argv[]){
 	assert(stat.max() == 10 && "max != 10");
 	assert(abs(stat.mean() - 5.5) < 0.01 && "mean != 5.5");
 	assert(stat.size() == 10 && "size != 10");
-	
-	return 0;
-}
+	assert(stat.median() == 5.5 && "median != 5.5");
+
+	{
+		statistic<int> odd({9, 3, 7, 1, 5});
+
+		assert(odd.median() == 5.);
+		assert(odd.quantile(0.) == 1. && odd.quantile(1.) == 9.);
+		assert(odd.quantile(.25) == 3. && odd.quantile(.125) == 2.);
+		assert(odd.min() == 1 && odd.max() == 9);
+	}
+	{
+		statistic<int> m({4, 1, 3, 3, 2, 4, 3, 1});
+
+		assert(m.mode() == 3);
+		assert(m.median() == 3.);
+		assert(m.min() == 1 && m.max() == 4);
+	}
+	{
+		int const n= 100001;
+		std::vector<double> v(n);
+
+		for(int i= 0; i < n; ++i)
+			v[i]= static_cast<double>((i * 7919) % n);
+
+		statistic<double> s(v.begin(), v.end());
+		std::vector<double> const q= s.quantiles({.99, .5, .9, 0., 1.});
+
+		assert(q[0] == 99000. && q[1] == 50000. && q[2] == 90000.);
+		assert(q[3] == 0. && q[4] == 100000.);
+		assert(s.quantile(.999) == 99900.);
+
+		statistic<double> t(v.begin(), v.end() - 1);
+
+		assert(t.median() == 49999.5);
+	}
+	{
+		std::vector<int> const none;
+		statistic<int> e(none.begin(), none.end());
+		bool thrown= false;
+
+		try{
+			e.median();
+		}
+		catch(std::out_of_range const&){
+			thrown= true;
+		}
+		assert(thrown);
+
+		thrown= false;
+		try{
+			stat.quantile(1.5);
+		}
+		catch(lib::exception::invalid_argument<> const&){
+			thrown= true;
+		}
+		assert(thrown);
+	}
+
+	// 和と分散は大きなオフセットでも桁落ちしない
+	{
+		int const n= 1000003;
+		std::vector<double> v(n);
+		std::vector<float> f(n);
+		std::vector<int> k(n);
+
+		for(int i= 0; i < n; ++i){
+			v[i]= 1e9 + (i % 2);
+			f[i]= static_cast<float>(i % 7);
+			k[i]= (i % 2) ? 2000000000 : -2000000000;
+		}
+
+		statistic<double> s(v.begin(), v.end());
 
+		assert(s.sum() == 1e9 * n + n / 2);
+		assert(std::abs(s.mean() - (1e9 + (n / 2) / static_cast<double>(n))) < 1e-6);
+		assert(std::abs(s.variance() - 0.25) < 1e-6);
 
+		statistic<float> sf(f.begin(), f.end());
+		double fsum= 0.;
+
+		for(int i= 0; i < n; ++i)
+			fsum+= f[i];
+		assert(sf.sum() == fsum);
+		assert(std::abs(sf.variance() - 4.) < 1e-4);
+
+		statistic<int> si(k.begin(), k.end());
+
+		assert(si.sum() == -2e9);
+		assert(std::abs(si.variance() - 4e18) / 4e18 < 1e-9);
+	}
+
+	// 表の列を写さずに集計し、順序統計量の時だけ写す
+	{
+		int const rows= 100003, cols= 3;
+		std::vector<double> table(rows * cols);
+
+		for(int i= 0; i < rows; ++i){
+			table[i * cols]= static_cast<double>((i * 7919) % rows);
+			table[i * cols + 1]= 1e9 + (i % 2);
+			table[i * cols + 2]= -i;
+		}
+
+		statistic_view<double> c0(table.data(), rows, cols);
+		statistic_view<double> c1(vector_view<double const>(table.data() + 1, rows, cols));
+		std::vector<double> copy(rows);
+
+		for(int i= 0; i < rows; ++i)
+			copy[i]= table[i * cols];
+
+		statistic<double> const owned(copy.begin(), copy.end());
+
+		assert(c0.size() == rows && c0.min() == 0. && c0.max() == rows - 1.);
+		assert(c0.sum() == owned.sum() && c0.mean() == owned.mean());
+		assert(std::abs(c0.variance() - owned.variance()) <= 1e-9 * owned.variance());
+		assert(c1.sum() == 1e9 * rows + rows / 2 && std::abs(c1.variance() - .25) < 1e-6);
+		assert(!c0.ordered() && !c1.ordered());
+
+		assert(c0.median() == owned.median() && c0.quantile(.99) == owned.quantile(.99));
+		assert(c0.ordered());
+		// 呼び出し側の並びは変えない
+		assert(table[cols] == 7919. && table[2 * cols] == 2 * 7919.);
+
+		matrix<3, 2, int> const m{{4, 1}, {3, 1}, {3, 2}};
+		statistic_view<int> const col(column_view(m, 0));
+
+		assert(col.mode() == 3 && col.min() == 3 && col.max() == 4 && col.sum() == 10.);
+		assert(statistic<int>(column_view(m, 1)).median() == 1.);
+	}
+
+	return 0;
+}
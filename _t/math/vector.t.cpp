@@ -1,7 +1,11 @@
 #include <math/vector.hpp>
+#include <assert.h>
+#include <stdexcept>
 
 using namespace lib::math;
 
+static_assert(sizeof(vector<3>) == sizeof(double) * 3, "vector<3> must hold its elements inline");
+
 vector<3> create(){
 	return vector<3>();
 }
@@ -20,6 +24,69 @@ int main(int argc, char* argv[]){
 
 	auto const v6= vector<3>(v5);
 
+	vector<3> v7= v0 + v1 - v0 + 2. * v1;
+	assert(v7[0] == 3. && v7[1] == 6. && v7[2] == 9.);
+	v7-= v0 * 3.;
+	assert(v7[0] == 0. && v7[2] == 0.);
+	assert(v2[1] == 4. && v3[2] == 0.);
+	assert(d0 == 14.);
+
+	// kernels; 100 elements go through the simd path
+	vector<100> x, y;
+	for(int i= 0; i < 100; ++i){
+		x[i]= i % 2 == 0 ? i : -i;
+		y[i]= 1.;
+	}
+	assert(dot(x, y) == -50.);
+	assert(x.dot_product(y) == -50.);
+	assert(norm1(x) == 4950.);
+	assert(norm_inf(x) == 99.);
+	assert(norm2(y) == 10.);
+
+	axpy(2., y, x);
+	assert(x[0] == 2. && x[1] == 1. && x[99] == -97.);
+	scale(.5, x);
+	assert(x[0] == 1. && x[99] == -48.5);
+
+	auto const h= hadamard_product(x, x);
+	assert(h[99] == 48.5 * 48.5);
+
+	vector<5, int> iv= {1, -2, 3, -4, 5};
+	assert(norm1(iv) == 15 && norm_inf(iv) == 5 && dot(iv, iv) == 55);
+
+	bool thrown= false;
+	try{
+		v0.at(3);
+	}
+	catch(std::out_of_range const&){
+		thrown= true;
+	}
+	assert(thrown);
+
+	// runtime sized vectors share the same arithmetic and kernels
+	dynamic_vector<> dv(100);
+	assert(dv.size() == 100 && dv[99] == 0.);
+	for(int i= 0; i < 100; ++i)
+		dv[i]= i % 2 == 0 ? i : -i;
+	assert(norm1(dv) == 4950.);
+
+	dynamic_vector<> dw= dv + dv - 0.5 * dv;
+	assert(dw.size() == 100 && dw[3] == -4.5);
+	assert(dot(dv, dw) == 1.5 * dot(dv, dv));
+
+	dynamic_vector<> dz= {1., 2., 3.};
+	vector<3> const fixed= dz + v0;
+	assert(fixed[2] == 6.);
+
+	thrown= false;
+	try{
+		dynamic_vector<> const bad= dz + dv;
+	}
+	catch(lib::exception::invalid_argument<> const&){
+		thrown= true;
+	}
+	assert(thrown);
+
 	return 0;
 }
 
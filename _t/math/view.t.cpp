@@ -0,0 +1,144 @@
+#include <stdio.h>
+#include <math.h>
+#include <assert.h>
+#include <math/view.hpp>
+
+using namespace lib::math;
+
+int main(int argc, char* argv[]){
+	matrix<dynamic, dynamic> m(5, 7);
+
+	for(int i= 0; i < m.rows(); ++i)
+		for(int j= 0; j < m.cols(); ++j)
+			m[i][j]= i * 10 + j;
+
+	// views share the storage of the matrix
+	auto const r= row_view(m, 2);
+	auto const c= column_view(m, 3);
+	assert(r.size() == 7 && r.stride() == 1 && r[4] == 24.);
+	assert(c.size() == 5 && c.stride() == 7 && c[4] == 43.);
+	c[1]= -1.;
+	assert(m[1][3] == -1.);
+	m[1][3]= 13.;
+
+	// blocks and transposes are strides over the same elements
+	auto const b= block_view(m, 1, 2, 3, 4);
+	assert(b.rows() == 3 && b.cols() == 4 && b[0][0] == 12. && b[2][3] == 35.);
+	auto const t= transpose_view(m);
+	assert(t.rows() == 7 && t.cols() == 5 && t[3][1] == 13.);
+	assert(b.transpose()[3][2] == 35.);
+	assert(b.block(1, 1, 2, 2)[1][1] == 34.);
+
+	// assignment writes through; expressions of views evaluate element-wise
+	b.row(0)= b.row(1) + b.row(2);
+	assert(m[1][2] == 22. + 32. && m[1][5] == 25. + 35.);
+	b= 2. * b;
+	assert(m[3][5] == 70.);
+	b-= b;
+	assert(m[2][3] == 0. && m[0][0] == 0. && m[4][6] == 46.);
+
+	vector<dynamic> v(5);
+	for(int i= 0; i < v.size(); ++i)
+		v[i]= i + 1;
+
+	// dot/axpy/norm on strided views
+	vector_view<double const> const cv= view(v);
+	assert(dot(cv, column_view(m, 6)) == 1 * 6. + 2 * 16. + 3 * 26. + 4 * 36. + 5 * 46.);
+	axpy(2., cv, column_view(m, 0));
+	assert(m[4][0] == 40. + 10.);
+	assert(norm1(cv) == 15. && norm_inf(cv) == 5.);
+	assert(fabs(norm2(cv) - sqrt(55.)) < 1e-12);
+	scale(2., view(v));
+	assert(v[4] == 10.);
+
+	// products through views match the materialized versions
+	matrix<dynamic, dynamic> a(40, 30);
+	vector<dynamic> x(40), y(30);
+	for(int i= 0; i < a.rows(); ++i)
+		for(int j= 0; j < a.cols(); ++j)
+			a[i][j]= ((i * 7 + j * 3) % 11) - 5.;
+	for(int i= 0; i < x.size(); ++i)
+		x[i]= (i % 5) - 2.;
+	for(int i= 0; i < y.size(); ++i)
+		y[i]= (i % 3) - 1.;
+
+	matrix<dynamic, dynamic> const at= transpose(a);
+	assert(at.rows() == 30 && at[4][17] == a[17][4]);
+
+	vector<dynamic> const ax= view(a) * view(y);
+	vector<dynamic> const ax0= a * y;
+	vector<dynamic> const tx= transpose_view(a) * x;
+	vector<dynamic> const tx0= at * x;
+	for(int i= 0; i < ax.size(); ++i)
+		assert(ax[i] == ax0[i]);
+	for(int i= 0; i < tx.size(); ++i)
+		assert(tx[i] == tx0[i]);
+
+	// a view that is neither row nor column major
+	matrix_view<double const> const s(a.data(), 10, 15, 2 * a.cols(), 2);
+	vector<dynamic> const sx= s * vector_view<double const>(y.data(), 15, 2);
+	for(int i= 0; i < sx.size(); ++i){
+		double e= 0.;
+		for(int j= 0; j < 15; ++j)
+			e+= a[2 * i][2 * j] * y[2 * j];
+		assert(fabs(sx[i] - e) < 1e-12);
+	}
+
+	matrix<dynamic, dynamic> const p= transpose_view(a) * block_view(a, 0, 0, 40, 20);
+	matrix<dynamic, dynamic> const p0= at * matrix<dynamic, dynamic>(block_view(a, 0, 0, 40, 20));
+	assert(p.rows() == 30 && p.cols() == 20);
+	for(int i= 0; i < p.rows(); ++i)
+		for(int j= 0; j < p.cols(); ++j)
+			assert(p[i][j] == p0[i][j]);
+
+	matrix<dynamic, dynamic> const bt= transpose(block_view(a, 3, 5, 20, 17));
+	assert(bt.rows() == 17 && bt.cols() == 20 && bt[2][4] == a[7][7]);
+
+	// the right hand side may read other elements of the destination
+	{
+		matrix<3, 3> q{{0., 1., 2.}, {3., 4., 5.}, {6., 7., 8.}};
+		matrix<3, 3> const q0= q;
+
+		q= q + transpose_view(q);
+		for(int i= 0; i < 3; ++i)
+			for(int j= 0; j < 3; ++j)
+				assert(q[i][j] == q0[i][j] + q0[j][i]);
+		q-= transpose_view(q);
+		for(int i= 0; i < 3; ++i)
+			for(int j= 0; j < 3; ++j)
+				assert(q[i][j] == 0.);
+
+		// and so may a view assigned from the matrix it refers to
+		matrix<3, 3> r{{0., 1., 2.}, {3., 4., 5.}, {6., 7., 8.}};
+
+		transpose_view(r)= r;
+		for(int i= 0; i < 3; ++i)
+			for(int j= 0; j < 3; ++j)
+				assert(r[i][j] == q0[j][i]);
+		transpose_view(r)+= r;
+		for(int i= 0; i < 3; ++i)
+			for(int j= 0; j < 3; ++j)
+				assert(r[i][j] == q0[i][j] + q0[j][i]);
+		block_view(r, 1, 0, 2, 3)= block_view(r, 0, 0, 2, 3);
+		assert(r[2][0] == q0[1][0] + q0[0][1] && r[1][2] == q0[0][2] + q0[2][0] && r[0][1] == q0[0][1] + q0[1][0]);
+
+		vector<dynamic> u{1., 2., 3., 4., 5.};
+
+		vector_view<double>(u.data() + 1, 4)= vector_view<double const>(u.data(), 4);
+		assert(u[0] == 1. && u[1] == 1. && u[2] == 2. && u[4] == 4.);
+
+		vector<dynamic> w{1., 2., 3., 4.};
+
+		w+= vector_view<double const>(w.data() + 3, 4, -1);
+		assert(w[0] == 5. && w[1] == 5. && w[2] == 5. && w[3] == 5.);
+	}
+
+	try{
+		block_view(a, 30, 0, 11, 1);
+		assert(false);
+	}
+	catch(std::out_of_range const&){
+	}
+
+	return 0;
+}
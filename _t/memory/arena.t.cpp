@@ -0,0 +1,123 @@
+#include <stdio.h>
+#include <assert.h>
+#include <stdint.h>
+#include <memory/arena.hpp>
+#include <memory/aligned_allocator.hpp>
+#include <math/matrix.hpp>
+#include <math/kernel/level2.hpp>
+
+using namespace lib;
+
+int main(int argc, char* argv[]){
+	memory::arena a(4096);
+
+	{
+		memory::arena_scope const scope(a);
+		assert(memory::current_arena() == &a);
+
+		memory::allocation_counter const counter;
+		math::dynamic_vector<> v(100);
+		assert(reinterpret_cast<uintptr_t>(v.data()) % 64 == 0);
+		assert(counter.arena_allocations() == 1 && counter.heap_allocations() == 1);
+
+		// nested scopes restore the previous arena, nullptr falls back to the heap
+		{
+			memory::arena_scope const heap(nullptr);
+			math::dynamic_vector<> h(10);
+			assert(counter.heap_allocations() == 2);
+		}
+		assert(memory::current_arena() == &a);
+	}
+	assert(memory::current_arena() == nullptr);
+
+	// after the first iteration a loop of temporaries touches only the arena
+	math::dynamic_matrix<> m(60, 60), acc(60, 60);
+	for(int i= 0; i < m.rows(); ++i)
+		for(int j= 0; j < m.cols(); ++j)
+			m[i][j]= (i == j) ? 1. : 0.;
+
+	memory::allocation_counter counter;
+	for(int it= 0; it < 10; ++it){
+		if(it == 1)
+			counter.reset();
+		{
+			memory::arena_scope const scope(a);
+			math::dynamic_matrix<> const t= m * m + m;
+			math::dynamic_vector<> const x(60);
+
+			acc+= t;
+			assert(x.size() == 60);
+		}
+		a.reset();
+		assert(a.used() == 0);
+	}
+	assert(counter.heap_allocations() == 0);
+	assert(counter.arena_allocations() > 0);
+	assert(acc[3][3] == 20. && acc[3][4] == 0.);
+
+	// strided level 2 kernels pack their operands into arena scratch too
+	{
+		math::dynamic_vector<> x(2 * 60), y(3 * 60);
+		for(int i= 0; i < x.size(); ++i)
+			x[i]= 1.;
+
+		memory::allocation_counter strided;
+		for(int it= 0; it < 3; ++it){
+			if(it == 1)
+				strided.reset();
+			{
+				memory::arena_scope const scope(a);
+
+				math::kernel::gemv(60, 60, 1., m.data(), 60, x.data(), 2, 0., y.data(), 3);
+				math::kernel::gemv_t(60, 60, 1., m.data(), 60, x.data(), 2, 1., y.data(), 3);
+				math::kernel::ger(60, 60, 1., x.data(), 2, y.data(), 3, acc.data(), 60);
+			}
+			a.reset();
+		}
+		assert(strided.heap_allocations() == 0);
+		assert(strided.arena_allocations() > 0);
+		assert(y[3 * 7] == 2.);
+	}
+
+	// containers built outside a scope stay on the heap when assigned or grown inside it
+	{
+		memory::arena c(4096);
+		math::dynamic_matrix<> kept;
+		math::dynamic_vector<> grown(2);
+		memory::allocation_counter outside;
+
+		{
+			memory::arena_scope const scope(c);
+
+			kept= m * m + m;
+			grown= math::dynamic_vector<>(500);
+			grown[499]= 1.;
+		}
+		c.reset();
+		{
+			memory::arena_scope const scope(c);
+			math::dynamic_matrix<> const overwrite(60, 60);
+			math::dynamic_vector<> const copy(grown);
+
+			assert(overwrite[3][3] == 0. && copy[499] == 1.);
+		}
+		c.reset();
+		assert(outside.heap_allocations() >= 2);
+		assert(kept.rows() == 60 && kept[3][3] == 2. && kept[3][4] == 0.);
+		assert(grown.size() == 500 && grown[499] == 1.);
+	}
+
+	// a request larger than a block gets its own block, reset merges them into one
+	{
+		memory::arena b(256);
+		void* const p= b.allocate(1000, 64);
+		void* const q= b.allocate(100, 64);
+		assert(reinterpret_cast<uintptr_t>(p) % 64 == 0 && reinterpret_cast<uintptr_t>(q) % 64 == 0);
+		assert(b.used() == 1100);
+		std::size_t const cap= b.capacity();
+		b.reset();
+		assert(b.capacity() == cap && b.used() == 0);
+	}
+
+	return 0;
+}
@@ -0,0 +1,95 @@
+#include <stdio.h>
+#include <assert.h>
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+#include <thread/pool.hpp>
+#include <math/matrix.hpp>
+#include <math/sparse_matrix.hpp>
+
+using namespace lib;
+
+int main(int argc, char* argv[]){
+	thread::pool p(3);
+	assert(p.workers() == 3 && p.concurrency() == 4);
+
+	// every index is visited exactly once
+	std::vector<std::atomic<int>> hits(100000);
+	for(auto& h : hits)
+		h= 0;
+	p.parallel_for(0, static_cast<int>(hits.size()), 0, [&](int first, int last){
+		for(int i= first; i < last; ++i)
+			++hits[i];
+	});
+	for(auto const& h : hits)
+		assert(h == 1);
+
+	// nested loops run on the same workers without deadlocking
+	std::atomic<long long> total(0);
+	p.parallel_for(0, 64, 1, [&](int i0, int i1){
+		for(int i= i0; i < i1; ++i){
+			p.parallel_for(0, 1000, 10, [&](int j0, int j1){
+				total+= j1 - j0;
+			});
+		}
+	});
+	assert(total == 64 * 1000);
+
+	// reductions combine chunks in order, independently of the worker count
+	auto const map= [](int first, int last){
+		double s= 0.;
+		for(int i= first; i < last; ++i)
+			s+= 1. / (1. + i);
+		return s;
+	};
+	auto const plus= [](double l, double r){ return l + r; };
+	double const r3= p.parallel_reduce(0, 1000000, 4096, 0., map, plus);
+	p.resize(0);
+	assert(p.workers() == 0);
+	double const r0= p.parallel_reduce(0, 1000000, 4096, 0., map, plus);
+	assert(r3 == r0);
+	p.resize(2);
+
+	// the first exception is rethrown after all ranges finished
+	try{
+		p.parallel_for(0, 1000, 1, [](int first, int last){
+			if(first <= 500 && 500 < last)
+				throw std::runtime_error("500");
+		});
+		assert(false);
+	}
+	catch(std::runtime_error const&){
+	}
+
+	// library kernels share the default pool
+	thread::default_pool().resize(3);
+
+	math::dynamic_matrix<> a(300, 200), b(200, 250);
+	for(int i= 0; i < a.rows(); ++i)
+		for(int j= 0; j < a.cols(); ++j)
+			a[i][j]= (i * 7 + j) % 11 - 5;
+	for(int i= 0; i < b.rows(); ++i)
+		for(int j= 0; j < b.cols(); ++j)
+			b[i][j]= (i + j * 3) % 13 - 6;
+	math::dynamic_matrix<> const c= a * b;
+	math::dynamic_matrix<> const ct= math::transpose(b) * math::transpose(a);
+	for(int i= 0; i < c.rows(); ++i){
+		for(int j= 0; j < c.cols(); ++j){
+			double e= 0.;
+			for(int k= 0; k < a.cols(); ++k)
+				e+= a[i][k] * b[k][j];
+			assert(c[i][j] == e && ct[j][i] == e);
+		}
+	}
+
+	math::csr_matrix<> const s(math::dynamic_matrix<>(a * b));
+	math::dynamic_vector<> x(250);
+	for(int j= 0; j < x.size(); ++j)
+		x[j]= j % 4;
+	math::dynamic_vector<> const y= s * x;
+	math::dynamic_vector<> const y0= c * x;
+	for(int i= 0; i < y.size(); ++i)
+		assert(y[i] == y0[i]);
+
+	return 0;
+}
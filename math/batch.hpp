@@ -0,0 +1,482 @@
+#ifndef LIB_MATH_BATCH_HPP_
+#define LIB_MATH_BATCH_HPP_
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include "dimension.hpp"
+#include "vector.hpp"
+#include "matrix.hpp"
+#include "kernel/batch.hpp"
+#include "../memory/aligned_allocator.hpp"
+
+namespace lib{
+namespace math{
+
+namespace detail{
+
+/**
+ * C成分のインスタンスをSoAで保持する領域。<br>
+ * 成分eのk番目のインスタンスはdata()[e * stride() + k]にある。
+ * strideはインスタンス数を64バイト分の要素数の倍数に切り上げた値で、
+ * 詰め物の要素は値初期化される。<br>
+ *
+ * @param <C>   成分数
+ * @param <Elm> 要素の型
+ */
+template<int C, class Elm>
+class batch_storage{
+	public:
+		static int const alignment= 64 / sizeof(Elm) > 0 ? 64 / sizeof(Elm) : 1;
+	public:
+		batch_storage() : _count(0), _stride(0){}
+		explicit batch_storage(int count) : _count(count), _stride(round_up(count)), _data(static_cast<std::size_t>(C) * _stride){}
+	public:
+		int size() const{ return _count; }
+		int stride() const{ return _stride; }
+		Elm const* data() const{ return _data.data(); }
+		Elm* data(){ return _data.data(); }
+		Elm const* component(int e) const{ return data() + static_cast<std::size_t>(e) * _stride; }
+		Elm* component(int e){ return data() + static_cast<std::size_t>(e) * _stride; }
+
+		void resize(int count){
+			if(round_up(count) == _stride){
+				// 詰め物の領域はカーネルが書き潰すので、増えた分とあわせて0に戻す
+				for(int e= 0; e < C; ++e)
+					std::fill(component(e) + std::min(count, _count), component(e) + _stride, Elm());
+				_count= count;
+				return;
+			}
+
+			batch_storage<C, Elm> buf(count);
+			int const n= std::min(count, _count);
+
+			for(int e= 0; e < C; ++e)
+				std::copy(component(e), component(e) + n, buf.component(e));
+
+			*this= std::move(buf);
+		}
+	private:
+		static int round_up(int count){ return (count + alignment - 1) / alignment * alignment; }
+	private:
+		int _count;
+		int _stride;
+		std::vector<Elm, memory::aligned_allocator<Elm>> _data;
+};
+
+}
+
+/**
+ * N行M列の行列をK個まとめて保持するクラス<br>
+ * 要素は成分ごとに全インスタンス分を連続して並べる(SoA)。
+ * 演算はSIMDレジスタの各レーンに異なるインスタンスを割り当てて計算するため、
+ * matrixを1つずつループで処理するより高速になる。<br>
+ * operator []は1つのインスタンスをmatrixとして取り出したコピーを返し、
+ * 書き込みはassign()で行う。成分ごとの配列はcomponent()で直接参照できる。<br>
+ *
+ * @author  kamichidu
+ * @param <N>   行数
+ * @param <M>   列数
+ * @param <Elm> 要素の型
+ */
+template<int N, int M, class Elm= double>
+class matrix_batch{
+	static_assert(N > 0 && M > 0, "dimensions must be positive");
+	public:
+		typedef Elm value_type;
+
+		static int const row_dimension= N;
+		static int const col_dimension= M;
+	public:
+		matrix_batch()= default;
+		explicit matrix_batch(int count);
+	public:
+		matrix<N, M, Elm> const operator [] (int k) const;
+		matrix<N, M, Elm> const at(int k) const;
+		void assign(int k, matrix<N, M, Elm> const& m);
+		void resize(int count);
+		int size() const;
+		int stride() const;
+		Elm const* component(int i, int j) const;
+		Elm* component(int i, int j);
+		Elm const* data() const;
+		Elm* data();
+	private:
+		detail::batch_storage<N * M, Elm> _data;
+};
+
+/**
+ * N次元のベクトルをK個まとめて保持するクラス<br>
+ * 要素の並びと使い方はmatrix_batchと同じ。<br>
+ *
+ * @author  kamichidu
+ * @param <N>   次元
+ * @param <Elm> 要素の型
+ */
+template<int N, class Elm= double>
+class vector_batch{
+	static_assert(N > 0, "dimension must be positive");
+	public:
+		typedef Elm value_type;
+
+		static int const dimension= N;
+	public:
+		vector_batch()= default;
+		explicit vector_batch(int count);
+	public:
+		vector<N, Elm> const operator [] (int k) const;
+		vector<N, Elm> const at(int k) const;
+		void assign(int k, vector<N, Elm> const& v);
+		void resize(int count);
+		int size() const;
+		int stride() const;
+		Elm const* component(int i) const;
+		Elm* component(int i);
+		Elm const* data() const;
+		Elm* data();
+	private:
+		detail::batch_storage<N, Elm> _data;
+};
+
+/**
+ * count個の零行列で初期化する。<br>
+ *
+ * @param count インスタンス数
+ */
+template<int N, int M, class Elm>
+inline
+matrix_batch<N, M, Elm>::matrix_batch(int count) : _data(count){
+}
+
+/**
+ * k番目のインスタンスを取り出す。範囲チェックは行わない。<br>
+ *
+ * @param k 添字
+ * @return
+ *     k番目の行列のコピー
+ */
+template<int N, int M, class Elm>
+inline
+matrix<N, M, Elm> const matrix_batch<N, M, Elm>::operator [] (int k) const{
+	matrix<N, M, Elm> buf;
+
+	for(int i= 0; i < N; ++i)
+		for(int j= 0; j < M; ++j)
+			buf[i][j]= component(i, j)[k];
+
+	return buf;
+}
+
+/**
+ * 範囲チェック付きでk番目のインスタンスを取り出す。<br>
+ *
+ * @param k 添字
+ * @throw std::out_of_range 添字が範囲外の場合
+ */
+template<int N, int M, class Elm>
+inline
+matrix<N, M, Elm> const matrix_batch<N, M, Elm>::at(int k) const{
+	if(k < 0 || k >= size())
+		throw std::out_of_range("lib::math::matrix_batch");
+
+	return (*this)[k];
+}
+
+/**
+ * k番目のインスタンスをmで置き換える。範囲チェックは行わない。<br>
+ *
+ * @param k 添字
+ * @param m 行列
+ */
+template<int N, int M, class Elm>
+inline
+void matrix_batch<N, M, Elm>::assign(int k, matrix<N, M, Elm> const& m){
+	for(int i= 0; i < N; ++i)
+		for(int j= 0; j < M; ++j)
+			component(i, j)[k]= m.element(i, j);
+}
+
+/**
+ * インスタンス数を変える。残ったインスタンスの値は保たれ、増えた分は零行列になる。<br>
+ *
+ * @param count インスタンス数
+ */
+template<int N, int M, class Elm>
+inline
+void matrix_batch<N, M, Elm>::resize(int count){
+	_data.resize(count);
+}
+
+template<int N, int M, class Elm>
+inline
+int matrix_batch<N, M, Elm>::size() const{
+	return _data.size();
+}
+
+/**
+ * 成分の間隔を返す。<br>
+ *
+ * @return
+ *     size()を64バイト分の要素数の倍数に切り上げた値
+ */
+template<int N, int M, class Elm>
+inline
+int matrix_batch<N, M, Elm>::stride() const{
+	return _data.stride();
+}
+
+/**
+ * (i, j)成分の全インスタンス分の配列を返す。<br>
+ *
+ * @param i 行
+ * @param j 列
+ * @return
+ *     k番目のインスタンスの(i, j)要素がcomponent(i, j)[k]にある連続領域
+ */
+template<int N, int M, class Elm>
+inline
+Elm const* matrix_batch<N, M, Elm>::component(int i, int j) const{
+	return _data.component(i * M + j);
+}
+
+template<int N, int M, class Elm>
+inline
+Elm* matrix_batch<N, M, Elm>::component(int i, int j){
+	return _data.component(i * M + j);
+}
+
+template<int N, int M, class Elm>
+inline
+Elm const* matrix_batch<N, M, Elm>::data() const{
+	return _data.data();
+}
+
+template<int N, int M, class Elm>
+inline
+Elm* matrix_batch<N, M, Elm>::data(){
+	return _data.data();
+}
+
+/**
+ * count個の零ベクトルで初期化する。<br>
+ *
+ * @param count インスタンス数
+ */
+template<int N, class Elm>
+inline
+vector_batch<N, Elm>::vector_batch(int count) : _data(count){
+}
+
+/**
+ * k番目のインスタンスを取り出す。範囲チェックは行わない。<br>
+ *
+ * @param k 添字
+ * @return
+ *     k番目のベクトルのコピー
+ */
+template<int N, class Elm>
+inline
+vector<N, Elm> const vector_batch<N, Elm>::operator [] (int k) const{
+	vector<N, Elm> buf;
+
+	for(int i= 0; i < N; ++i)
+		buf[i]= component(i)[k];
+
+	return buf;
+}
+
+/**
+ * 範囲チェック付きでk番目のインスタンスを取り出す。<br>
+ *
+ * @param k 添字
+ * @throw std::out_of_range 添字が範囲外の場合
+ */
+template<int N, class Elm>
+inline
+vector<N, Elm> const vector_batch<N, Elm>::at(int k) const{
+	if(k < 0 || k >= size())
+		throw std::out_of_range("lib::math::vector_batch");
+
+	return (*this)[k];
+}
+
+/**
+ * k番目のインスタンスをvで置き換える。範囲チェックは行わない。<br>
+ *
+ * @param k 添字
+ * @param v ベクトル
+ */
+template<int N, class Elm>
+inline
+void vector_batch<N, Elm>::assign(int k, vector<N, Elm> const& v){
+	for(int i= 0; i < N; ++i)
+		component(i)[k]= v.element(i);
+}
+
+/**
+ * インスタンス数を変える。残ったインスタンスの値は保たれ、増えた分は零ベクトルになる。<br>
+ *
+ * @param count インスタンス数
+ */
+template<int N, class Elm>
+inline
+void vector_batch<N, Elm>::resize(int count){
+	_data.resize(count);
+}
+
+template<int N, class Elm>
+inline
+int vector_batch<N, Elm>::size() const{
+	return _data.size();
+}
+
+template<int N, class Elm>
+inline
+int vector_batch<N, Elm>::stride() const{
+	return _data.stride();
+}
+
+/**
+ * i番目の成分の全インスタンス分の配列を返す。<br>
+ *
+ * @param i 成分
+ * @return
+ *     k番目のインスタンスのi番目の要素がcomponent(i)[k]にある連続領域
+ */
+template<int N, class Elm>
+inline
+Elm const* vector_batch<N, Elm>::component(int i) const{
+	return _data.component(i);
+}
+
+template<int N, class Elm>
+inline
+Elm* vector_batch<N, Elm>::component(int i){
+	return _data.component(i);
+}
+
+template<int N, class Elm>
+inline
+Elm const* vector_batch<N, Elm>::data() const{
+	return _data.data();
+}
+
+template<int N, class Elm>
+inline
+Elm* vector_batch<N, Elm>::data(){
+	return _data.data();
+}
+
+/**
+ * インスタンスごとの行列積 c[k]= a[k]*b[k] を計算する。<br>
+ * cはaと同じインスタンス数になる。cはaやbと同じオブジェクトでもよい。<br>
+ *
+ * @param a N行M列の行列のバッチ
+ * @param b M行O列の行列のバッチ
+ * @param c 結果を受け取るN行O列の行列のバッチ
+ * @throw lib::exception::invalid_argument<> インスタンス数が一致しない場合
+ */
+template<int N, int M, int O, class Elm>
+inline
+void multiply(matrix_batch<N, M, Elm> const& a, matrix_batch<M, O, Elm> const& b, matrix_batch<N, O, Elm>& c){
+	check_dimension(a.size(), b.size());
+
+	c.resize(a.size());
+	kernel::batch_gemm<N, M, O>(a.size(), a.stride(), a.data(), b.data(), c.data());
+}
+
+/**
+ * インスタンスごとの行列とベクトルの積 y[k]= a[k]*x[k] を計算する。<br>
+ * yはaと同じインスタンス数になる。yはxと同じオブジェクトでもよい。<br>
+ *
+ * @param a N行M列の行列のバッチ
+ * @param x M次元のベクトルのバッチ
+ * @param y 結果を受け取るN次元のベクトルのバッチ
+ * @throw lib::exception::invalid_argument<> インスタンス数が一致しない場合
+ */
+template<int N, int M, class Elm>
+inline
+void multiply(matrix_batch<N, M, Elm> const& a, vector_batch<M, Elm> const& x, vector_batch<N, Elm>& y){
+	check_dimension(a.size(), x.size());
+
+	y.resize(a.size());
+	kernel::batch_gemm<N, M, 1>(a.size(), a.stride(), a.data(), x.data(), y.data());
+}
+
+/**
+ * すべてのインスタンスに同じ行列を掛ける y[k]= a*x[k] を計算する。<br>
+ * yはxと同じインスタンス数になる。yはxと同じオブジェクトでもよい。<br>
+ *
+ * @param a N行M列の行列
+ * @param x M次元のベクトルのバッチ
+ * @param y 結果を受け取るN次元のベクトルのバッチ
+ */
+template<int N, int M, class Elm>
+inline
+void multiply(matrix<N, M, Elm> const& a, vector_batch<M, Elm> const& x, vector_batch<N, Elm>& y){
+	y.resize(x.size());
+	kernel::batch_gemm_broadcast<N, M, 1>(x.size(), x.stride(), a.data(), x.data(), y.data());
+}
+
+/**
+ * すべてのインスタンスに左から同じ行列を掛ける c[k]= a*b[k] を計算する。<br>
+ * cはbと同じインスタンス数になる。cはbと同じオブジェクトでもよい。<br>
+ *
+ * @param a N行M列の行列
+ * @param b M行O列の行列のバッチ
+ * @param c 結果を受け取るN行O列の行列のバッチ
+ */
+template<int N, int M, int O, class Elm>
+inline
+void multiply(matrix<N, M, Elm> const& a, matrix_batch<M, O, Elm> const& b, matrix_batch<N, O, Elm>& c){
+	c.resize(b.size());
+	kernel::batch_gemm_broadcast<N, M, O>(b.size(), b.stride(), a.data(), b.data(), c.data());
+}
+
+/**
+ * インスタンスごとの和 c[k]= a[k]+b[k] を計算する。<br>
+ *
+ * @param a 左辺
+ * @param b 右辺
+ * @param c 結果を受け取るバッチ(aやbと同じオブジェクトでもよい)
+ * @throw lib::exception::invalid_argument<> インスタンス数が一致しない場合
+ */
+template<int N, int M, class Elm>
+inline
+void add(matrix_batch<N, M, Elm> const& a, matrix_batch<N, M, Elm> const& b, matrix_batch<N, M, Elm>& c){
+	check_dimension(a.size(), b.size());
+
+	c.resize(a.size());
+	kernel::batch_add<N * M>(a.size(), a.stride(), a.data(), b.data(), c.data());
+}
+
+template<int N, class Elm>
+inline
+void add(vector_batch<N, Elm> const& a, vector_batch<N, Elm> const& b, vector_batch<N, Elm>& c){
+	check_dimension(a.size(), b.size());
+
+	c.resize(a.size());
+	kernel::batch_add<N>(a.size(), a.stride(), a.data(), b.data(), c.data());
+}
+
+/**
+ * インスタンスごとの逆行列 r[k]= a[k]^-1 を計算する。<br>
+ * 2×2、3×3、4×4の浮動小数点数の行列に対応する。<br>
+ *
+ * @param a 行列のバッチ
+ * @param r 結果を受け取るバッチ(aと同じオブジェクトでもよい)
+ * @throw lib::exception::invalid_argument<> 行列式が0のインスタンスがある場合
+ */
+template<int N, class Elm>
+inline
+void inverse(matrix_batch<N, N, Elm> const& a, matrix_batch<N, N, Elm>& r){
+	r.resize(a.size());
+
+	if(kernel::batch_inverse<N>(a.size(), a.stride(), a.data(), r.data()) >= 0)
+		throw lib::exception::invalid_argument<>(L"特異行列です。");
+}
+
+}
+}
+
+#endif // #ifndef LIB_MATH_BATCH_HPP_
@@ -0,0 +1,332 @@
+#ifndef LIB_MATH_COVARIANCE_HPP_
+#define LIB_MATH_COVARIANCE_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include "dimension.hpp"
+#include "vector.hpp"
+#include "matrix.hpp"
+#include "view.hpp"
+#include "kernel/level1.hpp"
+#include "kernel/level2.hpp"
+#include "kernel/gemm.hpp"
+#include "kernel/transpose.hpp"
+
+namespace lib{
+namespace math{
+
+namespace detail{
+
+/**
+ * covariance_accumulatorがまとめて処理する標本数。<br>
+ */
+static int const covariance_block= 256;
+
+}
+
+/**
+ * 多変量の標本から平均ベクトルと分散共分散行列、相関行列を1回の走査で求めるクラス<br>
+ * 標本はd次元のベクトルで、行列で渡す場合は1行が1つの標本、1列が1つの変数になる。<br>
+ * 平均と、平均まわりの積和行列 C= sum((x - mean) * (x - mean)^T) だけを保持するので、
+ * メモリは標本数によらずO(d^2)。<br>
+ * まとめて渡した標本はdetail::covariance_block行ずつ、その塊の平均を引いてから
+ * kernel::gemmで C+= Xc^T * Xc として加え、塊の平均とのずれをkernel::gerで補正する(Chanらの方法)。
+ * 1つずつのpush()はkernel::gerによる階数1の更新になる。<br>
+ * merge()で別々に集計した結果を合わせられる。<br>
+ *
+ * @author  kamichidu
+ * @param <Elm> 要素の型
+ */
+template<class Elm= double>
+class covariance_accumulator{
+	public:
+		explicit covariance_accumulator(int dimension);
+	public:
+		template<int N>
+			void push(vector<N, Elm> const& x);
+		void push(Elm const* x);
+		template<int N, int M>
+			void push(matrix<N, M, Elm> const& samples);
+		void push(matrix_view<Elm const> const& samples);
+		void merge(covariance_accumulator<Elm> const& r);
+		void clear();
+		long long size() const;
+		int dimension() const;
+		dynamic_vector<Elm> const& mean() const;
+		dynamic_matrix<Elm> const& comoment() const;
+		dynamic_matrix<Elm> covariance() const;
+		dynamic_matrix<Elm> sample_covariance() const;
+		dynamic_matrix<Elm> correlation() const;
+	private:
+		void merge(long long count, Elm const* mean, Elm const* comoment, bool accumulated);
+		dynamic_matrix<Elm> scaled(Elm alpha) const;
+	private:
+		int _d;
+		long long _count;
+		dynamic_vector<Elm> _mean;
+		dynamic_matrix<Elm> _comoment;
+		/** 作業領域(中心化した塊、その転置、塊の平均、差分) */
+		dynamic_matrix<Elm> _centered;
+		dynamic_matrix<Elm> _transposed;
+		dynamic_vector<Elm> _block_mean;
+		dynamic_vector<Elm> _delta;
+};
+
+/**
+ * 標本がない状態で初期化する。<br>
+ *
+ * @param dimension 標本の次元
+ * @throw lib::exception::invalid_argument<> dimensionが正でない場合
+ */
+template<class Elm>
+inline
+covariance_accumulator<Elm>::covariance_accumulator(int dimension) :
+	_d(dimension), _count(0), _mean(), _comoment(), _centered(), _transposed(), _block_mean(), _delta(){
+	if(dimension <= 0)
+		throw lib::exception::invalid_argument<>(L"次元は正でなければなりません。");
+
+	_mean= dynamic_vector<Elm>(dimension);
+	_comoment= dynamic_matrix<Elm>(dimension, dimension);
+	_block_mean= dynamic_vector<Elm>(dimension);
+	_delta= dynamic_vector<Elm>(dimension);
+}
+
+/**
+ * 標本を1つ加える。<br>
+ *
+ * @param x 標本
+ * @throw lib::exception::invalid_argument<> 次元が合わない場合
+ */
+template<class Elm>
+template<int N>
+inline
+void covariance_accumulator<Elm>::push(vector<N, Elm> const& x){
+	check_dimension(_d, x.size());
+
+	push(x.data());
+}
+
+/**
+ * dimension()個の要素が並んだ標本を1つ加える。<br>
+ * delta= x - mean、mean+= delta / n、C+= delta * (x - mean)^T と更新する。<br>
+ *
+ * @param x 標本
+ */
+template<class Elm>
+inline
+void covariance_accumulator<Elm>::push(Elm const* x){
+	Elm* const delta= _delta.data();
+	Elm* const after= _block_mean.data();
+
+	++_count;
+	for(int j= 0; j < _d; ++j)
+		delta[j]= x[j] - _mean[j];
+	kernel::axpy(_d, Elm(1) / static_cast<Elm>(_count), delta, 1, _mean.data(), 1);
+	for(int j= 0; j < _d; ++j)
+		after[j]= x[j] - _mean[j];
+	kernel::ger(_d, _d, Elm(1), delta, 1, after, 1, _comoment.data(), _d);
+}
+
+/**
+ * 行列の各行を標本として加える。<br>
+ *
+ * @see push(matrix_view<Elm const> const&)
+ */
+template<class Elm>
+template<int N, int M>
+inline
+void covariance_accumulator<Elm>::push(matrix<N, M, Elm> const& samples){
+	push(matrix_view<Elm const>(samples));
+}
+
+/**
+ * 行列の各行を標本としてまとめて加える。<br>
+ * 行は連続していなくてもよく、転置したビューを渡せば各列を標本として扱える。<br>
+ *
+ * @param samples 標本数×dimension()の行列
+ * @throw lib::exception::invalid_argument<> 列数が合わない場合
+ */
+template<class Elm>
+inline
+void covariance_accumulator<Elm>::push(matrix_view<Elm const> const& samples){
+	check_dimension(_d, samples.cols());
+	if(samples.rows() == 0)
+		return;
+
+	int const b= std::min(samples.rows(), detail::covariance_block);
+
+	if(_centered.rows() != b){
+		_centered= dynamic_matrix<Elm>(b, _d);
+		_transposed= dynamic_matrix<Elm>(_d, b);
+	}
+
+	for(int first= 0; first < samples.rows(); first+= b){
+		int const m= std::min(b, samples.rows() - first);
+		Elm* const xc= _centered.data();
+		Elm* const bm= _block_mean.data();
+
+		// 塊の標本を詰めて写し、平均を求める
+		for(int i= 0; i < m; ++i){
+			Elm* const row= xc + i * _d;
+
+			if(samples.col_stride() == 1){
+				Elm const* const src= samples.data() + static_cast<std::ptrdiff_t>(first + i) * samples.row_stride();
+
+				std::copy(src, src + _d, row);
+			}
+			else{
+				for(int j= 0; j < _d; ++j)
+					row[j]= samples.element(first + i, j);
+			}
+		}
+		std::fill(bm, bm + _d, Elm());
+		for(int i= 0; i < m; ++i)
+			kernel::axpy(_d, Elm(1), xc + i * _d, 1, bm, 1);
+		kernel::scale(_d, Elm(1) / static_cast<Elm>(m), bm, 1);
+
+		// 塊の平均を引き、Xc^T * Xc を求める
+		for(int i= 0; i < m; ++i)
+			kernel::axpy(_d, Elm(-1), bm, 1, xc + i * _d, 1);
+		kernel::transpose(m, _d, xc, _d, _transposed.data(), b);
+		kernel::gemm(_d, _d, m, Elm(1), _transposed.data(), b, xc, _d, Elm(1), _comoment.data(), _d);
+		merge(m, bm, nullptr, true);
+	}
+}
+
+/**
+ * 別に集計した結果を合わせる。<br>
+ *
+ * @param r 合わせる集計結果
+ * @throw lib::exception::invalid_argument<> 次元が合わない場合
+ */
+template<class Elm>
+inline
+void covariance_accumulator<Elm>::merge(covariance_accumulator<Elm> const& r){
+	check_dimension(_d, r._d);
+
+	merge(r._count, r._mean.data(), r._comoment.data(), false);
+}
+
+/**
+ * 標本がない状態に戻す。<br>
+ */
+template<class Elm>
+inline
+void covariance_accumulator<Elm>::clear(){
+	_count= 0;
+	std::fill(_mean.data(), _mean.data() + _d, Elm());
+	std::fill(_comoment.data(), _comoment.data() + _d * _d, Elm());
+}
+
+template<class Elm>
+inline
+long long covariance_accumulator<Elm>::size() const{
+	return _count;
+}
+
+template<class Elm>
+inline
+int covariance_accumulator<Elm>::dimension() const{
+	return _d;
+}
+
+/**
+ * 平均ベクトル。標本がない場合は0。<br>
+ */
+template<class Elm>
+inline
+dynamic_vector<Elm> const& covariance_accumulator<Elm>::mean() const{
+	return _mean;
+}
+
+/**
+ * 平均まわりの積和行列 sum((x - mean) * (x - mean)^T)。<br>
+ */
+template<class Elm>
+inline
+dynamic_matrix<Elm> const& covariance_accumulator<Elm>::comoment() const{
+	return _comoment;
+}
+
+/**
+ * 分散共分散行列(積和 / n)。statistic::variance()と同じ定義。標本がない場合は0。<br>
+ */
+template<class Elm>
+inline
+dynamic_matrix<Elm> covariance_accumulator<Elm>::covariance() const{
+	return scaled((_count > 0) ? Elm(1) / static_cast<Elm>(_count) : Elm());
+}
+
+/**
+ * 不偏分散共分散行列(積和 / (n - 1))。標本が2つ未満の場合は0。<br>
+ */
+template<class Elm>
+inline
+dynamic_matrix<Elm> covariance_accumulator<Elm>::sample_covariance() const{
+	return scaled((_count > 1) ? Elm(1) / static_cast<Elm>(_count - 1) : Elm());
+}
+
+/**
+ * 相関行列。分散が0の変数は、自身との相関を1、他との相関を0とする。<br>
+ */
+template<class Elm>
+inline
+dynamic_matrix<Elm> covariance_accumulator<Elm>::correlation() const{
+	using std::sqrt;
+
+	dynamic_matrix<Elm> r(_d, _d);
+	dynamic_vector<Elm> inv(_d);
+	Elm const* c= _comoment.data();
+	Elm* const p= r.data();
+
+	for(int j= 0; j < _d; ++j){
+		Elm const v= c[j * _d + j];
+
+		inv[j]= (v > Elm()) ? Elm(1) / static_cast<Elm>(sqrt(v)) : Elm();
+	}
+	for(int i= 0; i < _d; ++i){
+		for(int j= 0; j < _d; ++j)
+			p[i * _d + j]= c[i * _d + j] * inv[i] * inv[j];
+		p[i * _d + i]= Elm(1);
+	}
+
+	return r;
+}
+
+/**
+ * 平均meanと積和comomentを持つcount個の標本を合わせる。<br>
+ * accumulatedがtrueの場合、積和は既に_comomentに足してあるものとして平均のずれの補正だけを行う。<br>
+ */
+template<class Elm>
+inline
+void covariance_accumulator<Elm>::merge(long long count, Elm const* mean, Elm const* comoment, bool accumulated){
+	if(count == 0)
+		return;
+
+	long long const n= _count + count;
+	Elm* const delta= _delta.data();
+
+	for(int j= 0; j < _d; ++j)
+		delta[j]= mean[j] - _mean[j];
+	if(!accumulated)
+		kernel::axpy(_d * _d, Elm(1), comoment, 1, _comoment.data(), 1);
+	kernel::ger(_d, _d, static_cast<Elm>(static_cast<double>(_count) * static_cast<double>(count) / static_cast<double>(n)),
+		delta, 1, delta, 1, _comoment.data(), _d);
+	kernel::axpy(_d, static_cast<Elm>(static_cast<double>(count) / static_cast<double>(n)), delta, 1, _mean.data(), 1);
+	_count= n;
+}
+
+template<class Elm>
+inline
+dynamic_matrix<Elm> covariance_accumulator<Elm>::scaled(Elm alpha) const{
+	dynamic_matrix<Elm> r(_comoment);
+
+	kernel::scale(_d * _d, alpha, r.data(), 1);
+
+	return r;
+}
+
+}
+}
+
+#endif // #ifndef LIB_MATH_COVARIANCE_HPP_
@@ -0,0 +1,180 @@
+#ifndef LIB_MATH_DECAYED_STATISTIC_HPP_
+#define LIB_MATH_DECAYED_STATISTIC_HPP_
+
+#include <cmath>
+#include "../exception/invalid_argument.hpp"
+
+namespace lib{
+namespace math{
+
+/**
+ * 古い値ほど指数的に軽く扱う平均と分散(時間減衰付きのEWMA)<br>
+ * 時刻tの値の重みは、最新の時刻をnowとしてexp(-(now - t) / tau)。
+ * 時刻の間隔が不揃いでも、経過時間に応じて減衰させる。<br>
+ * 重み付きの平均と偏差平方和を逐次更新する(West 1979)ので、1回の更新はO(1)で、
+ * 状態は数個のdoubleだけ。<br>
+ *
+ * @author  kamichidu
+ * @see sliding_window 窓の中を等しく扱う場合
+ */
+class decayed_statistic{
+	public:
+		explicit decayed_statistic(double tau);
+	public:
+		void push(double now, double x);
+		void clear();
+		double tau() const;
+		double weight(double now) const;
+		double mean() const;
+		double variance() const;
+		double standard_deviation() const;
+	private:
+		double decay(double now) const;
+	private:
+		double _tau;
+		double _last;
+		double _weight;
+		double _mean;
+		double _m2;
+};
+
+/**
+ * @param tau 減衰の時定数。この時間が経つと重みが1/eになる。半減期はtau * ln 2
+ * @throw lib::exception::invalid_argument<> tauが正でない場合
+ */
+inline
+decayed_statistic::decayed_statistic(double tau) : _tau(tau), _last(0.), _weight(0.), _mean(0.), _m2(0.){
+	if(!(tau > 0.))
+		throw lib::exception::invalid_argument<>(L"時定数は正でなければなりません。");
+}
+
+/**
+ * 時刻nowの値xを加える。<br>
+ * nowが前回より前の場合は、前回と同じ時刻の値として扱う。<br>
+ *
+ * @param now 時刻
+ * @param x   値
+ */
+inline
+void decayed_statistic::push(double now, double x){
+	double const w= decay(now);
+	double const delta= x - _mean;
+
+	if(now > _last || _weight == 0.)
+		_last= now;
+	_weight= _weight * w + 1.;
+	_mean+= delta / _weight;
+	_m2= _m2 * w + delta * (x - _mean);
+}
+
+inline
+void decayed_statistic::clear(){
+	_last= 0.;
+	_weight= 0.;
+	_mean= 0.;
+	_m2= 0.;
+}
+
+inline
+double decayed_statistic::tau() const{
+	return _tau;
+}
+
+/**
+ * 時刻nowでの重みの合計。値の実効的な個数の目安。<br>
+ */
+inline
+double decayed_statistic::weight(double now) const{
+	return _weight * decay(now);
+}
+
+/**
+ * 重み付き平均。値がない場合は0。<br>
+ * 全体を同じ割合で減衰させても平均と分散は変わらないので、時刻は引数に取らない。<br>
+ */
+inline
+double decayed_statistic::mean() const{
+	return _mean;
+}
+
+/**
+ * 重み付き分散(重み付き偏差平方和 / 重みの合計)。値がない場合は0。<br>
+ */
+inline
+double decayed_statistic::variance() const{
+	return (_weight > 0.) ? _m2 / _weight : 0.;
+}
+
+inline
+double decayed_statistic::standard_deviation() const{
+	return std::sqrt(variance());
+}
+
+inline
+double decayed_statistic::decay(double now) const{
+	return (_weight > 0. && now > _last) ? std::exp(-(now - _last) / _tau) : 1.;
+}
+
+/**
+ * 指数減衰で平滑化した単位時間あたりの発生回数<br>
+ * mark()した回数を時定数tauで減衰させながら数え、rate()でtauあたりの回数を単位時間あたりに直して返す。
+ * UNIXのロードアベレージと同じ平滑化で、1回の更新はO(1)。<br>
+ *
+ * @author  kamichidu
+ */
+class decayed_rate{
+	public:
+		explicit decayed_rate(double tau);
+	public:
+		void mark(double now, double count= 1.);
+		void clear();
+		double rate(double now) const;
+	private:
+		double _tau;
+		double _last;
+		double _count;
+};
+
+/**
+ * @param tau 減衰の時定数
+ * @throw lib::exception::invalid_argument<> tauが正でない場合
+ */
+inline
+decayed_rate::decayed_rate(double tau) : _tau(tau), _last(0.), _count(0.){
+	if(!(tau > 0.))
+		throw lib::exception::invalid_argument<>(L"時定数は正でなければなりません。");
+}
+
+/**
+ * 時刻nowにcount回発生したことを記録する。<br>
+ */
+inline
+void decayed_rate::mark(double now, double count){
+	if(now > _last){
+		_count*= std::exp(-(now - _last) / _tau);
+		_last= now;
+	}
+	_count+= count;
+}
+
+inline
+void decayed_rate::clear(){
+	_last= 0.;
+	_count= 0.;
+}
+
+/**
+ * 時刻nowでの単位時間あたりの発生回数。<br>
+ * 一定の割合rで発生し続けると、時定数の数倍の時間でrに近づく。<br>
+ */
+inline
+double decayed_rate::rate(double now) const{
+	double const w= (now > _last) ? std::exp(-(now - _last) / _tau) : 1.;
+
+	return _count * w / _tau;
+}
+
+}
+}
+
+#endif // #ifndef LIB_MATH_DECAYED_STATISTIC_HPP_
@@ -0,0 +1,219 @@
+#ifndef LIB_MATH_DECOMPOSITION_CHOLESKY_HPP_
+#define LIB_MATH_DECOMPOSITION_CHOLESKY_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "../dimension.hpp"
+#include "../vector.hpp"
+#include "../matrix.hpp"
+#include "../kernel/level1.hpp"
+#include "../kernel/gemm.hpp"
+#include "../kernel/triangular.hpp"
+#include "../../memory/aligned_allocator.hpp"
+
+namespace lib{
+namespace math{
+
+/**
+ * 対称正定値行列のコレスキー分解 A= L*L^T<br>
+ * 一度分解すれば、solve()で右辺を変えながら何度でも解ける。<br>
+ * 分解は列ブロックごとに行い、残りの下三角部分の更新はkernel::gemmで計算する。<br>
+ * Aは下三角部分だけを参照する。<br>
+ *
+ * @author  kamichidu
+ * @param <N>   次数(dynamicの場合は実行時に決まる)
+ * @param <Elm> 要素の型
+ */
+template<int N, class Elm= double>
+class cholesky_decomposition{
+	public:
+		typedef Elm value_type;
+
+		static int const dimension= N;
+		static int const block_size= 128;
+	public:
+		explicit cholesky_decomposition(matrix<N, N, Elm> const& a);
+	public:
+		vector<N, Elm> solve(vector<N, Elm> const& b) const;
+		template<int K>
+			matrix<N, K, Elm> solve(matrix<N, K, Elm> const& b) const;
+		Elm determinant() const;
+		matrix<N, N, Elm> inverse() const;
+		int size() const;
+		matrix<N, N, Elm> const& factor() const;
+	private:
+		matrix<N, N, Elm> _l;
+};
+
+template<int N, class Elm>
+int const cholesky_decomposition<N, Elm>::dimension;
+template<int N, class Elm>
+int const cholesky_decomposition<N, Elm>::block_size;
+
+/**
+ * aを分解する。<br>
+ *
+ * @param a 対称正定値行列
+ * @throw lib::exception::invalid_argument<> aが正方行列でない場合、正定値でない場合
+ */
+template<int N, class Elm>
+inline
+cholesky_decomposition<N, Elm>::cholesky_decomposition(matrix<N, N, Elm> const& a) : _l(a){
+	check_dimension(a.rows(), a.cols());
+
+	int const n= size();
+	Elm* const l= _l.data();
+	std::vector<Elm, memory::aligned_allocator<Elm>> lt;
+
+	for(int k0= 0; k0 < n; k0+= block_size){
+		int const k1= std::min(k0 + block_size, n);
+		int const kb= k1 - k0;
+		int const rest= n - k1;
+		Elm* const r0= l + static_cast<std::size_t>(k0) * n;
+		Elm* const r1= l + static_cast<std::size_t>(k1) * n;
+
+		// 対角ブロック L11
+		for(int j= k0; j < k1; ++j){
+			Elm* const rj= l + static_cast<std::size_t>(j) * n;
+			Elm const d= rj[j] - kernel::dot(j - k0, rj + k0, 1, rj + k0, 1);
+
+			if(!(d > Elm()))
+				throw lib::exception::invalid_argument<>(L"正定値行列ではありません。");
+
+			rj[j]= std::sqrt(d);
+			for(int i= j + 1; i < k1; ++i){
+				Elm* const ri= l + static_cast<std::size_t>(i) * n;
+
+				ri[j]= (ri[j] - kernel::dot(j - k0, ri + k0, 1, rj + k0, 1)) / rj[j];
+			}
+		}
+		if(rest == 0)
+			break;
+
+		// L21= A21 * L11^-T (行ごとに L11*x= a)
+		for(int i= k1; i < n; ++i)
+			kernel::trsm_lower(kb, 1, false, r0 + k0, n, l + static_cast<std::size_t>(i) * n + k0, 1);
+
+		// A22-= L21 * L21^T の下三角部分を、列ブロックごとに更新する
+		lt.resize(static_cast<std::size_t>(kb) * rest);
+		for(int i= 0; i < rest; ++i)
+			for(int j= 0; j < kb; ++j)
+				lt[static_cast<std::size_t>(j) * rest + i]= r1[static_cast<std::size_t>(i) * n + k0 + j];
+		for(int j0= 0; j0 < rest; j0+= block_size){
+			int const jb= std::min(block_size, rest - j0);
+			Elm* const rj= r1 + static_cast<std::size_t>(j0) * n;
+
+			kernel::gemm(rest - j0, jb, kb, Elm(-1), rj + k0, n, lt.data() + j0, rest, Elm(1), rj + k1 + j0, n);
+		}
+	}
+
+	// 上三角部分を0にしてLだけを残す
+	for(int i= 0; i < n; ++i)
+		std::fill(l + static_cast<std::size_t>(i) * n + i + 1, l + static_cast<std::size_t>(i + 1) * n, Elm());
+}
+
+/**
+ * A*x= b を解く。<br>
+ *
+ * @param b 右辺
+ * @return
+ *     解x
+ * @throw lib::exception::invalid_argument<> 次元が合わない場合
+ */
+template<int N, class Elm>
+inline
+vector<N, Elm> cholesky_decomposition<N, Elm>::solve(vector<N, Elm> const& b) const{
+	check_dimension(size(), b.size());
+
+	vector<N, Elm> x= b;
+	int const n= size();
+
+	kernel::trsm_lower(n, 1, false, _l.data(), n, x.data(), 1);
+	kernel::trsm_lower_transposed(n, 1, _l.data(), n, x.data(), 1);
+
+	return x;
+}
+
+/**
+ * A*X= B を解く。Bの各列を右辺として、まとめてブロック単位で解く。<br>
+ *
+ * @param b 右辺(N行K列)
+ * @return
+ *     解X
+ * @throw lib::exception::invalid_argument<> 次元が合わない場合
+ */
+template<int N, class Elm>
+template<int K>
+inline
+matrix<N, K, Elm> cholesky_decomposition<N, Elm>::solve(matrix<N, K, Elm> const& b) const{
+	check_dimension(size(), b.rows());
+
+	matrix<N, K, Elm> x= b;
+	int const n= size();
+	int const m= x.cols();
+
+	kernel::trsm_lower(n, m, false, _l.data(), n, x.data(), m);
+	kernel::trsm_lower_transposed(n, m, _l.data(), n, x.data(), m);
+
+	return x;
+}
+
+/**
+ * 行列式を計算する。<br>
+ *
+ * @return
+ *     Aの行列式(Lの対角要素の積の2乗)
+ */
+template<int N, class Elm>
+inline
+Elm cholesky_decomposition<N, Elm>::determinant() const{
+	int const n= size();
+	Elm det= Elm(1);
+
+	for(int i= 0; i < n; ++i)
+		det*= _l.element(i, i);
+
+	return det * det;
+}
+
+/**
+ * 逆行列を計算する。単位行列を右辺としてsolve()を呼ぶのと同じ。<br>
+ *
+ * @return
+ *     Aの逆行列
+ */
+template<int N, class Elm>
+inline
+matrix<N, N, Elm> cholesky_decomposition<N, Elm>::inverse() const{
+	int const n= size();
+	matrix<N, N, Elm> id(n, n);
+
+	for(int i= 0; i < n; ++i)
+		id[i][i]= Elm(1);
+
+	return solve(id);
+}
+
+template<int N, class Elm>
+inline
+int cholesky_decomposition<N, Elm>::size() const{
+	return _l.rows();
+}
+
+/**
+ * 分解結果を返す。<br>
+ *
+ * @return
+ *     下三角行列L(上三角部分は0)
+ */
+template<int N, class Elm>
+inline
+matrix<N, N, Elm> const& cholesky_decomposition<N, Elm>::factor() const{
+	return _l;
+}
+
+}
+}
+
+#endif // #ifndef LIB_MATH_DECOMPOSITION_CHOLESKY_HPP_
@@ -0,0 +1,316 @@
+#ifndef LIB_MATH_DECOMPOSITION_LU_HPP_
+#define LIB_MATH_DECOMPOSITION_LU_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "../dimension.hpp"
+#include "../vector.hpp"
+#include "../matrix.hpp"
+#include "../kernel/level1.hpp"
+#include "../kernel/gemm.hpp"
+#include "../kernel/triangular.hpp"
+
+namespace lib{
+namespace math{
+
+/**
+ * 部分ピボット選択付きLU分解 P*A= L*U<br>
+ * 一度分解すれば、solve()で右辺を変えながら何度でも解ける。<br>
+ * 分解は列ブロックごとに行い、ブロック外の更新はkernel::gemmで計算する。<br>
+ * Lの狭義下三角部分(対角は1)とUは1つの行列にまとめて保持する。<br>
+ * ピボットが0になった場合も分解は最後まで行い、singular()がtrueになる。<br>
+ *
+ * @author  kamichidu
+ * @param <N>   次数(dynamicの場合は実行時に決まる)
+ * @param <Elm> 要素の型
+ */
+template<int N, class Elm= double>
+class lu_decomposition{
+	public:
+		typedef Elm value_type;
+
+		static int const dimension= N;
+		static int const block_size= 128;
+	public:
+		explicit lu_decomposition(matrix<N, N, Elm> const& a);
+	public:
+		vector<N, Elm> solve(vector<N, Elm> const& b) const;
+		template<int K>
+			matrix<N, K, Elm> solve(matrix<N, K, Elm> const& b) const;
+		Elm determinant() const;
+		matrix<N, N, Elm> inverse() const;
+		bool singular() const;
+		int size() const;
+		matrix<N, N, Elm> const& factor() const;
+		std::vector<int> const& pivots() const;
+	private:
+		void permute(Elm* b, int n, int ldb) const;
+		void check_regular() const;
+	private:
+		matrix<N, N, Elm> _lu;
+		std::vector<int> _piv;
+		int _sign;
+		bool _singular;
+};
+
+/**
+ * aを分解する。<br>
+ *
+ * @param a 正方行列
+ * @throw lib::exception::invalid_argument<> aが正方行列でない場合
+ */
+template<int N, class Elm>
+inline
+lu_decomposition<N, Elm>::lu_decomposition(matrix<N, N, Elm> const& a) : _lu(a), _piv(a.rows()), _sign(1), _singular(false){
+	check_dimension(a.rows(), a.cols());
+
+	int const n= size();
+	Elm* const lu= _lu.data();
+
+	for(int k0= 0; k0 < n; k0+= block_size){
+		int const k1= std::min(k0 + block_size, n);
+
+		// 列k0からk1までのパネルを、行全体の入れ替えを伴って分解する
+		for(int j= k0; j < k1; ++j){
+			int p= j;
+			Elm best= std::abs(lu[static_cast<std::size_t>(j) * n + j]);
+
+			for(int i= j + 1; i < n; ++i){
+				Elm const x= std::abs(lu[static_cast<std::size_t>(i) * n + j]);
+
+				if(x > best){
+					best= x;
+					p= i;
+				}
+			}
+
+			_piv[j]= p;
+			if(p != j){
+				std::swap_ranges(lu + static_cast<std::size_t>(j) * n, lu + static_cast<std::size_t>(j + 1) * n, lu + static_cast<std::size_t>(p) * n);
+				_sign= -_sign;
+			}
+
+			Elm const* const rj= lu + static_cast<std::size_t>(j) * n;
+
+			if(rj[j] == Elm()){
+				_singular= true;
+				continue;
+			}
+			for(int i= j + 1; i < n; ++i){
+				Elm* const ri= lu + static_cast<std::size_t>(i) * n;
+
+				ri[j]/= rj[j];
+				kernel::axpy(k1 - j - 1, -ri[j], rj + j + 1, 1, ri + j + 1, 1);
+			}
+		}
+
+		// U12= L11^-1 * A12、A22-= L21 * U12
+		if(k1 < n){
+			Elm* const r0= lu + static_cast<std::size_t>(k0) * n;
+			Elm* const r1= lu + static_cast<std::size_t>(k1) * n;
+
+			kernel::trsm_lower(k1 - k0, n - k1, true, r0 + k0, n, r0 + k1, n);
+			kernel::gemm(n - k1, n - k1, k1 - k0, Elm(-1), r1 + k0, n, r0 + k1, n, Elm(1), r1 + k1, n);
+		}
+	}
+}
+
+/**
+ * A*x= b を解く。<br>
+ *
+ * @param b 右辺
+ * @return
+ *     解x
+ * @throw lib::exception::invalid_argument<> 次元が合わない場合、Aが特異な場合
+ */
+template<int N, class Elm>
+inline
+vector<N, Elm> lu_decomposition<N, Elm>::solve(vector<N, Elm> const& b) const{
+	check_dimension(size(), b.size());
+	check_regular();
+
+	vector<N, Elm> x= b;
+	int const n= size();
+
+	permute(x.data(), 1, 1);
+	kernel::trsm_lower(n, 1, true, _lu.data(), n, x.data(), 1);
+	kernel::trsm_upper(n, 1, false, _lu.data(), n, x.data(), 1);
+
+	return x;
+}
+
+/**
+ * A*X= B を解く。Bの各列を右辺として、まとめてブロック単位で解く。<br>
+ *
+ * @param b 右辺(N行K列)
+ * @return
+ *     解X
+ * @throw lib::exception::invalid_argument<> 次元が合わない場合、Aが特異な場合
+ */
+template<int N, class Elm>
+template<int K>
+inline
+matrix<N, K, Elm> lu_decomposition<N, Elm>::solve(matrix<N, K, Elm> const& b) const{
+	check_dimension(size(), b.rows());
+	check_regular();
+
+	matrix<N, K, Elm> x= b;
+	int const n= size();
+	int const m= x.cols();
+
+	permute(x.data(), m, m);
+	kernel::trsm_lower(n, m, true, _lu.data(), n, x.data(), m);
+	kernel::trsm_upper(n, m, false, _lu.data(), n, x.data(), m);
+
+	return x;
+}
+
+/**
+ * 行列式を計算する。<br>
+ *
+ * @return
+ *     Aの行列式。特異な場合は0
+ */
+template<int N, class Elm>
+inline
+Elm lu_decomposition<N, Elm>::determinant() const{
+	if(_singular)
+		return Elm();
+
+	int const n= size();
+	Elm det= Elm(_sign);
+
+	for(int i= 0; i < n; ++i)
+		det*= _lu.element(i, i);
+
+	return det;
+}
+
+/**
+ * 逆行列を計算する。単位行列を右辺としてsolve()を呼ぶのと同じ。<br>
+ *
+ * @return
+ *     Aの逆行列
+ * @throw lib::exception::invalid_argument<> Aが特異な場合
+ */
+template<int N, class Elm>
+inline
+matrix<N, N, Elm> lu_decomposition<N, Elm>::inverse() const{
+	int const n= size();
+	matrix<N, N, Elm> id(n, n);
+
+	for(int i= 0; i < n; ++i)
+		id[i][i]= Elm(1);
+
+	return solve(id);
+}
+
+/**
+ * ピボットが0になったか判定する。<br>
+ *
+ * @return
+ *     Aが特異ならtrue
+ */
+template<int N, class Elm>
+inline
+bool lu_decomposition<N, Elm>::singular() const{
+	return _singular;
+}
+
+template<int N, class Elm>
+inline
+int lu_decomposition<N, Elm>::size() const{
+	return _lu.rows();
+}
+
+/**
+ * 分解結果を返す。<br>
+ *
+ * @return
+ *     狭義下三角部分がL(対角は1)、上三角部分がUの行列
+ */
+template<int N, class Elm>
+inline
+matrix<N, N, Elm> const& lu_decomposition<N, Elm>::factor() const{
+	return _lu;
+}
+
+/**
+ * 行の入れ替えを返す。<br>
+ *
+ * @return
+ *     j番目の消去で行jと入れ替えた行の添字の列
+ */
+template<int N, class Elm>
+inline
+std::vector<int> const& lu_decomposition<N, Elm>::pivots() const{
+	return _piv;
+}
+
+template<int N, class Elm>
+inline
+void lu_decomposition<N, Elm>::permute(Elm* b, int n, int ldb) const{
+	int const m= size();
+
+	for(int j= 0; j < m; ++j){
+		if(_piv[j] != j)
+			std::swap_ranges(b + static_cast<std::size_t>(j) * ldb, b + static_cast<std::size_t>(j) * ldb + n, b + static_cast<std::size_t>(_piv[j]) * ldb);
+	}
+}
+
+template<int N, class Elm>
+inline
+void lu_decomposition<N, Elm>::check_regular() const{
+	if(_singular)
+		throw lib::exception::invalid_argument<>(L"特異行列です。");
+}
+
+/**
+ * A*x= b を解く。同じAで何度も解く場合はlu_decompositionを使う。<br>
+ *
+ * @param a 係数行列
+ * @param b 右辺
+ * @return
+ *     解x
+ * @throw lib::exception::invalid_argument<> 次元が合わない場合、Aが特異な場合
+ */
+template<int N, class Elm>
+inline
+vector<N, Elm> solve(matrix<N, N, Elm> const& a, vector<N, Elm> const& b){
+	return lu_decomposition<N, Elm>(a).solve(b);
+}
+
+/**
+ * 行列式をLU分解で計算する。<br>
+ * 4×4以下の行列ではmatrix.hppの展開された版が選ばれる。<br>
+ *
+ * @param a 正方行列
+ * @return
+ *     aの行列式
+ */
+template<int N, class Elm>
+inline
+Elm determinant(matrix<N, N, Elm> const& a){
+	return lu_decomposition<N, Elm>(a).determinant();
+}
+
+/**
+ * 逆行列をLU分解で計算する。<br>
+ * 4×4以下の行列ではmatrix.hppの展開された版が選ばれる。<br>
+ *
+ * @param a 正方行列
+ * @return
+ *     aの逆行列
+ * @throw lib::exception::invalid_argument<> aが特異な場合
+ */
+template<int N, class Elm>
+inline
+matrix<N, N, Elm> inverse(matrix<N, N, Elm> const& a){
+	return lu_decomposition<N, Elm>(a).inverse();
+}
+
+}
+}
+
+#endif // #ifndef LIB_MATH_DECOMPOSITION_LU_HPP_
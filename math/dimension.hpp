@@ -0,0 +1,74 @@
+#ifndef LIB_MATH_DIMENSION_HPP_
+#define LIB_MATH_DIMENSION_HPP_
+
+#include "../exception/invalid_argument.hpp"
+
+namespace lib{
+namespace math{
+
+/**
+ * 次元が実行時に決まることを表す値。<br>
+ * vector<dynamic>、matrix<dynamic, dynamic>として使う。<br>
+ */
+static int const dynamic= -1;
+
+/**
+ * 2つのコンパイル時の次元が演算可能か判定する。<br>
+ * 一致するか、どちらかがdynamicなら演算可能とする。<br>
+ *
+ * @param l 左辺の次元
+ * @param r 右辺の次元
+ * @return
+ *     演算可能ならtrue
+ */
+constexpr
+bool compatible_dimension(int l, int r){
+	return l == r || l == dynamic || r == dynamic;
+}
+
+/**
+ * 行数と列数が小さく、要素をオブジェクト内に直接保持して
+ * 完全に展開した演算で扱う次元か判定する。<br>
+ * 2×2、3×3、4×4の変換行列や3次元ベクトルなどが該当する。<br>
+ *
+ * @param n 行数
+ * @param m 列数(ベクトルの場合は1)
+ * @return
+ *     どちらも1以上4以下ならtrue
+ */
+constexpr
+bool small_dimension(int n, int m){
+	return n > 0 && m > 0 && n <= 4 && m <= 4;
+}
+
+/**
+ * 2つのコンパイル時の次元から、演算結果の次元を求める。<br>
+ * どちらかがdynamicなら他方を採用し、一致しなければコンパイルエラーとする。<br>
+ *
+ * @param <L> 左辺の次元
+ * @param <R> 右辺の次元
+ */
+template<int L, int R>
+struct common_dimension{
+	static_assert(compatible_dimension(L, R), "dimension mismatch");
+
+	static int const value= (L == dynamic) ? R : L;
+};
+
+/**
+ * 実行時の次元が一致するか確認する。<br>
+ *
+ * @param expected 期待する次元
+ * @param actual   実際の次元
+ * @throw lib::exception::invalid_argument<> 一致しない場合
+ */
+constexpr
+void check_dimension(int expected, int actual){
+	if(expected != actual)
+		throw lib::exception::invalid_argument<>(L"次元が一致しません。");
+}
+
+}
+}
+
+#endif // #ifndef LIB_MATH_DIMENSION_HPP_
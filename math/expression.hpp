@@ -0,0 +1,274 @@
+#ifndef LIB_MATH_EXPRESSION_HPP_
+#define LIB_MATH_EXPRESSION_HPP_
+
+#include <type_traits>
+#include <stdint.h>
+#include "dimension.hpp"
+
+namespace lib{
+namespace math{
+
+/**
+ * ベクトルとして評価される式の基底クラス。<br>
+ * 派生クラスEは以下を提供する。<br>
+ *   value_type     要素の型<br>
+ *   dimension      コンパイル時の次元(実行時に決まる場合はdynamic)<br>
+ *   size()         次元<br>
+ *   element(i)     i番目の要素(範囲チェックなし)<br>
+ *   overlaps(f, l) アドレス[f, l)の要素を参照し得るか<br>
+ * vector同士の加減算などはこの式を組み立てるだけで、代入先の
+ * vectorを構築する時点で1回のループとして評価される。<br>
+ * 式は左辺値のvectorを参照で保持するため、一時オブジェクトを含む式を
+ * autoで受けて後から評価してはならない。<br>
+ *
+ * @author  kamichidu
+ * @param <E> 派生クラス
+ */
+template<class E>
+class vector_expression{
+	public:
+		E const& self() const{ return static_cast<E const&>(*this); }
+};
+
+/**
+ * 行列として評価される式の基底クラス。<br>
+ * 派生クラスEは以下を提供する。<br>
+ *   value_type     要素の型<br>
+ *   row_dimension  コンパイル時の行数(実行時に決まる場合はdynamic)<br>
+ *   col_dimension  コンパイル時の列数(実行時に決まる場合はdynamic)<br>
+ *   rows(), cols() 行数、列数<br>
+ *   element(i, j)  i行j列の要素(範囲チェックなし)<br>
+ *   overlaps(f, l) アドレス[f, l)の要素を参照し得るか<br>
+ *
+ * @author  kamichidu
+ * @param <E> 派生クラス
+ */
+template<class E>
+class matrix_expression;
+
+namespace expression{
+
+/**
+ * 式のオペランドの保持方法。<br>
+ * vectorやmatrixのような実体は参照で、式のノードは値で保持する。<br>
+ * 式のノードと、vector_viewやmatrix_viewのような軽量な参照はtypedef void is_expression_node;を持つ。<br>
+ */
+/**
+ * アドレスの範囲[first, last)と[lo, hi)が重なるか。<br>
+ */
+inline
+bool intersects(void const* first, void const* last, void const* lo, void const* hi){
+	return reinterpret_cast<uintptr_t>(lo) < reinterpret_cast<uintptr_t>(last) && reinterpret_cast<uintptr_t>(first) < reinterpret_cast<uintptr_t>(hi);
+}
+
+template<class T, class Enable= void>
+struct operand{
+	typedef T const& type;
+};
+
+template<class T>
+struct operand<T, typename T::is_expression_node>{
+	typedef T const type;
+};
+
+/**
+ * matrix_expressionの1行を表す。式[i][j]の形で要素を取り出すためのもの。<br>
+ */
+template<class E>
+class matrix_row{
+	public:
+		matrix_row(E const& e, int row) : _e(e), _row(row){}
+	public:
+		typename E::value_type operator [] (int col) const{ return _e.element(_row, col); }
+	private:
+		E const& _e;
+		int _row;
+};
+
+struct plus{
+	template<class T>
+		static T apply(T const& l, T const& r){ return l + r; }
+};
+
+struct minus{
+	template<class T>
+		static T apply(T const& l, T const& r){ return l - r; }
+};
+
+/**
+ * 要素ごとの二項演算を表すベクトル式。<br>
+ */
+template<class L, class R, class Op>
+class vector_binary : public vector_expression<vector_binary<L, R, Op>>{
+	public:
+		typedef void is_expression_node;
+		typedef typename L::value_type value_type;
+
+		static int const dimension= common_dimension<L::dimension, R::dimension>::value;
+	public:
+		vector_binary(L const& l, R const& r) : _l(l), _r(r){
+			check_dimension(_l.size(), _r.size());
+		}
+	public:
+		int size() const{ return _l.size(); }
+		value_type element(int i) const{ return Op::apply(_l.element(i), _r.element(i)); }
+		bool overlaps(void const* first, void const* last) const{ return _l.overlaps(first, last) || _r.overlaps(first, last); }
+		value_type operator [] (int i) const{ return element(i); }
+	private:
+		typename operand<L>::type _l;
+		typename operand<R>::type _r;
+};
+
+/**
+ * スカラー倍を表すベクトル式。<br>
+ */
+template<class E>
+class vector_scaled : public vector_expression<vector_scaled<E>>{
+	public:
+		typedef void is_expression_node;
+		typedef typename E::value_type value_type;
+
+		static int const dimension= E::dimension;
+	public:
+		vector_scaled(value_type const& s, E const& e) : _s(s), _e(e){}
+	public:
+		int size() const{ return _e.size(); }
+		value_type element(int i) const{ return _s * _e.element(i); }
+		bool overlaps(void const* first, void const* last) const{ return _e.overlaps(first, last); }
+		value_type operator [] (int i) const{ return element(i); }
+	private:
+		value_type _s;
+		typename operand<E>::type _e;
+};
+
+/**
+ * 要素ごとの二項演算を表す行列式。<br>
+ */
+template<class L, class R, class Op>
+class matrix_binary : public matrix_expression<matrix_binary<L, R, Op>>{
+	public:
+		typedef void is_expression_node;
+		typedef typename L::value_type value_type;
+
+		static int const row_dimension= common_dimension<L::row_dimension, R::row_dimension>::value;
+		static int const col_dimension= common_dimension<L::col_dimension, R::col_dimension>::value;
+	public:
+		matrix_binary(L const& l, R const& r) : _l(l), _r(r){
+			check_dimension(_l.rows(), _r.rows());
+			check_dimension(_l.cols(), _r.cols());
+		}
+	public:
+		int rows() const{ return _l.rows(); }
+		int cols() const{ return _l.cols(); }
+		value_type element(int i, int j) const{ return Op::apply(_l.element(i, j), _r.element(i, j)); }
+		bool overlaps(void const* first, void const* last) const{ return _l.overlaps(first, last) || _r.overlaps(first, last); }
+	private:
+		typename operand<L>::type _l;
+		typename operand<R>::type _r;
+};
+
+/**
+ * スカラー倍を表す行列式。<br>
+ */
+template<class E>
+class matrix_scaled : public matrix_expression<matrix_scaled<E>>{
+	public:
+		typedef void is_expression_node;
+		typedef typename E::value_type value_type;
+
+		static int const row_dimension= E::row_dimension;
+		static int const col_dimension= E::col_dimension;
+	public:
+		matrix_scaled(value_type const& s, E const& e) : _s(s), _e(e){}
+	public:
+		int rows() const{ return _e.rows(); }
+		int cols() const{ return _e.cols(); }
+		value_type element(int i, int j) const{ return _s * _e.element(i, j); }
+		bool overlaps(void const* first, void const* last) const{ return _e.overlaps(first, last); }
+	private:
+		value_type _s;
+		typename operand<E>::type _e;
+};
+
+/**
+ * 式が代入先の、同じ位置以外の要素を参照し得るか。<br>
+ * vectorやmatrixを組み合わせた式は各要素の位置の要素しか参照しないが、
+ * vector_viewやmatrix_view(transpose_viewなど)は代入先の別の位置を指していることがある。
+ * 代入はこれがtrueの場合だけ一時オブジェクトに評価してから写す。<br>
+ */
+template<class E>
+struct may_alias : std::false_type{};
+
+template<class L, class R, class Op>
+struct may_alias<vector_binary<L, R, Op>> : std::integral_constant<bool, may_alias<L>::value || may_alias<R>::value>{};
+
+template<class E>
+struct may_alias<vector_scaled<E>> : may_alias<E>{};
+
+template<class L, class R, class Op>
+struct may_alias<matrix_binary<L, R, Op>> : std::integral_constant<bool, may_alias<L>::value || may_alias<R>::value>{};
+
+template<class E>
+struct may_alias<matrix_scaled<E>> : may_alias<E>{};
+
+}
+
+template<class E>
+class matrix_expression{
+	public:
+		E const& self() const{ return static_cast<E const&>(*this); }
+		expression::matrix_row<E> operator [] (int row) const{ return expression::matrix_row<E>(self(), row); }
+};
+
+template<class L, class R>
+inline
+expression::vector_binary<L, R, expression::plus> const operator + (vector_expression<L> const& l, vector_expression<R> const& r){
+	return expression::vector_binary<L, R, expression::plus>(l.self(), r.self());
+}
+
+template<class L, class R>
+inline
+expression::vector_binary<L, R, expression::minus> const operator - (vector_expression<L> const& l, vector_expression<R> const& r){
+	return expression::vector_binary<L, R, expression::minus>(l.self(), r.self());
+}
+
+template<class E>
+inline
+expression::vector_scaled<E> const operator * (typename E::value_type const& s, vector_expression<E> const& e){
+	return expression::vector_scaled<E>(s, e.self());
+}
+
+template<class E>
+inline
+expression::vector_scaled<E> const operator * (vector_expression<E> const& e, typename E::value_type const& s){
+	return expression::vector_scaled<E>(s, e.self());
+}
+
+template<class L, class R>
+inline
+expression::matrix_binary<L, R, expression::plus> const operator + (matrix_expression<L> const& l, matrix_expression<R> const& r){
+	return expression::matrix_binary<L, R, expression::plus>(l.self(), r.self());
+}
+
+template<class L, class R>
+inline
+expression::matrix_binary<L, R, expression::minus> const operator - (matrix_expression<L> const& l, matrix_expression<R> const& r){
+	return expression::matrix_binary<L, R, expression::minus>(l.self(), r.self());
+}
+
+template<class E>
+inline
+expression::matrix_scaled<E> const operator * (typename E::value_type const& s, matrix_expression<E> const& e){
+	return expression::matrix_scaled<E>(s, e.self());
+}
+
+template<class E>
+inline
+expression::matrix_scaled<E> const operator * (matrix_expression<E> const& e, typename E::value_type const& s){
+	return expression::matrix_scaled<E>(s, e.self());
+}
+
+}
+}
+
+#endif // #ifndef LIB_MATH_EXPRESSION_HPP_
@@ -0,0 +1,329 @@
+#ifndef LIB_MATH_HDR_HISTOGRAM_HPP_
+#define LIB_MATH_HDR_HISTOGRAM_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include <stdint.h>
+#include "../exception/invalid_argument.hpp"
+
+namespace lib{
+namespace math{
+
+/**
+ * 0以上の整数値(レイテンシなど)を対数線形の区間で数えるヒストグラム(HdrHistogram方式)<br>
+ * 2^precision未満の値は1ずつの区間で正確に数え、それ以上は2の冪ごとに2^(precision-1)個の
+ * 等幅の区間に分ける。どの値も相対誤差2^(1-precision)以内の区間に入り
+ * (precision= 7で約1.6%)、区間の数はprecisionだけで決まる(precision= 7で約3800個)。<br>
+ * record()は区間の添字をビット演算で求め、その区間のカウンタにアトミックに加算するだけなので、
+ * ロックを取らずに複数のスレッドから同時に呼べる。回数や平均は問い合わせの時に全区間から求める。
+ * 問い合わせを記録と並行して呼ぶと、途中までの記録を数えることがある。<br>
+ * 多数のスレッドが同じ範囲の値を頻繁に記録する場合は、カウンタの取り合いを避けるため
+ * スレッドごとにヒストグラムを持ち、merge()で合わせる。<br>
+ *
+ * @author  kamichidu
+ * @see lib::time::stop_watch::record_to(hdr_histogram*)
+ */
+class hdr_histogram{
+	public:
+		explicit hdr_histogram(int precision= 7);
+		hdr_histogram(hdr_histogram const&)= delete;
+		hdr_histogram& operator = (hdr_histogram const&)= delete;
+	public:
+		void record(int64_t value);
+		void record(int64_t value, int64_t count);
+		void merge(hdr_histogram const& r);
+		void reset();
+		int precision() const;
+		int64_t size() const;
+		int64_t min() const;
+		int64_t max() const;
+		double mean() const;
+		int64_t quantile(double p) const;
+		std::vector<int64_t> quantiles(std::vector<double> const& ps) const;
+		int64_t count_between(int64_t lo, int64_t hi) const;
+		int64_t lowest_equivalent(int64_t value) const;
+		int64_t highest_equivalent(int64_t value) const;
+	private:
+		int index(uint64_t value) const;
+		int64_t lowest_of(int i) const;
+	private:
+		int _precision;
+		int _buckets;
+		std::unique_ptr<std::atomic<int64_t>[]> _counts;
+		std::atomic<int64_t> _min;
+		std::atomic<int64_t> _max;
+};
+
+/**
+ * 空のヒストグラムを作る。<br>
+ *
+ * @param precision 区間の細かさ。1以上20以下
+ * @throw lib::exception::invalid_argument<> precisionが範囲外の場合
+ */
+inline
+hdr_histogram::hdr_histogram(int precision) :
+	_precision(precision), _buckets(0), _counts(), _min(std::numeric_limits<int64_t>::max()), _max(0){
+	if(precision < 1 || precision > 20)
+		throw lib::exception::invalid_argument<>(L"精度は1以上20以下でなければなりません。");
+
+	_buckets= index(std::numeric_limits<uint64_t>::max() >> 1) + 1;
+	_counts.reset(new std::atomic<int64_t>[_buckets]);
+	for(int i= 0; i < _buckets; ++i)
+		_counts[i].store(0, std::memory_order_relaxed);
+}
+
+/**
+ * 値を1回記録する。負の値は0として数える。<br>
+ *
+ * @param value 値
+ */
+inline
+void hdr_histogram::record(int64_t value){
+	record(value, 1);
+}
+
+/**
+ * 値をcount回記録する。<br>
+ *
+ * @param value 値。負の値は0として数える
+ * @param count 回数
+ */
+inline
+void hdr_histogram::record(int64_t value, int64_t count){
+	if(value < 0)
+		value= 0;
+
+	_counts[index(value)].fetch_add(count, std::memory_order_relaxed);
+
+	int64_t lo= _min.load(std::memory_order_relaxed);
+	while(value < lo && !_min.compare_exchange_weak(lo, value, std::memory_order_relaxed))
+		;
+
+	int64_t hi= _max.load(std::memory_order_relaxed);
+	while(value > hi && !_max.compare_exchange_weak(hi, value, std::memory_order_relaxed))
+		;
+}
+
+/**
+ * 別のヒストグラムの記録を加える。<br>
+ *
+ * @param r 加えるヒストグラム
+ * @throw lib::exception::invalid_argument<> precisionが異なる場合
+ */
+inline
+void hdr_histogram::merge(hdr_histogram const& r){
+	if(r._precision != _precision)
+		throw lib::exception::invalid_argument<>(L"精度の異なるヒストグラムは合わせられません。");
+
+	for(int i= 0; i < _buckets; ++i){
+		int64_t const c= r._counts[i].load(std::memory_order_relaxed);
+
+		if(c != 0)
+			_counts[i].fetch_add(c, std::memory_order_relaxed);
+	}
+
+	int64_t const rlo= r._min.load(std::memory_order_relaxed);
+	int64_t lo= _min.load(std::memory_order_relaxed);
+	while(rlo < lo && !_min.compare_exchange_weak(lo, rlo, std::memory_order_relaxed))
+		;
+
+	int64_t const rhi= r._max.load(std::memory_order_relaxed);
+	int64_t hi= _max.load(std::memory_order_relaxed);
+	while(rhi > hi && !_max.compare_exchange_weak(hi, rhi, std::memory_order_relaxed))
+		;
+}
+
+/**
+ * すべての記録を消す。記録と並行して呼んではいけない。<br>
+ */
+inline
+void hdr_histogram::reset(){
+	for(int i= 0; i < _buckets; ++i)
+		_counts[i].store(0, std::memory_order_relaxed);
+	_min.store(std::numeric_limits<int64_t>::max(), std::memory_order_relaxed);
+	_max.store(0, std::memory_order_relaxed);
+}
+
+inline
+int hdr_histogram::precision() const{
+	return _precision;
+}
+
+/**
+ * 記録した回数。全区間を数え上げる。<br>
+ */
+inline
+int64_t hdr_histogram::size() const{
+	int64_t total= 0;
+
+	for(int i= 0; i < _buckets; ++i)
+		total+= _counts[i].load(std::memory_order_relaxed);
+
+	return total;
+}
+
+/**
+ * 記録した最小値(正確な値)。size() == 0の場合は0。<br>
+ */
+inline
+int64_t hdr_histogram::min() const{
+	return (size() > 0) ? _min.load(std::memory_order_relaxed) : 0;
+}
+
+/**
+ * 記録した最大値(正確な値)。size() == 0の場合は0。<br>
+ */
+inline
+int64_t hdr_histogram::max() const{
+	return _max.load(std::memory_order_relaxed);
+}
+
+/**
+ * 記録した値の平均。各区間の値をその区間の中央の値とみなして求めるので、
+ * 分位数と同じ相対誤差を含む。size() == 0の場合は0。<br>
+ */
+inline
+double hdr_histogram::mean() const{
+	int64_t n= 0;
+	double sum= 0.;
+
+	for(int i= 0; i < _buckets; ++i){
+		int64_t const c= _counts[i].load(std::memory_order_relaxed);
+
+		if(c != 0){
+			int64_t const lo= lowest_of(i);
+
+			n+= c;
+			sum+= (static_cast<double>(lo) + static_cast<double>(highest_equivalent(lo) - lo) / 2.) * static_cast<double>(c);
+		}
+	}
+
+	return (n > 0) ? sum / static_cast<double>(n) : 0.;
+}
+
+/**
+ * p分位数。小さい方から数えてceil(p * size())番目の値が入っている区間の上端を返す。
+ * ただしmax()を超えることはない。quantile(0)はmin()。<br>
+ *
+ * @param p 0以上1以下の割合
+ * @throw lib::exception::invalid_argument<> pが範囲外の場合
+ * @throw std::out_of_range size() == 0の場合
+ */
+inline
+int64_t hdr_histogram::quantile(double p) const{
+	return quantiles(std::vector<double>(1, p)).front();
+}
+
+/**
+ * 複数のp分位数をまとめて求める。区間を1回だけ走査する。<br>
+ *
+ * @param ps 0以上1以下の割合の列
+ * @return
+ *     psと同じ順の分位数
+ * @throw lib::exception::invalid_argument<> 範囲外の割合がある場合
+ * @throw std::out_of_range size() == 0の場合
+ * @see quantile(double)
+ */
+inline
+std::vector<int64_t> hdr_histogram::quantiles(std::vector<double> const& ps) const{
+	for(double p : ps){
+		if(!(p >= 0. && p <= 1.))
+			throw lib::exception::invalid_argument<>(L"割合は0以上1以下でなければなりません。");
+	}
+
+	int64_t const n= size();
+
+	if(n == 0)
+		throw std::out_of_range("lib::math::hdr_histogram");
+
+	std::vector<std::pair<int64_t, std::size_t>> ranks(ps.size());
+
+	for(std::size_t i= 0; i < ps.size(); ++i)
+		ranks[i]= std::make_pair(static_cast<int64_t>(std::ceil(ps[i] * static_cast<double>(n))), i);
+	std::sort(ranks.begin(), ranks.end());
+
+	std::vector<int64_t> result(ps.size(), max());
+	int64_t cumulative= 0;
+	std::size_t r= 0;
+
+	for(; r < ranks.size() && ranks[r].first == 0; ++r)
+		result[ranks[r].second]= min();
+
+	for(int i= 0; i < _buckets && r < ranks.size(); ++i){
+		cumulative+= _counts[i].load(std::memory_order_relaxed);
+		for(; r < ranks.size() && ranks[r].first <= cumulative; ++r)
+			result[ranks[r].second]= std::min(highest_equivalent(lowest_of(i)), max());
+	}
+
+	return result;
+}
+
+/**
+ * lo以上hi以下の区間に入った回数。lo、hiを含む区間全体を数える。<br>
+ */
+inline
+int64_t hdr_histogram::count_between(int64_t lo, int64_t hi) const{
+	int64_t count= 0;
+	int const last= index(std::max<int64_t>(hi, 0));
+
+	for(int i= index(std::max<int64_t>(lo, 0)); i <= last; ++i)
+		count+= _counts[i].load(std::memory_order_relaxed);
+
+	return count;
+}
+
+/**
+ * valueと同じ区間に入る最小の値。<br>
+ */
+inline
+int64_t hdr_histogram::lowest_equivalent(int64_t value) const{
+	return lowest_of(index(std::max<int64_t>(value, 0)));
+}
+
+/**
+ * valueと同じ区間に入る最大の値。<br>
+ */
+inline
+int64_t hdr_histogram::highest_equivalent(int64_t value) const{
+	int const i= index(std::max<int64_t>(value, 0));
+
+	return (i + 1 < _buckets) ? lowest_of(i + 1) - 1 : std::numeric_limits<int64_t>::max();
+}
+
+/**
+ * 区間の添字。最上位ビットの位置から区間の幅2^hを決め、valueをhビット右にずらしたものを
+ * 2^(precision-1)個ずつの組の中の位置とする。<br>
+ */
+inline
+int hdr_histogram::index(uint64_t value) const{
+	int const msb= 63 - __builtin_clzll(value | 1);
+	int const h= std::max(0, msb - _precision + 1);
+
+	return (h << (_precision - 1)) + static_cast<int>(value >> h);
+}
+
+/**
+ * 添字iの区間に入る最小の値。index()の逆。<br>
+ */
+inline
+int64_t hdr_histogram::lowest_of(int i) const{
+	int const half= 1 << (_precision - 1);
+
+	if(i < 2 * half)
+		return i;
+
+	int const h= i / half - 1;
+
+	return static_cast<int64_t>(i - h * half) << h;
+}
+
+}
+}
+
+#endif // #ifndef LIB_MATH_HDR_HISTOGRAM_HPP_
@@ -0,0 +1,374 @@
+#ifndef LIB_MATH_KERNEL_BATCH_HPP_
+#define LIB_MATH_KERNEL_BATCH_HPP_
+
+#include <type_traits>
+#include "config.hpp"
+#include "simd.hpp"
+
+namespace lib{
+namespace math{
+namespace kernel{
+
+/**
+ * 構造体の配列ではなく配列の構造体(SoA)で並べた、多数の小さな行列・ベクトルに
+ * 同じ演算を適用するカーネル。<br>
+ * 成分eのcount個のインスタンスはp[e * stride + k] (0 <= k < count)に並ぶ。<br>
+ * strideは64バイトの倍数でなければならず、SIMDレジスタの各レーンが
+ * 異なるインスタンスを受け持つ。末尾の端数は詰め物の領域まで含めて計算する。<br>
+ * 各チャンクは入力をすべて読み込んでから書き出すため、出力は入力と同じ領域でもよい。<br>
+ */
+namespace detail{
+
+/**
+ * c= a*b (aはN行M列、bはM行O列)。<br>
+ */
+template<int N, int M, int O>
+struct batch_gemm_lanes{
+	static int const x_components= N * M;
+	static int const y_components= M * O;
+	static int const z_components= N * O;
+
+	template<class T>
+	LIB_MATH_KERNEL_INLINE
+	static void apply(T const* a, T const* b, T* c){
+		LIB_MATH_KERNEL_UNROLL(4)
+		for(int i= 0; i < N; ++i){
+			LIB_MATH_KERNEL_UNROLL(4)
+			for(int j= 0; j < O; ++j){
+				T acc= a[i * M] * b[j];
+
+				LIB_MATH_KERNEL_UNROLL(4)
+				for(int k= 1; k < M; ++k)
+					acc+= a[i * M + k] * b[k * O + j];
+
+				c[i * O + j]= acc;
+			}
+		}
+	}
+};
+
+/**
+ * z= x+y (成分数C)。<br>
+ */
+template<int C>
+struct batch_add_lanes{
+	static int const x_components= C;
+	static int const y_components= C;
+	static int const z_components= C;
+
+	template<class T>
+	LIB_MATH_KERNEL_INLINE
+	static void apply(T const* x, T const* y, T* z){
+		LIB_MATH_KERNEL_UNROLL(16)
+		for(int e= 0; e < C; ++e)
+			z[e]= x[e] + y[e];
+	}
+};
+
+template<int Bytes, class Lanes, bool Broadcast, class Elm>
+LIB_MATH_KERNEL_INLINE
+void batch_apply(int count, int stride, Elm const* x, Elm const* y, Elm* z, std::false_type){
+	Elm vx[Lanes::x_components], vy[Lanes::y_components], vz[Lanes::z_components];
+
+	if(Broadcast){
+		for(int e= 0; e < Lanes::x_components; ++e)
+			vx[e]= x[e];
+	}
+	for(int k= 0; k < count; ++k){
+		if(!Broadcast){
+			for(int e= 0; e < Lanes::x_components; ++e)
+				vx[e]= x[e * stride + k];
+		}
+		for(int e= 0; e < Lanes::y_components; ++e)
+			vy[e]= y[e * stride + k];
+
+		Lanes::apply(vx, vy, vz);
+
+		for(int e= 0; e < Lanes::z_components; ++e)
+			z[e * stride + k]= vz[e];
+	}
+}
+
+template<int Bytes, class Lanes, bool Broadcast, class Elm>
+LIB_MATH_KERNEL_INLINE
+void batch_apply(int count, int stride, Elm const* x, Elm const* y, Elm* z, std::true_type){
+	typedef simd<Elm, Bytes> S;
+	typedef typename S::type V;
+	int const L= S::lanes;
+	V vx[Lanes::x_components], vy[Lanes::y_components], vz[Lanes::z_components];
+
+	if(Broadcast){
+		LIB_MATH_KERNEL_UNROLL(16)
+		for(int e= 0; e < Lanes::x_components; ++e)
+			vx[e]= V{} + x[e];
+	}
+	for(int k= 0; k < count; k+= L){
+		if(!Broadcast){
+			LIB_MATH_KERNEL_UNROLL(16)
+			for(int e= 0; e < Lanes::x_components; ++e)
+				S::load(vx[e], x + e * stride + k);
+		}
+		LIB_MATH_KERNEL_UNROLL(16)
+		for(int e= 0; e < Lanes::y_components; ++e)
+			S::load(vy[e], y + e * stride + k);
+
+		Lanes::apply(vx, vy, vz);
+
+		LIB_MATH_KERNEL_UNROLL(16)
+		for(int e= 0; e < Lanes::z_components; ++e)
+			S::store(z + e * stride + k, vz[e]);
+	}
+}
+
+template<class Lanes, bool Broadcast, class Elm>
+struct batch_op{
+	typedef void result_type;
+
+	int count;
+	int stride;
+	Elm const* x;
+	Elm const* y;
+	Elm* z;
+
+	template<isa Isa>
+	LIB_MATH_KERNEL_INLINE
+	void apply() const{
+		int const bytes= isa_traits<Isa>::simd_bytes;
+		batch_apply<bytes, Lanes, Broadcast>(count, stride, x, y, z, typename simd<Elm, bytes>::enabled());
+	}
+};
+
+/**
+ * 余因子行列による逆行列。行列式はdetに返す。<br>
+ * ベクトル型を値で返すとABIの警告が出るため、出力引数で受け取る。<br>
+ */
+template<class Elm, class T>
+LIB_MATH_KERNEL_INLINE
+void invert_lanes(std::integral_constant<int, 2>, T const* a, T* r, T& det){
+	det= a[0] * a[3] - a[1] * a[2];
+	T const inv= (T{} + Elm(1)) / det;
+
+	r[0]=  a[3] * inv;
+	r[1]= -a[1] * inv;
+	r[2]= -a[2] * inv;
+	r[3]=  a[0] * inv;
+}
+
+template<class Elm, class T>
+LIB_MATH_KERNEL_INLINE
+void invert_lanes(std::integral_constant<int, 3>, T const* a, T* r, T& det){
+	T const c0= a[4] * a[8] - a[5] * a[7];
+	T const c1= a[5] * a[6] - a[3] * a[8];
+	T const c2= a[3] * a[7] - a[4] * a[6];
+	det= a[0] * c0 + a[1] * c1 + a[2] * c2;
+	T const inv= (T{} + Elm(1)) / det;
+
+	r[0]= c0 * inv;
+	r[1]= (a[2] * a[7] - a[1] * a[8]) * inv;
+	r[2]= (a[1] * a[5] - a[2] * a[4]) * inv;
+	r[3]= c1 * inv;
+	r[4]= (a[0] * a[8] - a[2] * a[6]) * inv;
+	r[5]= (a[2] * a[3] - a[0] * a[5]) * inv;
+	r[6]= c2 * inv;
+	r[7]= (a[1] * a[6] - a[0] * a[7]) * inv;
+	r[8]= (a[0] * a[4] - a[1] * a[3]) * inv;
+}
+
+template<class Elm, class T>
+LIB_MATH_KERNEL_INLINE
+void invert_lanes(std::integral_constant<int, 4>, T const* a, T* r, T& det){
+	T const s0= a[0] * a[5] - a[4] * a[1];
+	T const s1= a[0] * a[6] - a[4] * a[2];
+	T const s2= a[0] * a[7] - a[4] * a[3];
+	T const s3= a[1] * a[6] - a[5] * a[2];
+	T const s4= a[1] * a[7] - a[5] * a[3];
+	T const s5= a[2] * a[7] - a[6] * a[3];
+	T const c5= a[10] * a[15] - a[14] * a[11];
+	T const c4= a[9] * a[15] - a[13] * a[11];
+	T const c3= a[9] * a[14] - a[13] * a[10];
+	T const c2= a[8] * a[15] - a[12] * a[11];
+	T const c1= a[8] * a[14] - a[12] * a[10];
+	T const c0= a[8] * a[13] - a[12] * a[9];
+	det= s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+	T const inv= (T{} + Elm(1)) / det;
+
+	r[0]=  ( a[5] * c5 - a[6] * c4 + a[7] * c3) * inv;
+	r[1]=  (-a[1] * c5 + a[2] * c4 - a[3] * c3) * inv;
+	r[2]=  ( a[13] * s5 - a[14] * s4 + a[15] * s3) * inv;
+	r[3]=  (-a[9] * s5 + a[10] * s4 - a[11] * s3) * inv;
+	r[4]=  (-a[4] * c5 + a[6] * c2 - a[7] * c1) * inv;
+	r[5]=  ( a[0] * c5 - a[2] * c2 + a[3] * c1) * inv;
+	r[6]=  (-a[12] * s5 + a[14] * s2 - a[15] * s1) * inv;
+	r[7]=  ( a[8] * s5 - a[10] * s2 + a[11] * s1) * inv;
+	r[8]=  ( a[4] * c4 - a[5] * c2 + a[7] * c0) * inv;
+	r[9]=  (-a[0] * c4 + a[1] * c2 - a[3] * c0) * inv;
+	r[10]= ( a[12] * s4 - a[13] * s2 + a[15] * s0) * inv;
+	r[11]= (-a[8] * s4 + a[9] * s2 - a[11] * s0) * inv;
+	r[12]= (-a[4] * c3 + a[5] * c1 - a[6] * c0) * inv;
+	r[13]= ( a[0] * c3 - a[1] * c1 + a[2] * c0) * inv;
+	r[14]= (-a[12] * s3 + a[13] * s1 - a[14] * s0) * inv;
+	r[15]= ( a[8] * s3 - a[9] * s1 + a[10] * s0) * inv;
+}
+
+template<int Bytes, int N, class Elm>
+LIB_MATH_KERNEL_INLINE
+int batch_inverse_lanes(int count, int stride, Elm const* a, Elm* r, std::false_type){
+	int singular= -1;
+	Elm va[N * N], vr[N * N];
+
+	for(int k= 0; k < count; ++k){
+		for(int e= 0; e < N * N; ++e)
+			va[e]= a[e * stride + k];
+
+		Elm det;
+
+		invert_lanes<Elm>(std::integral_constant<int, N>(), va, vr, det);
+
+		if(det == Elm() && singular < 0)
+			singular= k;
+		for(int e= 0; e < N * N; ++e)
+			r[e * stride + k]= vr[e];
+	}
+
+	return singular;
+}
+
+template<int Bytes, int N, class Elm>
+LIB_MATH_KERNEL_INLINE
+int batch_inverse_lanes(int count, int stride, Elm const* a, Elm* r, std::true_type){
+	typedef simd<Elm, Bytes> S;
+	typedef typename S::type V;
+	int const L= S::lanes;
+	int singular= -1;
+	V va[N * N], vr[N * N];
+
+	for(int k= 0; k < count; k+= L){
+		LIB_MATH_KERNEL_UNROLL(16)
+		for(int e= 0; e < N * N; ++e)
+			S::load(va[e], a + e * stride + k);
+
+		V det;
+
+		invert_lanes<Elm>(std::integral_constant<int, N>(), va, vr, det);
+
+		LIB_MATH_KERNEL_UNROLL(16)
+		for(int e= 0; e < N * N; ++e)
+			S::store(r + e * stride + k, vr[e]);
+
+		if(singular < 0){
+			Elm d[L];
+
+			S::store(d, det);
+			for(int l= 0; l < L && k + l < count; ++l){
+				if(d[l] == Elm()){
+					singular= k + l;
+					break;
+				}
+			}
+		}
+	}
+
+	return singular;
+}
+
+template<int N, class Elm>
+struct batch_inverse_op{
+	typedef int result_type;
+
+	int count;
+	int stride;
+	Elm const* a;
+	Elm* r;
+
+	template<isa Isa>
+	LIB_MATH_KERNEL_INLINE
+	int apply() const{
+		int const bytes= isa_traits<Isa>::simd_bytes;
+		return batch_inverse_lanes<bytes, N>(count, stride, a, r, typename simd<Elm, bytes>::enabled());
+	}
+};
+
+}
+
+/**
+ * インスタンスごとの行列積 c= a*b を計算する。<br>
+ *
+ * @param <N>    aの行数
+ * @param <M>    aの列数(bの行数)
+ * @param <O>    bの列数
+ * @param count  インスタンス数
+ * @param stride 成分の間隔(64バイトの倍数)
+ * @param a      N*M成分
+ * @param b      M*O成分
+ * @param c      N*O成分
+ */
+template<int N, int M, int O, class Elm>
+inline
+void batch_gemm(int count, int stride, Elm const* a, Elm const* b, Elm* c){
+	detail::batch_op<detail::batch_gemm_lanes<N, M, O>, false, Elm> const op= {count, stride, a, b, c};
+	dispatch(op);
+}
+
+/**
+ * すべてのインスタンスに同じ行列aを掛ける c= a*b を計算する。<br>
+ *
+ * @param <N>    aの行数
+ * @param <M>    aの列数(bの行数)
+ * @param <O>    bの列数
+ * @param count  インスタンス数
+ * @param stride 成分の間隔(64バイトの倍数)
+ * @param a      行優先に並んだN*M要素の行列1つ
+ * @param b      M*O成分
+ * @param c      N*O成分
+ */
+template<int N, int M, int O, class Elm>
+inline
+void batch_gemm_broadcast(int count, int stride, Elm const* a, Elm const* b, Elm* c){
+	detail::batch_op<detail::batch_gemm_lanes<N, M, O>, true, Elm> const op= {count, stride, a, b, c};
+	dispatch(op);
+}
+
+/**
+ * インスタンスごとの和 z= x+y を計算する。<br>
+ *
+ * @param <C>    成分数
+ * @param count  インスタンス数
+ * @param stride 成分の間隔(64バイトの倍数)
+ * @param x      C成分
+ * @param y      C成分
+ * @param z      C成分
+ */
+template<int C, class Elm>
+inline
+void batch_add(int count, int stride, Elm const* x, Elm const* y, Elm* z){
+	detail::batch_op<detail::batch_add_lanes<C>, false, Elm> const op= {count, stride, x, y, z};
+	dispatch(op);
+}
+
+/**
+ * インスタンスごとの逆行列を余因子行列から計算する。<br>
+ * 行列式が0のインスタンスの結果は無限大かNaNになる。<br>
+ *
+ * @param <N>    行数(2, 3, 4のいずれか)
+ * @param count  インスタンス数
+ * @param stride 成分の間隔(64バイトの倍数)
+ * @param a      N*N成分
+ * @param r      N*N成分
+ * @return
+ *     行列式が0の最初のインスタンスの添字。なければ-1
+ */
+template<int N, class Elm>
+inline
+int batch_inverse(int count, int stride, Elm const* a, Elm* r){
+	static_assert(N >= 2 && N <= 4, "batch_inverse supports 2x2, 3x3 and 4x4");
+	static_assert(std::is_floating_point<Elm>::value, "batch_inverse requires a floating point type");
+
+	detail::batch_inverse_op<N, Elm> const op= {count, stride, a, r};
+	return dispatch(op);
+}
+
+}
+}
+}
+
+#endif // #ifndef LIB_MATH_KERNEL_BATCH_HPP_
@@ -0,0 +1,139 @@
+#ifndef LIB_MATH_KERNEL_CONFIG_HPP_
+#define LIB_MATH_KERNEL_CONFIG_HPP_
+
+/**
+ * 演算カーネル共通のコンパイラ依存マクロ。<br>
+ *
+ * LIB_MATH_KERNEL_X86_DISPATCH
+ *     x86上のGCC/Clangで定義され、AVX2/AVX-512向けのカーネルを
+ *     実行時のCPU判定で選択できることを示す。<br>
+ *     LIB_MATH_KERNEL_NO_DISPATCHを定義すると無効になる。
+ *
+ * LIB_MATH_KERNEL_UNROLL(n)
+ *     直後のループをn回まで完全に展開するようコンパイラに指示する。<br>
+ */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && !defined(LIB_MATH_KERNEL_NO_DISPATCH)
+#	define LIB_MATH_KERNEL_X86_DISPATCH
+#	define LIB_MATH_KERNEL_TARGET(isa) __attribute__((target(isa)))
+#else
+#	define LIB_MATH_KERNEL_TARGET(isa)
+#endif
+
+#if defined(__GNUC__)
+#	define LIB_MATH_KERNEL_INLINE inline __attribute__((always_inline))
+#	define LIB_MATH_KERNEL_RESTRICT __restrict__
+#	define LIB_MATH_KERNEL_PRAGMA(x) _Pragma(#x)
+#	define LIB_MATH_KERNEL_UNROLL(n) LIB_MATH_KERNEL_PRAGMA(GCC unroll n)
+#elif defined(_MSC_VER)
+#	define LIB_MATH_KERNEL_INLINE __forceinline
+#	define LIB_MATH_KERNEL_RESTRICT __restrict
+#	define LIB_MATH_KERNEL_UNROLL(n)
+#else
+#	define LIB_MATH_KERNEL_INLINE inline
+#	define LIB_MATH_KERNEL_RESTRICT
+#	define LIB_MATH_KERNEL_UNROLL(n)
+#endif
+
+namespace lib{
+namespace math{
+namespace kernel{
+
+/**
+ * 実行中のCPUが対応している命令セット。<br>
+ */
+enum isa{
+	isa_generic,
+	isa_avx2,
+	isa_avx512,
+};
+
+/**
+ * 実行中のCPUで使える最も広い命令セットを返す。<br>
+ * 判定は初回呼び出し時の1回だけ行う。<br>
+ *
+ * @return
+ *     使用可能な命令セット
+ */
+inline
+isa detect_isa(){
+#ifdef LIB_MATH_KERNEL_X86_DISPATCH
+	static isa const detected= [](){
+		__builtin_cpu_init();
+		// invoke_avx512()はDQ、VL命令も生成し得るので、AVX-512Fだけの(Knights Landingのような)CPUでは使わない
+		if(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512vl")
+				&& __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+			return isa_avx512;
+		if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+			return isa_avx2;
+		return isa_generic;
+	}();
+
+	return detected;
+#else
+	return isa_generic;
+#endif
+}
+
+/**
+ * 命令セットごとのSIMDレジスタ幅。<br>
+ */
+template<isa Isa>
+struct isa_traits{
+	static int const simd_bytes= (Isa == isa_avx512) ? 64 : (Isa == isa_avx2) ? 32 : 16;
+};
+
+namespace detail{
+
+template<class F>
+inline
+typename F::result_type invoke_generic(F const& f){
+	return f.template apply<isa_generic>();
+}
+
+#ifdef LIB_MATH_KERNEL_X86_DISPATCH
+template<class F>
+LIB_MATH_KERNEL_TARGET("avx2,fma")
+typename F::result_type invoke_avx2(F const& f){
+	return f.template apply<isa_avx2>();
+}
+
+template<class F>
+LIB_MATH_KERNEL_TARGET("avx512f,avx512dq,avx512vl,avx2,fma")
+typename F::result_type invoke_avx512(F const& f){
+	return f.template apply<isa_avx512>();
+}
+#endif
+
+}
+
+/**
+ * 実行中のCPUに合わせてカーネルを呼び出す。<br>
+ * Fはresult_typeと、LIB_MATH_KERNEL_INLINEなメンバ関数テンプレート
+ * template<isa Isa> result_type apply() constを持つ関数オブジェクト。<br>
+ * applyは命令セットごとのtarget属性付き関数にインライン展開されるため、
+ * その中のループはその命令セットでコンパイルされる。<br>
+ *
+ * @param f カーネル
+ * @return
+ *     f.apply<Isa>()の結果
+ */
+template<class F>
+inline
+typename F::result_type dispatch(F const& f){
+	switch(detect_isa()){
+#ifdef LIB_MATH_KERNEL_X86_DISPATCH
+		case isa_avx512:
+			return detail::invoke_avx512(f);
+		case isa_avx2:
+			return detail::invoke_avx2(f);
+#endif
+		default:
+			return detail::invoke_generic(f);
+	}
+}
+
+}
+}
+}
+
+#endif // #ifndef LIB_MATH_KERNEL_CONFIG_HPP_
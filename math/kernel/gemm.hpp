@@ -0,0 +1,349 @@
+#ifndef LIB_MATH_KERNEL_GEMM_HPP_
+#define LIB_MATH_KERNEL_GEMM_HPP_
+
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+#include "config.hpp"
+#include "simd.hpp"
+#include "../../memory/aligned_allocator.hpp"
+#include "../../thread/pool.hpp"
+
+namespace lib{
+namespace math{
+namespace kernel{
+
+/**
+ * 命令セットごとのGEMMのタイルサイズ。<br>
+ * マイクロカーネルはMR行NR列の累積値をレジスタ上に保持する。<br>
+ * NRはSIMDレジスタ2本分の要素数になるようにしている。<br>
+ * float、int32_tのように4バイト以下の要素では、AVX-512のレジスタ32本を使い切るよう
+ * MRを12に増やし、パネルのバイト数がdoubleと同程度になるようKCを倍にする。<br>
+ *
+ * @param <Elm> 要素の型
+ * @param <Isa> 命令セット
+ */
+template<class Elm, isa Isa>
+struct gemm_tile{
+	static int const simd_bytes= isa_traits<Isa>::simd_bytes;
+	static int const lanes= (simd_bytes / static_cast<int>(sizeof(Elm)) > 0) ? simd_bytes / static_cast<int>(sizeof(Elm)) : 1;
+	static bool const narrow= sizeof(Elm) <= 4;
+
+	static int const mr= (Isa == isa_avx512) ? (narrow ? 12 : 8) : (Isa == isa_avx2) ? 6 : 4;
+	static int const nr= lanes * 2;
+	static int const kc= narrow ? 512 : 256;
+	static int const mc= mr * 16;
+	static int const nc= nr * 128;
+};
+
+template<class Elm, isa Isa>
+int const gemm_tile<Elm, Isa>::simd_bytes;
+template<class Elm, isa Isa>
+int const gemm_tile<Elm, Isa>::lanes;
+template<class Elm, isa Isa>
+bool const gemm_tile<Elm, Isa>::narrow;
+template<class Elm, isa Isa>
+int const gemm_tile<Elm, Isa>::mr;
+template<class Elm, isa Isa>
+int const gemm_tile<Elm, Isa>::nr;
+template<class Elm, isa Isa>
+int const gemm_tile<Elm, Isa>::kc;
+template<class Elm, isa Isa>
+int const gemm_tile<Elm, Isa>::mc;
+template<class Elm, isa Isa>
+int const gemm_tile<Elm, Isa>::nc;
+
+namespace detail{
+
+/**
+ * この要素数(m*n*k)以下の積はパッキングせずに直接計算する。<br>
+ */
+static int const gemm_small_threshold= 24 * 24 * 24;
+
+/**
+ * この要素数(m*n*k)以上の積はCを行(または列)のブロックに分けて並列に計算する。<br>
+ * ブロックごとにBをパックし直すので、ブロックは最低でもgemm_parallel_grain行(列)にする。<br>
+ */
+static long long const gemm_parallel_threshold= 128LL * 128 * 128;
+static int const gemm_parallel_grain= 96;
+
+/**
+ * パック済みのA(MR行)とB(NR列)から、C上のmr行nr列を更新する。<br>
+ */
+template<class Elm, int MR, int NR, int Bytes, class Enabled= typename simd<Elm, Bytes>::enabled>
+struct gemm_micro{
+	LIB_MATH_KERNEL_INLINE
+	static void apply(int kc, Elm const* LIB_MATH_KERNEL_RESTRICT pa, Elm const* LIB_MATH_KERNEL_RESTRICT pb, Elm* c, int ldc, int mr, int nr){
+		Elm acc[MR][NR];
+
+		for(int i= 0; i < MR; ++i)
+			for(int j= 0; j < NR; ++j)
+				acc[i][j]= Elm();
+
+		for(int p= 0; p < kc; ++p){
+			for(int i= 0; i < MR; ++i){
+				Elm const a= pa[p * MR + i];
+
+				for(int j= 0; j < NR; ++j)
+					acc[i][j]+= a * pb[p * NR + j];
+			}
+		}
+
+		for(int i= 0; i < mr; ++i)
+			for(int j= 0; j < nr; ++j)
+				c[i * ldc + j]+= acc[i][j];
+	}
+};
+
+/**
+ * SIMD化できる型向けのマイクロカーネル。<br>
+ * Bytesバイト幅のレジスタを明示的に使い、MR*(NR/レーン数)本の累積レジスタを保持する。<br>
+ */
+template<class Elm, int MR, int NR, int Bytes>
+struct gemm_micro<Elm, MR, NR, Bytes, std::true_type>{
+	typedef simd<Elm, Bytes> simd_traits;
+	typedef typename simd_traits::type simd_type;
+
+	static int const lanes= simd_traits::lanes;
+	static int const nv= NR / lanes;
+
+	static_assert(NR % lanes == 0, "NR must be a multiple of the simd width");
+
+	LIB_MATH_KERNEL_INLINE
+	static void apply(int kc, Elm const* LIB_MATH_KERNEL_RESTRICT pa, Elm const* LIB_MATH_KERNEL_RESTRICT pb, Elm* c, int ldc, int mr, int nr){
+		simd_type acc[MR][nv];
+
+		_Pragma("GCC unroll 16")
+		for(int i= 0; i < MR; ++i)
+			_Pragma("GCC unroll 16")
+			for(int v= 0; v < nv; ++v)
+				acc[i][v]= simd_type{};
+
+		for(int p= 0; p < kc; ++p){
+			simd_type b[nv];
+
+			_Pragma("GCC unroll 16")
+			for(int v= 0; v < nv; ++v)
+				simd_traits::load(b[v], pb + p * NR + v * lanes);
+
+			_Pragma("GCC unroll 16")
+			for(int i= 0; i < MR; ++i){
+				simd_type const a= simd_type{} + pa[p * MR + i];
+
+				_Pragma("GCC unroll 16")
+				for(int v= 0; v < nv; ++v)
+					acc[i][v]+= a * b[v];
+			}
+		}
+
+		Elm out[MR][NR];
+
+		for(int i= 0; i < MR; ++i)
+			for(int v= 0; v < nv; ++v)
+				simd_traits::store(&out[i][v * lanes], acc[i][v]);
+		for(int i= 0; i < mr; ++i)
+			for(int j= 0; j < nr; ++j)
+				c[i * ldc + j]+= out[i][j];
+	}
+};
+
+/**
+ * Aのmc行kc列のブロックを、alpha倍しながらMR行ずつのパネルに詰める。<br>
+ * 端数の行は0で埋める。<br>
+ */
+template<class Elm, int MR>
+LIB_MATH_KERNEL_INLINE
+void gemm_pack_a(int mc, int kc, Elm alpha, Elm const* a, int lda, Elm* pa){
+	for(int i0= 0; i0 < mc; i0+= MR){
+		int const mr= std::min(MR, mc - i0);
+
+		for(int p= 0; p < kc; ++p)
+			for(int i= 0; i < MR; ++i)
+				*pa++= (i < mr) ? alpha * a[(i0 + i) * lda + p] : Elm();
+	}
+}
+
+/**
+ * Bのkc行nc列のブロックを、NR列ずつのパネルに詰める。<br>
+ * 端数の列は0で埋める。<br>
+ */
+template<class Elm, int NR>
+LIB_MATH_KERNEL_INLINE
+void gemm_pack_b(int kc, int nc, Elm const* b, int ldb, Elm* pb){
+	for(int j0= 0; j0 < nc; j0+= NR){
+		int const nr= std::min(NR, nc - j0);
+
+		for(int p= 0; p < kc; ++p){
+			Elm const* const row= b + p * ldb + j0;
+
+			if(nr == NR){
+				for(int j= 0; j < NR; ++j)
+					*pb++= row[j];
+			}
+			else{
+				for(int j= 0; j < NR; ++j)
+					*pb++= (j < nr) ? row[j] : Elm();
+			}
+		}
+	}
+}
+
+/**
+ * パッキングせずにC+= alpha*A*Bを計算する。小さな行列向け。<br>
+ * 最内ループはBとCの行を連続に走査する。<br>
+ */
+template<class Elm>
+LIB_MATH_KERNEL_INLINE
+void gemm_direct(int m, int n, int k, Elm alpha, Elm const* a, int lda, Elm const* b, int ldb, Elm* c, int ldc){
+	for(int i= 0; i < m; ++i){
+		Elm* LIB_MATH_KERNEL_RESTRICT const ci= c + i * ldc;
+
+		for(int p= 0; p < k; ++p){
+			Elm const aip= alpha * a[i * lda + p];
+			Elm const* LIB_MATH_KERNEL_RESTRICT const bp= b + p * ldb;
+
+			for(int j= 0; j < n; ++j)
+				ci[j]+= aip * bp[j];
+		}
+	}
+}
+
+/**
+ * キャッシュブロッキングしたC+= alpha*A*B。<br>
+ * Bのkc*ncブロックをL3、Aのmc*kcブロックをL2、
+ * マイクロカーネルのMR*NRの累積値をレジスタに載せる。<br>
+ */
+template<class Elm, class Tile>
+LIB_MATH_KERNEL_INLINE
+void gemm_blocked(int m, int n, int k, Elm alpha, Elm const* a, int lda, Elm const* b, int ldb, Elm* c, int ldc){
+	int const MR= Tile::mr;
+	int const NR= Tile::nr;
+	int const kc_max= std::min(Tile::kc, k);
+	int const mc_max= (std::min(Tile::mc, m) + MR - 1) / MR * MR;
+	int const nc_max= (std::min(Tile::nc, n) + NR - 1) / NR * NR;
+	std::vector<Elm, memory::aligned_allocator<Elm>> buf_a(mc_max * kc_max);
+	std::vector<Elm, memory::aligned_allocator<Elm>> buf_b(kc_max * nc_max);
+
+	for(int jc= 0; jc < n; jc+= Tile::nc){
+		int const nc= std::min(Tile::nc, n - jc);
+
+		for(int pc= 0; pc < k; pc+= Tile::kc){
+			int const kc= std::min(Tile::kc, k - pc);
+
+			gemm_pack_b<Elm, NR>(kc, nc, b + pc * ldb + jc, ldb, buf_b.data());
+
+			for(int ic= 0; ic < m; ic+= Tile::mc){
+				int const mc= std::min(Tile::mc, m - ic);
+
+				gemm_pack_a<Elm, MR>(mc, kc, alpha, a + ic * lda + pc, lda, buf_a.data());
+
+				for(int j0= 0; j0 < nc; j0+= NR){
+					for(int i0= 0; i0 < mc; i0+= MR){
+						gemm_micro<Elm, MR, NR, Tile::simd_bytes>::apply(
+							kc, buf_a.data() + i0 * kc, buf_b.data() + j0 * kc,
+							c + (ic + i0) * ldc + (jc + j0), ldc,
+							std::min(MR, mc - i0), std::min(NR, nc - j0));
+					}
+				}
+			}
+		}
+	}
+}
+
+template<class Elm, isa Isa>
+LIB_MATH_KERNEL_INLINE
+void gemm_dispatched(int m, int n, int k, Elm alpha, Elm const* a, int lda, Elm const* b, int ldb, Elm* c, int ldc){
+	if(static_cast<long long>(m) * n * k <= gemm_small_threshold)
+		gemm_direct(m, n, k, alpha, a, lda, b, ldb, c, ldc);
+	else
+		gemm_blocked<Elm, gemm_tile<Elm, Isa>>(m, n, k, alpha, a, lda, b, ldb, c, ldc);
+}
+
+template<class Elm>
+struct gemm_op{
+	typedef void result_type;
+
+	int m, n, k;
+	Elm alpha;
+	Elm const* a;
+	int lda;
+	Elm const* b;
+	int ldb;
+	Elm* c;
+	int ldc;
+
+	template<isa Isa>
+	LIB_MATH_KERNEL_INLINE
+	void apply() const{
+		gemm_dispatched<Elm, Isa>(m, n, k, alpha, a, lda, b, ldb, c, ldc);
+	}
+};
+
+}
+
+/**
+ * 行優先の密行列積 C= alpha*A*B + beta*C を計算する。<br>
+ * Aはm行k列、Bはk行n列、Cはm行n列で、lda/ldb/ldcは各行の先頭間の要素数。<br>
+ * 小さな行列は直接計算し、それ以外はキャッシュブロッキングした
+ * マイクロカーネルで計算する。x86ではAVX2/AVX-512版を実行時に選択する。<br>
+ * 大きな積はthread::default_pool()でCのブロックごとに並列に計算する。<br>
+ *
+ * @param m     Cの行数
+ * @param n     Cの列数
+ * @param k     Aの列数(Bの行数)
+ * @param alpha A*Bに掛ける係数
+ * @param a     A
+ * @param lda   Aの行間隔
+ * @param b     B
+ * @param ldb   Bの行間隔
+ * @param beta  Cに掛ける係数
+ * @param c     C
+ * @param ldc   Cの行間隔
+ */
+template<class Elm>
+inline
+void gemm(int m, int n, int k, Elm alpha, Elm const* a, int lda, Elm const* b, int ldb, Elm beta, Elm* c, int ldc){
+	if(m <= 0 || n <= 0)
+		return;
+
+	if(beta == Elm()){
+		for(int i= 0; i < m; ++i)
+			std::fill_n(c + i * ldc, n, Elm());
+	}
+	else if(!(beta == Elm(1))){
+		for(int i= 0; i < m; ++i)
+			for(int j= 0; j < n; ++j)
+				c[i * ldc + j]*= beta;
+	}
+
+	if(k <= 0 || alpha == Elm())
+		return;
+
+	thread::pool& workers= thread::default_pool();
+
+	if(workers.concurrency() == 1 || static_cast<long long>(m) * n * k < detail::gemm_parallel_threshold){
+		detail::gemm_op<Elm> const op= {m, n, k, alpha, a, lda, b, ldb, c, ldc};
+
+		dispatch(op);
+	}
+	else if(m >= n){
+		workers.parallel_for(0, m, std::max(detail::gemm_parallel_grain, m / workers.concurrency()), [&](int i0, int i1){
+			detail::gemm_op<Elm> const op= {i1 - i0, n, k, alpha, a + static_cast<std::size_t>(i0) * lda, lda, b, ldb, c + static_cast<std::size_t>(i0) * ldc, ldc};
+
+			dispatch(op);
+		});
+	}
+	else{
+		workers.parallel_for(0, n, std::max(detail::gemm_parallel_grain, n / workers.concurrency()), [&](int j0, int j1){
+			detail::gemm_op<Elm> const op= {m, j1 - j0, k, alpha, a, lda, b + j0, ldb, c + j0, ldc};
+
+			dispatch(op);
+		});
+	}
+}
+
+}
+}
+}
+
+#endif // #ifndef LIB_MATH_KERNEL_GEMM_HPP_
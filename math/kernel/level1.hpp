@@ -0,0 +1,535 @@
+#ifndef LIB_MATH_KERNEL_LEVEL1_HPP_
+#define LIB_MATH_KERNEL_LEVEL1_HPP_
+
+#include <cmath>
+#include <type_traits>
+#include "config.hpp"
+#include "simd.hpp"
+
+namespace lib{
+namespace math{
+namespace kernel{
+
+namespace detail{
+
+/**
+ * 要素数がこれより少ない場合はディスパッチせずにその場で計算する。<br>
+ */
+static int const level1_inline_threshold= 32;
+
+template<class Elm>
+LIB_MATH_KERNEL_INLINE
+Elm abs(Elm const& x){
+	return (x < Elm()) ? -x : x;
+}
+
+template<class Elm>
+LIB_MATH_KERNEL_INLINE
+Elm dot_scalar(int n, Elm const* x, int incx, Elm const* y, int incy){
+	Elm acc0= Elm(), acc1= Elm(), acc2= Elm(), acc3= Elm();
+	int i= 0;
+
+	for(; i + 4 <= n; i+= 4){
+		acc0+= x[(i + 0) * incx] * y[(i + 0) * incy];
+		acc1+= x[(i + 1) * incx] * y[(i + 1) * incy];
+		acc2+= x[(i + 2) * incx] * y[(i + 2) * incy];
+		acc3+= x[(i + 3) * incx] * y[(i + 3) * incy];
+	}
+	for(; i < n; ++i)
+		acc0+= x[i * incx] * y[i * incy];
+
+	return (acc0 + acc1) + (acc2 + acc3);
+}
+
+template<int Bytes, class Elm>
+LIB_MATH_KERNEL_INLINE
+Elm dot_unit(int n, Elm const* x, Elm const* y, std::false_type){
+	return dot_scalar(n, x, 1, y, 1);
+}
+
+template<int Bytes, class Elm>
+LIB_MATH_KERNEL_INLINE
+Elm dot_unit(int n, Elm const* x, Elm const* y, std::true_type){
+	typedef simd<Elm, Bytes> S;
+	typedef typename S::type V;
+	int const L= S::lanes;
+	V acc0= V{}, acc1= V{}, acc2= V{}, acc3= V{};
+	V a0, a1, a2, a3, b0, b1, b2, b3;
+	int i= 0;
+
+	for(; i + 4 * L <= n; i+= 4 * L){
+		S::load(a0, x + i);         S::load(b0, y + i);
+		S::load(a1, x + i + L);     S::load(b1, y + i + L);
+		S::load(a2, x + i + 2 * L); S::load(b2, y + i + 2 * L);
+		S::load(a3, x + i + 3 * L); S::load(b3, y + i + 3 * L);
+		acc0+= a0 * b0;
+		acc1+= a1 * b1;
+		acc2+= a2 * b2;
+		acc3+= a3 * b3;
+	}
+	for(; i + L <= n; i+= L){
+		S::load(a0, x + i);
+		S::load(b0, y + i);
+		acc0+= a0 * b0;
+	}
+
+	Elm r= S::sum((acc0 + acc1) + (acc2 + acc3));
+
+	for(; i < n; ++i)
+		r+= x[i] * y[i];
+
+	return r;
+}
+
+template<class Elm>
+LIB_MATH_KERNEL_INLINE
+void axpy_scalar(int n, Elm alpha, Elm const* x, int incx, Elm* y, int incy){
+	for(int i= 0; i < n; ++i)
+		y[i * incy]+= alpha * x[i * incx];
+}
+
+template<int Bytes, class Elm>
+LIB_MATH_KERNEL_INLINE
+void axpy_unit(int n, Elm alpha, Elm const* x, Elm* y, std::false_type){
+	axpy_scalar(n, alpha, x, 1, y, 1);
+}
+
+template<int Bytes, class Elm>
+LIB_MATH_KERNEL_INLINE
+void axpy_unit(int n, Elm alpha, Elm const* x, Elm* y, std::true_type){
+	typedef simd<Elm, Bytes> S;
+	typedef typename S::type V;
+	int const L= S::lanes;
+	V const a= V{} + alpha;
+	V x0, x1, y0, y1;
+	int i= 0;
+
+	for(; i + 2 * L <= n; i+= 2 * L){
+		S::load(x0, x + i);     S::load(y0, y + i);
+		S::load(x1, x + i + L); S::load(y1, y + i + L);
+		y0+= a * x0;
+		y1+= a * x1;
+		S::store(y + i, y0);
+		S::store(y + i + L, y1);
+	}
+	for(; i < n; ++i)
+		y[i]+= alpha * x[i];
+}
+
+template<class Elm>
+LIB_MATH_KERNEL_INLINE
+void scale_scalar(int n, Elm alpha, Elm* x, int incx){
+	for(int i= 0; i < n; ++i)
+		x[i * incx]*= alpha;
+}
+
+template<int Bytes, class Elm>
+LIB_MATH_KERNEL_INLINE
+void scale_unit(int n, Elm alpha, Elm* x, std::false_type){
+	scale_scalar(n, alpha, x, 1);
+}
+
+template<int Bytes, class Elm>
+LIB_MATH_KERNEL_INLINE
+void scale_unit(int n, Elm alpha, Elm* x, std::true_type){
+	typedef simd<Elm, Bytes> S;
+	typedef typename S::type V;
+	int const L= S::lanes;
+	V const a= V{} + alpha;
+	V x0, x1;
+	int i= 0;
+
+	for(; i + 2 * L <= n; i+= 2 * L){
+		S::load(x0, x + i);
+		S::load(x1, x + i + L);
+		x0*= a;
+		x1*= a;
+		S::store(x + i, x0);
+		S::store(x + i + L, x1);
+	}
+	for(; i < n; ++i)
+		x[i]*= alpha;
+}
+
+template<class Elm>
+LIB_MATH_KERNEL_INLINE
+void multiply_scalar(int n, Elm const* x, int incx, Elm const* y, int incy, Elm* z, int incz){
+	for(int i= 0; i < n; ++i)
+		z[i * incz]= x[i * incx] * y[i * incy];
+}
+
+template<int Bytes, class Elm>
+LIB_MATH_KERNEL_INLINE
+void multiply_unit(int n, Elm const* x, Elm const* y, Elm* z, std::false_type){
+	multiply_scalar(n, x, 1, y, 1, z, 1);
+}
+
+template<int Bytes, class Elm>
+LIB_MATH_KERNEL_INLINE
+void multiply_unit(int n, Elm const* x, Elm const* y, Elm* z, std::true_type){
+	typedef simd<Elm, Bytes> S;
+	typedef typename S::type V;
+	int const L= S::lanes;
+	V a, b;
+	int i= 0;
+
+	for(; i + L <= n; i+= L){
+		S::load(a, x + i);
+		S::load(b, y + i);
+		a*= b;
+		S::store(z + i, a);
+	}
+	for(; i < n; ++i)
+		z[i]= x[i] * y[i];
+}
+
+template<class Elm>
+LIB_MATH_KERNEL_INLINE
+Elm norm1_scalar(int n, Elm const* x, int incx){
+	Elm acc0= Elm(), acc1= Elm();
+	int i= 0;
+
+	for(; i + 2 <= n; i+= 2){
+		acc0+= abs(x[(i + 0) * incx]);
+		acc1+= abs(x[(i + 1) * incx]);
+	}
+	for(; i < n; ++i)
+		acc0+= abs(x[i * incx]);
+
+	return acc0 + acc1;
+}
+
+template<int Bytes, class Elm>
+LIB_MATH_KERNEL_INLINE
+Elm norm1_unit(int n, Elm const* x, std::false_type){
+	return norm1_scalar(n, x, 1);
+}
+
+template<int Bytes, class Elm>
+LIB_MATH_KERNEL_INLINE
+Elm norm1_unit(int n, Elm const* x, std::true_type){
+	typedef simd<Elm, Bytes> S;
+	typedef typename S::type V;
+	int const L= S::lanes;
+	V const zero= V{};
+	V acc0= V{}, acc1= V{}, acc2= V{}, acc3= V{};
+	V a0, a1, a2, a3;
+	int i= 0;
+
+	for(; i + 4 * L <= n; i+= 4 * L){
+		S::load(a0, x + i);
+		S::load(a1, x + i + L);
+		S::load(a2, x + i + 2 * L);
+		S::load(a3, x + i + 3 * L);
+		acc0+= (a0 < zero) ? -a0 : a0;
+		acc1+= (a1 < zero) ? -a1 : a1;
+		acc2+= (a2 < zero) ? -a2 : a2;
+		acc3+= (a3 < zero) ? -a3 : a3;
+	}
+
+	Elm r= S::sum((acc0 + acc1) + (acc2 + acc3));
+
+	for(; i < n; ++i)
+		r+= abs(x[i]);
+
+	return r;
+}
+
+template<class Elm>
+LIB_MATH_KERNEL_INLINE
+Elm norm_inf_scalar(int n, Elm const* x, int incx){
+	Elm r= Elm();
+
+	for(int i= 0; i < n; ++i){
+		Elm const a= abs(x[i * incx]);
+		r= (a > r) ? a : r;
+	}
+
+	return r;
+}
+
+template<int Bytes, class Elm>
+LIB_MATH_KERNEL_INLINE
+Elm norm_inf_unit(int n, Elm const* x, std::false_type){
+	return norm_inf_scalar(n, x, 1);
+}
+
+template<int Bytes, class Elm>
+LIB_MATH_KERNEL_INLINE
+Elm norm_inf_unit(int n, Elm const* x, std::true_type){
+	typedef simd<Elm, Bytes> S;
+	typedef typename S::type V;
+	int const L= S::lanes;
+	V const zero= V{};
+	V acc0= V{}, acc1= V{};
+	V a0, a1;
+	int i= 0;
+
+	for(; i + 2 * L <= n; i+= 2 * L){
+		S::load(a0, x + i);
+		S::load(a1, x + i + L);
+		a0= (a0 < zero) ? -a0 : a0;
+		a1= (a1 < zero) ? -a1 : a1;
+		acc0= (a0 > acc0) ? a0 : acc0;
+		acc1= (a1 > acc1) ? a1 : acc1;
+	}
+	acc0= (acc1 > acc0) ? acc1 : acc0;
+
+	Elm r= S::max(acc0);
+
+	for(; i < n; ++i){
+		Elm const a= abs(x[i]);
+		r= (a > r) ? a : r;
+	}
+
+	return r;
+}
+
+template<class Elm>
+struct dot_op{
+	typedef Elm result_type;
+
+	int n;
+	Elm const* x;
+	Elm const* y;
+
+	template<isa Isa>
+	LIB_MATH_KERNEL_INLINE
+	Elm apply() const{
+		int const bytes= isa_traits<Isa>::simd_bytes;
+		return dot_unit<bytes>(n, x, y, typename simd<Elm, bytes>::enabled());
+	}
+};
+
+template<class Elm>
+struct axpy_op{
+	typedef void result_type;
+
+	int n;
+	Elm alpha;
+	Elm const* x;
+	Elm* y;
+
+	template<isa Isa>
+	LIB_MATH_KERNEL_INLINE
+	void apply() const{
+		int const bytes= isa_traits<Isa>::simd_bytes;
+		axpy_unit<bytes>(n, alpha, x, y, typename simd<Elm, bytes>::enabled());
+	}
+};
+
+template<class Elm>
+struct scale_op{
+	typedef void result_type;
+
+	int n;
+	Elm alpha;
+	Elm* x;
+
+	template<isa Isa>
+	LIB_MATH_KERNEL_INLINE
+	void apply() const{
+		int const bytes= isa_traits<Isa>::simd_bytes;
+		scale_unit<bytes>(n, alpha, x, typename simd<Elm, bytes>::enabled());
+	}
+};
+
+template<class Elm>
+struct multiply_op{
+	typedef void result_type;
+
+	int n;
+	Elm const* x;
+	Elm const* y;
+	Elm* z;
+
+	template<isa Isa>
+	LIB_MATH_KERNEL_INLINE
+	void apply() const{
+		int const bytes= isa_traits<Isa>::simd_bytes;
+		multiply_unit<bytes>(n, x, y, z, typename simd<Elm, bytes>::enabled());
+	}
+};
+
+template<class Elm>
+struct norm1_op{
+	typedef Elm result_type;
+
+	int n;
+	Elm const* x;
+
+	template<isa Isa>
+	LIB_MATH_KERNEL_INLINE
+	Elm apply() const{
+		int const bytes= isa_traits<Isa>::simd_bytes;
+		return norm1_unit<bytes>(n, x, typename simd<Elm, bytes>::enabled());
+	}
+};
+
+template<class Elm>
+struct norm_inf_op{
+	typedef Elm result_type;
+
+	int n;
+	Elm const* x;
+
+	template<isa Isa>
+	LIB_MATH_KERNEL_INLINE
+	Elm apply() const{
+		int const bytes= isa_traits<Isa>::simd_bytes;
+		return norm_inf_unit<bytes>(n, x, typename simd<Elm, bytes>::enabled());
+	}
+};
+
+}
+
+/**
+ * 内積 sum(x[i]*y[i]) を計算する。<br>
+ * 連続した配列(incx == incy == 1)はSIMDレジスタ4本分の累積値で計算する。<br>
+ * 累積の順序が逐次加算とは異なるため、浮動小数点数では丸め誤差が変わり得る。<br>
+ *
+ * @param n    要素数
+ * @param x    ベクトルx
+ * @param incx xの要素間隔
+ * @param y    ベクトルy
+ * @param incy yの要素間隔
+ * @return
+ *     xとyの内積
+ */
+template<class Elm>
+inline
+Elm dot(int n, Elm const* x, int incx, Elm const* y, int incy){
+	if(n < detail::level1_inline_threshold || incx != 1 || incy != 1)
+		return detail::dot_scalar(n, x, incx, y, incy);
+
+	detail::dot_op<Elm> const op= {n, x, y};
+	return dispatch(op);
+}
+
+/**
+ * y+= alpha*x を計算する。<br>
+ *
+ * @param n     要素数
+ * @param alpha 係数
+ * @param x     ベクトルx
+ * @param incx  xの要素間隔
+ * @param y     ベクトルy
+ * @param incy  yの要素間隔
+ */
+template<class Elm>
+inline
+void axpy(int n, Elm alpha, Elm const* x, int incx, Elm* y, int incy){
+	if(n < detail::level1_inline_threshold || incx != 1 || incy != 1){
+		detail::axpy_scalar(n, alpha, x, incx, y, incy);
+		return;
+	}
+
+	detail::axpy_op<Elm> const op= {n, alpha, x, y};
+	dispatch(op);
+}
+
+/**
+ * x*= alpha を計算する。<br>
+ *
+ * @param n     要素数
+ * @param alpha 係数
+ * @param x     ベクトルx
+ * @param incx  xの要素間隔
+ */
+template<class Elm>
+inline
+void scale(int n, Elm alpha, Elm* x, int incx){
+	if(n < detail::level1_inline_threshold || incx != 1){
+		detail::scale_scalar(n, alpha, x, incx);
+		return;
+	}
+
+	detail::scale_op<Elm> const op= {n, alpha, x};
+	dispatch(op);
+}
+
+/**
+ * 要素ごとの積 z[i]= x[i]*y[i] を計算する。zはxまたはyと同じ領域でもよい。<br>
+ *
+ * @param n    要素数
+ * @param x    ベクトルx
+ * @param incx xの要素間隔
+ * @param y    ベクトルy
+ * @param incy yの要素間隔
+ * @param z    結果の格納先
+ * @param incz zの要素間隔
+ */
+template<class Elm>
+inline
+void multiply(int n, Elm const* x, int incx, Elm const* y, int incy, Elm* z, int incz){
+	if(n < detail::level1_inline_threshold || incx != 1 || incy != 1 || incz != 1){
+		detail::multiply_scalar(n, x, incx, y, incy, z, incz);
+		return;
+	}
+
+	detail::multiply_op<Elm> const op= {n, x, y, z};
+	dispatch(op);
+}
+
+/**
+ * L1ノルム sum(|x[i]|) を計算する。<br>
+ *
+ * @param n    要素数
+ * @param x    ベクトルx
+ * @param incx xの要素間隔
+ * @return
+ *     xのL1ノルム
+ */
+template<class Elm>
+inline
+Elm norm1(int n, Elm const* x, int incx){
+	if(n < detail::level1_inline_threshold || incx != 1)
+		return detail::norm1_scalar(n, x, incx);
+
+	detail::norm1_op<Elm> const op= {n, x};
+	return dispatch(op);
+}
+
+/**
+ * L2ノルム sqrt(sum(x[i]^2)) を計算する。<br>
+ * 二乗和を直接計算するため、要素の絶対値が型の最大値の平方根を超えると
+ * オーバーフローする。<br>
+ *
+ * @param n    要素数
+ * @param x    ベクトルx
+ * @param incx xの要素間隔
+ * @return
+ *     xのL2ノルム
+ */
+template<class Elm>
+inline
+Elm norm2(int n, Elm const* x, int incx){
+	using std::sqrt;
+
+	return static_cast<Elm>(sqrt(dot(n, x, incx, x, incx)));
+}
+
+/**
+ * 最大値ノルム max(|x[i]|) を計算する。<br>
+ *
+ * @param n    要素数
+ * @param x    ベクトルx
+ * @param incx xの要素間隔
+ * @return
+ *     xの最大値ノルム。n == 0なら0
+ */
+template<class Elm>
+inline
+Elm norm_inf(int n, Elm const* x, int incx){
+	if(n < detail::level1_inline_threshold || incx != 1)
+		return detail::norm_inf_scalar(n, x, incx);
+
+	detail::norm_inf_op<Elm> const op= {n, x};
+	return dispatch(op);
+}
+
+}
+}
+}
+
+#endif // #ifndef LIB_MATH_KERNEL_LEVEL1_HPP_
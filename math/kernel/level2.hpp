@@ -0,0 +1,356 @@
+#ifndef LIB_MATH_KERNEL_LEVEL2_HPP_
+#define LIB_MATH_KERNEL_LEVEL2_HPP_
+
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+#include "config.hpp"
+#include "simd.hpp"
+#include "level1.hpp"
+#include "../../memory/aligned_allocator.hpp"
+
+namespace lib{
+namespace math{
+namespace kernel{
+
+namespace detail{
+
+/**
+ * 要素数(m*n)がこれより少ない場合はディスパッチせずにその場で計算する。<br>
+ */
+static int const level2_inline_threshold= 1024;
+
+/**
+ * y= beta*y。beta == 0の場合はyの値を読まずに0にする。<br>
+ */
+template<class Elm>
+LIB_MATH_KERNEL_INLINE
+void scale_or_zero(int n, Elm beta, Elm* y, int incy){
+	if(beta == Elm()){
+		for(int i= 0; i < n; ++i)
+			y[i * incy]= Elm();
+	}
+	else if(!(beta == Elm(1))){
+		scale(n, beta, y, incy);
+	}
+}
+
+template<int Bytes, class Elm>
+LIB_MATH_KERNEL_INLINE
+void gemv_rows(int m, int n, Elm alpha, Elm const* a, int lda, Elm const* x, Elm beta, Elm* y, int incy, std::false_type){
+	for(int i= 0; i < m; ++i){
+		Elm const s= alpha * dot_scalar(n, a + static_cast<std::size_t>(i) * lda, 1, x, 1);
+
+		y[i * incy]= (beta == Elm()) ? s : s + beta * y[i * incy];
+	}
+}
+
+/**
+ * 4行ずつ、xの読み込みを共有しながら内積を計算する。<br>
+ */
+template<int Bytes, class Elm>
+LIB_MATH_KERNEL_INLINE
+void gemv_rows(int m, int n, Elm alpha, Elm const* a, int lda, Elm const* x, Elm beta, Elm* y, int incy, std::true_type){
+	typedef simd<Elm, Bytes> S;
+	typedef typename S::type V;
+	int const L= S::lanes;
+	int i= 0;
+
+	for(; i + 4 <= m; i+= 4){
+		Elm const* const r0= a + static_cast<std::size_t>(i) * lda;
+		Elm const* const r1= r0 + lda;
+		Elm const* const r2= r1 + lda;
+		Elm const* const r3= r2 + lda;
+		V acc0= V{}, acc1= V{}, acc2= V{}, acc3= V{};
+		V xv, t0, t1, t2, t3;
+		int j= 0;
+
+		for(; j + L <= n; j+= L){
+			S::load(xv, x + j);
+			S::load(t0, r0 + j);
+			S::load(t1, r1 + j);
+			S::load(t2, r2 + j);
+			S::load(t3, r3 + j);
+			acc0+= t0 * xv;
+			acc1+= t1 * xv;
+			acc2+= t2 * xv;
+			acc3+= t3 * xv;
+		}
+
+		Elm s[4]= {S::sum(acc0), S::sum(acc1), S::sum(acc2), S::sum(acc3)};
+
+		for(; j < n; ++j){
+			s[0]+= r0[j] * x[j];
+			s[1]+= r1[j] * x[j];
+			s[2]+= r2[j] * x[j];
+			s[3]+= r3[j] * x[j];
+		}
+		for(int k= 0; k < 4; ++k){
+			Elm& yk= y[(i + k) * incy];
+
+			yk= (beta == Elm()) ? alpha * s[k] : alpha * s[k] + beta * yk;
+		}
+	}
+	for(; i < m; ++i){
+		Elm const s= alpha * dot_unit<Bytes>(n, a + static_cast<std::size_t>(i) * lda, x, std::true_type());
+
+		y[i * incy]= (beta == Elm()) ? s : s + beta * y[i * incy];
+	}
+}
+
+template<int Bytes, class Elm>
+LIB_MATH_KERNEL_INLINE
+void gemv_t_rows(int m, int n, Elm alpha, Elm const* a, int lda, Elm const* x, Elm* y, std::false_type){
+	for(int i= 0; i < m; ++i)
+		axpy_scalar(n, alpha * x[i], a + static_cast<std::size_t>(i) * lda, 1, y, 1);
+}
+
+/**
+ * 4行ずつ、yの読み書きを共有しながら y+= alpha*x[i]*A[i] を計算する。<br>
+ */
+template<int Bytes, class Elm>
+LIB_MATH_KERNEL_INLINE
+void gemv_t_rows(int m, int n, Elm alpha, Elm const* a, int lda, Elm const* x, Elm* y, std::true_type){
+	typedef simd<Elm, Bytes> S;
+	typedef typename S::type V;
+	int const L= S::lanes;
+	int i= 0;
+
+	for(; i + 4 <= m; i+= 4){
+		Elm const* const r0= a + static_cast<std::size_t>(i) * lda;
+		Elm const* const r1= r0 + lda;
+		Elm const* const r2= r1 + lda;
+		Elm const* const r3= r2 + lda;
+		Elm const c0= alpha * x[i], c1= alpha * x[i + 1], c2= alpha * x[i + 2], c3= alpha * x[i + 3];
+		V const v0= V{} + c0, v1= V{} + c1, v2= V{} + c2, v3= V{} + c3;
+		V yv, t0, t1, t2, t3;
+		int j= 0;
+
+		for(; j + L <= n; j+= L){
+			S::load(yv, y + j);
+			S::load(t0, r0 + j);
+			S::load(t1, r1 + j);
+			S::load(t2, r2 + j);
+			S::load(t3, r3 + j);
+			yv+= (v0 * t0 + v1 * t1) + (v2 * t2 + v3 * t3);
+			S::store(y + j, yv);
+		}
+		for(; j < n; ++j)
+			y[j]+= (c0 * r0[j] + c1 * r1[j]) + (c2 * r2[j] + c3 * r3[j]);
+	}
+	for(; i < m; ++i)
+		axpy_unit<Bytes>(n, alpha * x[i], a + static_cast<std::size_t>(i) * lda, y, std::true_type());
+}
+
+template<int Bytes, class Elm, class Enabled>
+LIB_MATH_KERNEL_INLINE
+void ger_rows(int m, int n, Elm alpha, Elm const* x, Elm const* y, Elm* a, int lda, Enabled enabled){
+	for(int i= 0; i < m; ++i)
+		axpy_unit<Bytes>(n, alpha * x[i], y, a + static_cast<std::size_t>(i) * lda, enabled);
+}
+
+template<class Elm>
+struct gemv_op{
+	typedef void result_type;
+
+	int m, n;
+	Elm alpha;
+	Elm const* a;
+	int lda;
+	Elm const* x;
+	Elm beta;
+	Elm* y;
+	int incy;
+
+	template<isa Isa>
+	LIB_MATH_KERNEL_INLINE
+	void apply() const{
+		int const bytes= isa_traits<Isa>::simd_bytes;
+		gemv_rows<bytes>(m, n, alpha, a, lda, x, beta, y, incy, typename simd<Elm, bytes>::enabled());
+	}
+};
+
+template<class Elm>
+struct gemv_t_op{
+	typedef void result_type;
+
+	int m, n;
+	Elm alpha;
+	Elm const* a;
+	int lda;
+	Elm const* x;
+	Elm* y;
+
+	template<isa Isa>
+	LIB_MATH_KERNEL_INLINE
+	void apply() const{
+		int const bytes= isa_traits<Isa>::simd_bytes;
+		gemv_t_rows<bytes>(m, n, alpha, a, lda, x, y, typename simd<Elm, bytes>::enabled());
+	}
+};
+
+template<class Elm>
+struct ger_op{
+	typedef void result_type;
+
+	int m, n;
+	Elm alpha;
+	Elm const* x;
+	Elm const* y;
+	Elm* a;
+	int lda;
+
+	template<isa Isa>
+	LIB_MATH_KERNEL_INLINE
+	void apply() const{
+		int const bytes= isa_traits<Isa>::simd_bytes;
+		ger_rows<bytes>(m, n, alpha, x, y, a, lda, typename simd<Elm, bytes>::enabled());
+	}
+};
+
+/**
+ * 間隔incで並んだn個の要素を連続領域に詰める。inc == 1ならそのまま返す。<br>
+ */
+template<class Elm>
+inline
+Elm const* contiguous(int n, Elm const* x, int inc, std::vector<Elm, memory::aligned_allocator<Elm>>& buf){
+	if(inc == 1)
+		return x;
+
+	buf.resize(n);
+	for(int i= 0; i < n; ++i)
+		buf[i]= x[i * inc];
+
+	return buf.data();
+}
+
+}
+
+/**
+ * 行優先の行列とベクトルの積 y= alpha*A*x + beta*y を計算する。<br>
+ * Aは1回だけ先頭から走査し、4行ずつxの読み込みを共有する。<br>
+ * beta == 0の場合、yの元の値は参照しない。<br>
+ *
+ * @param m     Aの行数(yの次元)
+ * @param n     Aの列数(xの次元)
+ * @param alpha A*xに掛ける係数
+ * @param a     A
+ * @param lda   Aの行間隔
+ * @param x     ベクトルx
+ * @param incx  xの要素間隔
+ * @param beta  yに掛ける係数
+ * @param y     ベクトルy
+ * @param incy  yの要素間隔
+ */
+template<class Elm>
+inline
+void gemv(int m, int n, Elm alpha, Elm const* a, int lda, Elm const* x, int incx, Elm beta, Elm* y, int incy){
+	if(m <= 0)
+		return;
+	if(n <= 0 || alpha == Elm()){
+		detail::scale_or_zero(m, beta, y, incy);
+		return;
+	}
+
+	std::vector<Elm, memory::aligned_allocator<Elm>> xbuf;
+	Elm const* const xp= detail::contiguous(n, x, incx, xbuf);
+
+	if(static_cast<long long>(m) * n < detail::level2_inline_threshold){
+		detail::gemv_rows<16>(m, n, alpha, a, lda, xp, beta, y, incy, std::false_type());
+		return;
+	}
+
+	detail::gemv_op<Elm> const op= {m, n, alpha, a, lda, xp, beta, y, incy};
+	dispatch(op);
+}
+
+/**
+ * 行優先の行列の転置とベクトルの積 y= alpha*A^T*x + beta*y を計算する。<br>
+ * Aは1回だけ先頭から走査し、4行分をまとめてyへ加える。<br>
+ * beta == 0の場合、yの元の値は参照しない。<br>
+ *
+ * @param m     Aの行数(xの次元)
+ * @param n     Aの列数(yの次元)
+ * @param alpha A^T*xに掛ける係数
+ * @param a     A
+ * @param lda   Aの行間隔
+ * @param x     ベクトルx
+ * @param incx  xの要素間隔
+ * @param beta  yに掛ける係数
+ * @param y     ベクトルy
+ * @param incy  yの要素間隔
+ */
+template<class Elm>
+inline
+void gemv_t(int m, int n, Elm alpha, Elm const* a, int lda, Elm const* x, int incx, Elm beta, Elm* y, int incy){
+	if(n <= 0)
+		return;
+
+	detail::scale_or_zero(n, beta, y, incy);
+
+	if(m <= 0 || alpha == Elm())
+		return;
+
+	std::vector<Elm, memory::aligned_allocator<Elm>> xbuf, ybuf;
+	Elm const* const xp= detail::contiguous(m, x, incx, xbuf);
+	Elm* yp= y;
+
+	if(incy != 1){
+		ybuf.assign(n, Elm());
+		yp= ybuf.data();
+	}
+
+	if(static_cast<long long>(m) * n < detail::level2_inline_threshold){
+		detail::gemv_t_rows<16>(m, n, alpha, a, lda, xp, yp, std::false_type());
+	}
+	else{
+		detail::gemv_t_op<Elm> const op= {m, n, alpha, a, lda, xp, yp};
+		dispatch(op);
+	}
+
+	if(incy != 1){
+		for(int j= 0; j < n; ++j)
+			y[j * incy]+= ybuf[j];
+	}
+}
+
+/**
+ * 階数1の更新 A+= alpha*x*y^T を計算する。<br>
+ *
+ * @param m     Aの行数(xの次元)
+ * @param n     Aの列数(yの次元)
+ * @param alpha 係数
+ * @param x     ベクトルx
+ * @param incx  xの要素間隔
+ * @param y     ベクトルy
+ * @param incy  yの要素間隔
+ * @param a     A
+ * @param lda   Aの行間隔
+ */
+template<class Elm>
+inline
+void ger(int m, int n, Elm alpha, Elm const* x, int incx, Elm const* y, int incy, Elm* a, int lda){
+	if(m <= 0 || n <= 0 || alpha == Elm())
+		return;
+
+	std::vector<Elm, memory::aligned_allocator<Elm>> ybuf;
+	Elm const* const yp= detail::contiguous(n, y, incy, ybuf);
+
+	if(static_cast<long long>(m) * n < detail::level2_inline_threshold){
+		for(int i= 0; i < m; ++i)
+			detail::axpy_scalar(n, alpha * x[i * incx], yp, 1, a + static_cast<std::size_t>(i) * lda, 1);
+		return;
+	}
+
+	std::vector<Elm, memory::aligned_allocator<Elm>> xbuf;
+	Elm const* const xp= detail::contiguous(m, x, incx, xbuf);
+	detail::ger_op<Elm> const op= {m, n, alpha, xp, yp, a, lda};
+
+	dispatch(op);
+}
+
+}
+}
+}
+
+#endif // #ifndef LIB_MATH_KERNEL_LEVEL2_HPP_
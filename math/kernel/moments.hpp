@@ -0,0 +1,274 @@
+#ifndef LIB_MATH_KERNEL_MOMENTS_HPP_
+#define LIB_MATH_KERNEL_MOMENTS_HPP_
+
+#include <type_traits>
+#include "config.hpp"
+#include "simd.hpp"
+
+namespace lib{
+namespace math{
+namespace kernel{
+
+/**
+ * moments()の結果。n個の値の和、平均、偏差平方和(平均まわりの2次モーメントのn倍)。<br>
+ */
+struct moments_result{
+	double count;
+	double sum;
+	double mean;
+	double m2;
+};
+
+namespace detail{
+
+/**
+ * 1ブロックの要素数。ブロック内の2回目の走査がL1キャッシュに収まる大きさにする。<br>
+ */
+static int const moments_block= 2048;
+
+/**
+ * 2つの集計結果を合わせる(Chanらの方法)。和はNeumaierの補償加算で足し、
+ * 落ちた下位の桁をcompに溜める。<br>
+ */
+LIB_MATH_KERNEL_INLINE
+void moments_merge(moments_result& r, double& comp, double count, double sum, double mean, double m2){
+	double const n= r.count + count;
+	double const delta= mean - r.mean;
+	double const t= r.sum + sum;
+
+	comp+= (((r.sum < 0.) ? -r.sum : r.sum) >= ((sum < 0.) ? -sum : sum)) ? (r.sum - t) + sum : (sum - t) + r.sum;
+	r.sum= t;
+	r.m2+= m2 + delta * delta * (r.count * count / n);
+	r.mean+= delta * (count / n);
+	r.count= n;
+}
+
+template<class Elm>
+LIB_MATH_KERNEL_INLINE
+void moments_block_scalar(int n, Elm const* x, int incx, double& sum, double& m2){
+	double s0= 0., s1= 0.;
+	int i= 0;
+
+	for(; i + 2 <= n; i+= 2){
+		s0+= static_cast<double>(x[(i + 0) * incx]);
+		s1+= static_cast<double>(x[(i + 1) * incx]);
+	}
+	for(; i < n; ++i)
+		s0+= static_cast<double>(x[i * incx]);
+	sum= s0 + s1;
+
+	double const mean= sum / n;
+	double d0= 0., d1= 0.;
+
+	for(i= 0; i + 2 <= n; i+= 2){
+		double const a= static_cast<double>(x[(i + 0) * incx]) - mean;
+		double const b= static_cast<double>(x[(i + 1) * incx]) - mean;
+
+		d0+= a * a;
+		d1+= b * b;
+	}
+	for(; i < n; ++i){
+		double const a= static_cast<double>(x[i * incx]) - mean;
+
+		d0+= a * a;
+	}
+	m2= d0 + d1;
+}
+
+/**
+ * Elmの値をdoubleのSIMDレジスタ1本分ずつ読み込む。<br>
+ * Elmがdouble以外の場合は、同じ個数のElmを読み込んでから変換する。<br>
+ */
+template<class Elm, int Bytes, class Enable= void>
+struct widen{
+	typedef std::false_type enabled;
+};
+
+#ifdef __GNUC__
+template<class Elm, int Bytes>
+struct widen<Elm, Bytes, typename std::enable_if<
+	sizeof(Elm) <= sizeof(double) && simd<double, Bytes>::enabled::value &&
+	simd<Elm, Bytes / (sizeof(double) / sizeof(Elm))>::enabled::value>::type>{
+	typedef std::true_type enabled;
+	typedef simd<double, Bytes> D;
+	typedef simd<Elm, Bytes / (sizeof(double) / sizeof(Elm))> S;
+	typedef typename D::type type;
+
+	static int const lanes= D::lanes;
+
+	LIB_MATH_KERNEL_INLINE
+	static void load(type& v, Elm const* p){
+		load(v, p, std::is_same<Elm, double>());
+	}
+
+	LIB_MATH_KERNEL_INLINE
+	static void load(type& v, Elm const* p, std::true_type){
+		D::load(v, reinterpret_cast<double const*>(p));
+	}
+
+	LIB_MATH_KERNEL_INLINE
+	static void load(type& v, Elm const* p, std::false_type){
+		typename S::type s;
+
+		S::load(s, p);
+		v= __builtin_convertvector(s, type);
+	}
+};
+#endif
+
+template<int Bytes, class Elm>
+LIB_MATH_KERNEL_INLINE
+void moments_block_unit(int n, Elm const* x, double& sum, double& m2, std::false_type){
+	moments_block_scalar(n, x, 1, sum, m2);
+}
+
+template<int Bytes, class Elm>
+LIB_MATH_KERNEL_INLINE
+void moments_block_unit(int n, Elm const* x, double& sum, double& m2, std::true_type){
+	typedef widen<Elm, Bytes> W;
+	typedef typename W::type V;
+	int const L= W::lanes;
+	V acc0= V{}, acc1= V{}, acc2= V{}, acc3= V{};
+	V a0, a1, a2, a3;
+	int i= 0;
+
+	for(; i + 4 * L <= n; i+= 4 * L){
+		W::load(a0, x + i);
+		W::load(a1, x + i + L);
+		W::load(a2, x + i + 2 * L);
+		W::load(a3, x + i + 3 * L);
+		acc0+= a0;
+		acc1+= a1;
+		acc2+= a2;
+		acc3+= a3;
+	}
+	for(; i + L <= n; i+= L){
+		W::load(a0, x + i);
+		acc0+= a0;
+	}
+
+	double s= simd<double, Bytes>::sum((acc0 + acc1) + (acc2 + acc3));
+
+	for(; i < n; ++i)
+		s+= static_cast<double>(x[i]);
+	sum= s;
+
+	double const mean= s / n;
+	V const m= V{} + mean;
+
+	acc0= acc1= acc2= acc3= V{};
+	for(i= 0; i + 4 * L <= n; i+= 4 * L){
+		W::load(a0, x + i);
+		W::load(a1, x + i + L);
+		W::load(a2, x + i + 2 * L);
+		W::load(a3, x + i + 3 * L);
+		a0-= m;
+		a1-= m;
+		a2-= m;
+		a3-= m;
+		acc0+= a0 * a0;
+		acc1+= a1 * a1;
+		acc2+= a2 * a2;
+		acc3+= a3 * a3;
+	}
+	for(; i + L <= n; i+= L){
+		W::load(a0, x + i);
+		a0-= m;
+		acc0+= a0 * a0;
+	}
+
+	double d= simd<double, Bytes>::sum((acc0 + acc1) + (acc2 + acc3));
+
+	for(; i < n; ++i){
+		double const a= static_cast<double>(x[i]) - mean;
+
+		d+= a * a;
+	}
+	m2= d;
+}
+
+template<class Elm>
+struct moments_op{
+	typedef moments_result result_type;
+
+	int n;
+	Elm const* x;
+	int incx;
+
+	template<isa Isa>
+	LIB_MATH_KERNEL_INLINE
+	moments_result apply() const{
+		int const bytes= isa_traits<Isa>::simd_bytes;
+		moments_result r= {0., 0., 0., 0.};
+		double comp= 0.;
+
+		for(int i= 0; i < n; i+= moments_block){
+			int const b= (n - i < moments_block) ? n - i : moments_block;
+			double sum, m2;
+
+			if(incx == 1)
+				moments_block_unit<bytes>(b, x + i, sum, m2, typename widen<Elm, bytes>::enabled());
+			else
+				moments_block_scalar(b, x + static_cast<long>(i) * incx, incx, sum, m2);
+			moments_merge(r, comp, b, sum, sum / b, m2);
+		}
+		r.sum+= comp;
+
+		return r;
+	}
+};
+
+}
+
+/**
+ * 和、平均、偏差平方和を1回の走査で計算する。<br>
+ * 要素はdoubleに変換して計算し、ブロックごとに(キャッシュ上で)平均と偏差平方和を求めてから
+ * Chanらの方法で合わせるので、sum(x^2) - n*mean^2のような桁落ちがない。
+ * ブロックの和はNeumaierの補償加算で足すため、要素数が10^9程度でも和の誤差はほぼ1ulpに収まる。<br>
+ * 分割して計算した結果はmerge_moments()で合わせられる。<br>
+ *
+ * @param n    要素数
+ * @param x    ベクトルx
+ * @param incx xの要素間隔
+ * @return
+ *     個数、和、平均、偏差平方和。n == 0ならすべて0
+ */
+template<class Elm>
+inline
+moments_result moments(int n, Elm const* x, int incx){
+	detail::moments_op<Elm> const op= {n, x, incx};
+
+	if(n < detail::moments_block || incx != 1)
+		return op.template apply<isa_generic>();
+
+	return dispatch(op);
+}
+
+/**
+ * 別々に計算したmoments()の結果を合わせる。<br>
+ *
+ * @param l 前半の結果
+ * @param r 後半の結果
+ * @return
+ *     両方の要素をまとめてmoments()に渡した場合と(丸め誤差を除き)同じ結果
+ */
+inline
+moments_result merge_moments(moments_result l, moments_result const& r){
+	if(r.count == 0.)
+		return l;
+	if(l.count == 0.)
+		return r;
+
+	double comp= 0.;
+
+	detail::moments_merge(l, comp, r.count, r.sum, r.mean, r.m2);
+	l.sum+= comp;
+
+	return l;
+}
+
+}
+}
+}
+
+#endif // #ifndef LIB_MATH_KERNEL_MOMENTS_HPP_
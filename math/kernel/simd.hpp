@@ -0,0 +1,77 @@
+#ifndef LIB_MATH_KERNEL_SIMD_HPP_
+#define LIB_MATH_KERNEL_SIMD_HPP_
+
+#include <type_traits>
+#include "config.hpp"
+
+namespace lib{
+namespace math{
+namespace kernel{
+
+/**
+ * Bytesバイト幅のSIMDレジスタにElmを詰めた型。<br>
+ * GCC/Clangのベクトル拡張が使え、Elmが浮動小数点型か1,2,4,8バイトの整数型の
+ * 場合のみenabledがtrueになる。それ以外の型のカーネルはスカラーで計算する。<br>
+ * target属性のない関数がベクトル型を値で返すとABIの警告が出るため、
+ * 読み込みは出力引数で受け取る。<br>
+ *
+ * @param <Elm>   要素の型
+ * @param <Bytes> レジスタ幅
+ */
+template<class Elm, int Bytes, class Enable= void>
+struct simd{
+	typedef std::false_type enabled;
+};
+
+#ifdef __GNUC__
+template<class Elm, int Bytes>
+struct simd<Elm, Bytes, typename std::enable_if<
+	std::is_same<Elm, float>::value || std::is_same<Elm, double>::value ||
+	(std::is_integral<Elm>::value && !std::is_same<Elm, bool>::value && (Bytes % sizeof(Elm)) == 0)>::type>{
+	typedef std::true_type enabled;
+	typedef Elm type __attribute__((vector_size(Bytes)));
+
+	static int const lanes= Bytes / sizeof(Elm);
+
+	LIB_MATH_KERNEL_INLINE
+	static void load(type& v, Elm const* p){
+		__builtin_memcpy(&v, p, sizeof(v));
+	}
+
+	LIB_MATH_KERNEL_INLINE
+	static void store(Elm* p, type const& v){
+		__builtin_memcpy(p, &v, sizeof(v));
+	}
+
+	LIB_MATH_KERNEL_INLINE
+	static Elm sum(type const& v){
+		Elm buf[lanes];
+		Elm r= Elm();
+
+		__builtin_memcpy(buf, &v, sizeof(v));
+		for(int i= 0; i < lanes; ++i)
+			r+= buf[i];
+
+		return r;
+	}
+
+	LIB_MATH_KERNEL_INLINE
+	static Elm max(type const& v){
+		Elm buf[lanes];
+
+		__builtin_memcpy(buf, &v, sizeof(v));
+
+		Elm r= buf[0];
+		for(int i= 1; i < lanes; ++i)
+			r= (buf[i] > r) ? buf[i] : r;
+
+		return r;
+	}
+};
+#endif
+
+}
+}
+}
+
+#endif // #ifndef LIB_MATH_KERNEL_SIMD_HPP_
@@ -0,0 +1,65 @@
+#ifndef LIB_MATH_KERNEL_TRANSPOSE_HPP_
+#define LIB_MATH_KERNEL_TRANSPOSE_HPP_
+
+#include <cstddef>
+
+namespace lib{
+namespace math{
+namespace kernel{
+
+namespace detail{
+
+/**
+ * 再帰を打ち切って直接入れ替えるブロックの要素数。<br>
+ * 読み書き両方のブロックがL1キャッシュに収まる大きさにする。<br>
+ */
+static int const transpose_leaf= 32 * 32;
+
+}
+
+/**
+ * 行優先の行列の転置 B= A^T をキャッシュ非依存の再帰分割で計算する。<br>
+ * 長い方の辺を半分に分けていき、小さくなったブロックを直接入れ替えるため、
+ * キャッシュの大きさを知らなくても読み書きの局所性が保たれる。<br>
+ * AとBは重なってはならない。<br>
+ *
+ * @param m   Aの行数(Bの列数)
+ * @param n   Aの列数(Bの行数)
+ * @param a   A
+ * @param lda Aの行間隔
+ * @param b   B
+ * @param ldb Bの行間隔
+ */
+template<class Elm>
+inline
+void transpose(int m, int n, Elm const* a, int lda, Elm* b, int ldb){
+	if(m <= 0 || n <= 0)
+		return;
+
+	if(static_cast<long long>(m) * n <= detail::transpose_leaf){
+		for(int i= 0; i < m; ++i){
+			Elm const* const ai= a + static_cast<std::size_t>(i) * lda;
+
+			for(int j= 0; j < n; ++j)
+				b[static_cast<std::size_t>(j) * ldb + i]= ai[j];
+		}
+	}
+	else if(m >= n){
+		int const h= m / 2;
+
+		transpose(h, n, a, lda, b, ldb);
+		transpose(m - h, n, a + static_cast<std::size_t>(h) * lda, lda, b + h, ldb);
+	}
+	else{
+		int const h= n / 2;
+
+		transpose(m, h, a, lda, b, ldb);
+		transpose(m, n - h, a + h, lda, b + static_cast<std::size_t>(h) * ldb, ldb);
+	}
+}
+
+}
+}
+}
+
+#endif // #ifndef LIB_MATH_KERNEL_TRANSPOSE_HPP_
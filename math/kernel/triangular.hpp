@@ -0,0 +1,169 @@
+#ifndef LIB_MATH_KERNEL_TRIANGULAR_HPP_
+#define LIB_MATH_KERNEL_TRIANGULAR_HPP_
+
+#include <algorithm>
+#include <vector>
+#include "level1.hpp"
+#include "level2.hpp"
+#include "gemm.hpp"
+#include "../../memory/aligned_allocator.hpp"
+
+namespace lib{
+namespace math{
+namespace kernel{
+
+namespace detail{
+
+/**
+ * 三角行列の求解でブロックに分ける行数。<br>
+ * 対角ブロックの外側はgemm(右辺が1列ならgemv)で更新する。<br>
+ */
+static int const trsm_block= 64;
+
+}
+
+/**
+ * 下三角行列Lについて L*X= B を解き、BをXで置き換える。<br>
+ * 行列はすべて行優先。Lの上三角部分は参照しない。<br>
+ *
+ * @param m    Lの次数(Bの行数)
+ * @param n    Bの列数
+ * @param unit trueならLの対角要素を1とみなし、参照しない
+ * @param l    L
+ * @param ldl  Lの行間隔
+ * @param b    B
+ * @param ldb  Bの行間隔(n == 1の場合は要素間隔)
+ */
+template<class Elm>
+inline
+void trsm_lower(int m, int n, bool unit, Elm const* l, int ldl, Elm* b, int ldb){
+	if(m <= 0 || n <= 0)
+		return;
+
+	for(int k0= 0; k0 < m; k0+= detail::trsm_block){
+		int const k1= std::min(k0 + detail::trsm_block, m);
+		Elm const* const lk= l + static_cast<std::size_t>(k0) * ldl;
+		Elm* const bk= b + static_cast<std::size_t>(k0) * ldb;
+
+		if(k0 > 0){
+			if(n == 1)
+				gemv(k1 - k0, k0, Elm(-1), lk, ldl, b, ldb, Elm(1), bk, ldb);
+			else
+				gemm(k1 - k0, n, k0, Elm(-1), lk, ldl, b, ldb, Elm(1), bk, ldb);
+		}
+		for(int i= k0; i < k1; ++i){
+			Elm const* const li= l + static_cast<std::size_t>(i) * ldl;
+			Elm* const bi= b + static_cast<std::size_t>(i) * ldb;
+
+			if(n == 1)
+				*bi-= dot(i - k0, li + k0, 1, bk, ldb);
+			else
+				gemv_t(i - k0, n, Elm(-1), bk, ldb, li + k0, 1, Elm(1), bi, 1);
+			if(!unit)
+				scale(n, Elm(1) / li[i], bi, 1);
+		}
+	}
+}
+
+/**
+ * 上三角行列Uについて U*X= B を解き、BをXで置き換える。<br>
+ * 行列はすべて行優先。Uの下三角部分は参照しない。<br>
+ *
+ * @param m    Uの次数(Bの行数)
+ * @param n    Bの列数
+ * @param unit trueならUの対角要素を1とみなし、参照しない
+ * @param u    U
+ * @param ldu  Uの行間隔
+ * @param b    B
+ * @param ldb  Bの行間隔(n == 1の場合は要素間隔)
+ */
+template<class Elm>
+inline
+void trsm_upper(int m, int n, bool unit, Elm const* u, int ldu, Elm* b, int ldb){
+	if(m <= 0 || n <= 0)
+		return;
+
+	for(int k1= m; k1 > 0; k1-= detail::trsm_block){
+		int const k0= std::max(k1 - detail::trsm_block, 0);
+		Elm const* const uk= u + static_cast<std::size_t>(k0) * ldu;
+		Elm* const bk= b + static_cast<std::size_t>(k0) * ldb;
+		Elm* const bn= b + static_cast<std::size_t>(k1) * ldb;
+
+		if(k1 < m){
+			if(n == 1)
+				gemv(k1 - k0, m - k1, Elm(-1), uk + k1, ldu, bn, ldb, Elm(1), bk, ldb);
+			else
+				gemm(k1 - k0, n, m - k1, Elm(-1), uk + k1, ldu, bn, ldb, Elm(1), bk, ldb);
+		}
+		for(int i= k1 - 1; i >= k0; --i){
+			Elm const* const ui= u + static_cast<std::size_t>(i) * ldu;
+			Elm* const bi= b + static_cast<std::size_t>(i) * ldb;
+
+			if(n == 1)
+				*bi-= dot(k1 - i - 1, ui + i + 1, 1, bi + ldb, ldb);
+			else
+				gemv_t(k1 - i - 1, n, Elm(-1), bi + ldb, ldb, ui + i + 1, 1, Elm(1), bi, 1);
+			if(!unit)
+				scale(n, Elm(1) / ui[i], bi, 1);
+		}
+	}
+}
+
+/**
+ * 下三角行列Lについて L^T*X= B を解き、BをXで置き換える。<br>
+ * Lの行を連続に読むため、対角ブロックの内側は列方向の更新(axpy/ger)で解き、
+ * 外側はLのブロックを転置した作業領域とのgemmで更新する。<br>
+ *
+ * @param m   Lの次数(Bの行数)
+ * @param n   Bの列数
+ * @param l   L
+ * @param ldl Lの行間隔
+ * @param b   B
+ * @param ldb Bの行間隔(n == 1の場合は要素間隔)
+ */
+template<class Elm>
+inline
+void trsm_lower_transposed(int m, int n, Elm const* l, int ldl, Elm* b, int ldb){
+	if(m <= 0 || n <= 0)
+		return;
+
+	std::vector<Elm, memory::aligned_allocator<Elm>> buf;
+
+	for(int k1= m; k1 > 0; k1-= detail::trsm_block){
+		int const k0= std::max(k1 - detail::trsm_block, 0);
+		int const kb= k1 - k0;
+		int const rest= m - k1;
+		Elm const* const ln= l + static_cast<std::size_t>(k1) * ldl + k0;
+		Elm* const bk= b + static_cast<std::size_t>(k0) * ldb;
+		Elm* const bn= b + static_cast<std::size_t>(k1) * ldb;
+
+		if(rest > 0){
+			if(n == 1){
+				gemv_t(rest, kb, Elm(-1), ln, ldl, bn, ldb, Elm(1), bk, ldb);
+			}
+			else{
+				buf.resize(static_cast<std::size_t>(kb) * rest);
+				for(int i= 0; i < rest; ++i)
+					for(int j= 0; j < kb; ++j)
+						buf[static_cast<std::size_t>(j) * rest + i]= ln[static_cast<std::size_t>(i) * ldl + j];
+				gemm(kb, n, rest, Elm(-1), buf.data(), rest, bn, ldb, Elm(1), bk, ldb);
+			}
+		}
+		for(int i= k1 - 1; i >= k0; --i){
+			Elm const* const li= l + static_cast<std::size_t>(i) * ldl;
+			Elm* const bi= b + static_cast<std::size_t>(i) * ldb;
+
+			scale(n, Elm(1) / li[i], bi, 1);
+			if(n == 1)
+				axpy(i - k0, -*bi, li + k0, 1, bk, ldb);
+			else
+				ger(i - k0, n, Elm(-1), li + k0, 1, bi, 1, bk, ldb);
+		}
+	}
+}
+
+}
+}
+}
+
+#endif // #ifndef LIB_MATH_KERNEL_TRIANGULAR_HPP_
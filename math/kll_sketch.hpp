@@ -0,0 +1,603 @@
+#ifndef LIB_MATH_KLL_SKETCH_HPP_
+#define LIB_MATH_KLL_SKETCH_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <stdint.h>
+#include "../exception/invalid_argument.hpp"
+
+namespace lib{
+namespace math{
+
+/**
+ * 分位数を近似するKLLスケッチ(Karnin, Lang, Liberty 2016)<br>
+ * 値を段ごとのコンパクタに溜め、段hの値は2^h個分の重みを持つ。
+ * 段が容量を超えると並べ替えて1つおきに残し、残した値を上の段へ送る。
+ * 上の段ほど容量を2/3倍ずつ小さくするので、保持する値の数は全体の個数によらず
+ * おおむね3k程度に収まる。<br>
+ * 誤差は正規化した順位で測り、quantile(p)の返す値の真の順位がp*nからずれる幅は、
+ * 99%の確率でおよそrank_error(k) * n以下になる(k= 200で約1.3%)。
+ * 最小値と最大値は正確に保持する。<br>
+ * 同じ種類のスケッチはmerge()で合わせることができ、合わせた結果も同じ誤差の保証を持つ。
+ * serialize()したバイト列は別のプロセスでdeserialize()して合わせられる。<br>
+ * 値の比較にはoperator <を使う。<br>
+ *
+ * @author  kamichidu
+ * @param <Elm> 値の型
+ */
+template<class Elm= double>
+class kll_sketch{
+	public:
+		explicit kll_sketch(int k= 200);
+	public:
+		void push(Elm const& x);
+		template<class InputIterator>
+			void push(InputIterator first, InputIterator last);
+		void push(Elm const* data, int n);
+		void merge(kll_sketch<Elm> const& r);
+		int k() const;
+		long long size() const;
+		bool empty() const;
+		int retained() const;
+		Elm const& min() const;
+		Elm const& max() const;
+		Elm quantile(double p) const;
+		std::vector<Elm> quantiles(std::vector<double> const& ps) const;
+		double cdf(Elm const& x) const;
+		std::vector<char> serialize() const;
+		static kll_sketch<Elm> deserialize(char const* data, std::size_t size);
+		static double rank_error(int k);
+	private:
+		typedef std::pair<Elm, long long> weighted;
+	private:
+		int capacity(int level) const;
+		void update_capacity();
+		void compress();
+		void compact(int level);
+		void update_bounds(Elm const& lo, Elm const& hi);
+		std::vector<weighted> sorted_view() const;
+		unsigned random_bit();
+	private:
+		int _k;
+		long long _n;
+		Elm _min;
+		Elm _max;
+		int _retained;
+		/** 全段の容量の合計。保持する値がこれに達したら圧縮する */
+		int _capacity;
+		std::vector<int> _capacities;
+		uint64_t _random;
+		/** _levels[0]は並べ替えておらず、1段目以降は昇順に並べておく */
+		std::vector<std::vector<Elm>> _levels;
+		std::vector<Elm> _scratch;
+};
+
+namespace detail{
+
+static char const kll_magic[4]= {'K', 'L', 'L', '\0'};
+static uint32_t const kll_version= 1;
+static uint32_t const kll_byte_order= 0x01020304;
+/** 最も上の段でも最低限確保する容量 */
+static int const kll_min_capacity= 8;
+
+/**
+ * serialize()の先頭に置くヘッダ。<br>
+ */
+struct kll_header{
+	char magic[4];
+	uint32_t version;
+	uint32_t byte_order;
+	uint32_t element_size;
+	uint32_t k;
+	uint32_t levels;
+	uint64_t n;
+};
+
+}
+
+/**
+ * 空のスケッチを作る。<br>
+ *
+ * @param k 精度。大きいほど誤差が小さく、保持する値が多くなる。8以上
+ * @throw lib::exception::invalid_argument<> kが8未満の場合
+ */
+template<class Elm>
+inline
+kll_sketch<Elm>::kll_sketch(int k) :
+	_k(k), _n(0), _min(), _max(), _retained(0), _capacity(0), _capacities(), _random(0x9e3779b97f4a7c15ull), _levels(1){
+	if(k < detail::kll_min_capacity)
+		throw lib::exception::invalid_argument<>(L"kは8以上でなければなりません。");
+	update_capacity();
+}
+
+/**
+ * 値を1つ加える。<br>
+ *
+ * @param x 値
+ */
+template<class Elm>
+inline
+void kll_sketch<Elm>::push(Elm const& x){
+	update_bounds(x, x);
+	_levels[0].push_back(x);
+	++_n;
+	++_retained;
+	if(_retained >= _capacity)
+		compress();
+}
+
+/**
+ * [first, last)の値を順に加える。<br>
+ */
+template<class Elm>
+template<class InputIterator>
+inline
+void kll_sketch<Elm>::push(InputIterator first, InputIterator last){
+	for(; first != last; ++first)
+		push(*first);
+}
+
+/**
+ * 連続したn個の値をまとめて加える。<br>
+ * 最下段の空きの分ずつまとめて書き写し、最小値と最大値もまとめて求める。
+ * 結果は1つずつpush()した場合と同じになる。<br>
+ *
+ * @param data 値の配列
+ * @param n    個数
+ */
+template<class Elm>
+inline
+void kll_sketch<Elm>::push(Elm const* data, int n){
+	while(n > 0){
+		int const m= std::min(n, std::max(1, _capacity - _retained));
+		std::pair<Elm const*, Elm const*> const mm= std::minmax_element(data, data + m);
+
+		update_bounds(*mm.first, *mm.second);
+		_levels[0].insert(_levels[0].end(), data, data + m);
+		_n+= m;
+		_retained+= m;
+		while(_retained >= _capacity)
+			compress();
+		data+= m;
+		n-= m;
+	}
+}
+
+/**
+ * 別のスケッチの内容を合わせる。<br>
+ * kが異なる場合は小さい方の精度になる。rは*thisでもよい。<br>
+ *
+ * @param r 合わせるスケッチ
+ */
+template<class Elm>
+inline
+void kll_sketch<Elm>::merge(kll_sketch<Elm> const& r){
+	if(r._n == 0)
+		return;
+	// 自身の段を自身に挿入することはできないので、写しを合わせる
+	if(&r == this){
+		kll_sketch<Elm> const copy(r);
+
+		merge(copy);
+		return;
+	}
+
+	update_bounds(r._min, r._max);
+	_k= std::min(_k, r._k);
+	if(_levels.size() < r._levels.size())
+		_levels.resize(r._levels.size());
+	update_capacity();
+	for(std::size_t h= 0; h < r._levels.size(); ++h){
+		std::vector<Elm>& level= _levels[h];
+		std::size_t const middle= level.size();
+
+		level.insert(level.end(), r._levels[h].begin(), r._levels[h].end());
+		if(h > 0)
+			std::inplace_merge(level.begin(), level.begin() + middle, level.end());
+	}
+	_n+= r._n;
+	_retained+= r._retained;
+	while(_retained >= _capacity)
+		compress();
+}
+
+template<class Elm>
+inline
+int kll_sketch<Elm>::k() const{
+	return _k;
+}
+
+/**
+ * これまでに加えた値の個数。<br>
+ */
+template<class Elm>
+inline
+long long kll_sketch<Elm>::size() const{
+	return _n;
+}
+
+template<class Elm>
+inline
+bool kll_sketch<Elm>::empty() const{
+	return _n == 0;
+}
+
+/**
+ * スケッチが保持している値の個数。<br>
+ */
+template<class Elm>
+inline
+int kll_sketch<Elm>::retained() const{
+	return _retained;
+}
+
+/**
+ * 最小値。empty()の場合は値を初期化したもの。<br>
+ */
+template<class Elm>
+inline
+Elm const& kll_sketch<Elm>::min() const{
+	return _min;
+}
+
+/**
+ * 最大値。empty()の場合は値を初期化したもの。<br>
+ */
+template<class Elm>
+inline
+Elm const& kll_sketch<Elm>::max() const{
+	return _max;
+}
+
+/**
+ * p分位数の近似値。順位がおよそp*nの値を返す。<br>
+ * quantile(0)はmin()、quantile(1)はmax()。<br>
+ *
+ * @param p 0以上1以下の割合
+ * @throw lib::exception::invalid_argument<> pが範囲外の場合
+ * @throw std::out_of_range empty()の場合
+ */
+template<class Elm>
+inline
+Elm kll_sketch<Elm>::quantile(double p) const{
+	return quantiles(std::vector<double>(1, p)).front();
+}
+
+/**
+ * 複数のp分位数の近似値をまとめて求める。<br>
+ * 保持している値を1度だけ並べ替えるので、quantile()を繰り返すより速い。<br>
+ *
+ * @param ps 0以上1以下の割合の列
+ * @return
+ *     psと同じ順の分位数
+ * @throw lib::exception::invalid_argument<> 範囲外の割合がある場合
+ * @throw std::out_of_range empty()の場合
+ */
+template<class Elm>
+inline
+std::vector<Elm> kll_sketch<Elm>::quantiles(std::vector<double> const& ps) const{
+	for(double p : ps){
+		if(!(p >= 0. && p <= 1.))
+			throw lib::exception::invalid_argument<>(L"割合は0以上1以下でなければなりません。");
+	}
+	if(_n == 0)
+		throw std::out_of_range("lib::math::kll_sketch");
+
+	std::vector<weighted> const view= sorted_view();
+	std::vector<Elm> result;
+
+	result.reserve(ps.size());
+	for(double p : ps){
+		if(p == 0.){
+			result.push_back(_min);
+			continue;
+		}
+		if(p == 1.){
+			result.push_back(_max);
+			continue;
+		}
+
+		long long const rank= static_cast<long long>(std::ceil(p * static_cast<double>(_n)));
+		typename std::vector<weighted>::const_iterator const it= std::lower_bound(view.begin(), view.end(), rank,
+			[](weighted const& w, long long r){ return w.second < r; });
+
+		result.push_back((it == view.end()) ? _max : it->first);
+	}
+
+	return result;
+}
+
+/**
+ * x以下の値の割合の近似値。<br>
+ *
+ * @param x 値
+ * @return
+ *     0以上1以下の割合。empty()の場合は0
+ */
+template<class Elm>
+inline
+double kll_sketch<Elm>::cdf(Elm const& x) const{
+	if(_n == 0)
+		return 0.;
+	if(x < _min)
+		return 0.;
+	if(!(x < _max))
+		return 1.;
+
+	long long rank= 0;
+
+	for(std::size_t h= 0; h < _levels.size(); ++h){
+		for(Elm const& v : _levels[h]){
+			if(!(x < v))
+				rank+= 1ll << h;
+		}
+	}
+
+	return static_cast<double>(rank) / static_cast<double>(_n);
+}
+
+/**
+ * 他のプロセスでdeserialize()できるバイト列に変換する。<br>
+ * 値は書き込んだ計算機のバイト順のまま保存する。<br>
+ */
+template<class Elm>
+inline
+std::vector<char> kll_sketch<Elm>::serialize() const{
+	static_assert(std::is_trivially_copyable<Elm>::value, "kll_sketch::serialize() requires a trivially copyable Elm");
+
+	detail::kll_header h;
+
+	std::memcpy(h.magic, detail::kll_magic, sizeof(h.magic));
+	h.version= detail::kll_version;
+	h.byte_order= detail::kll_byte_order;
+	h.element_size= sizeof(Elm);
+	h.k= _k;
+	h.levels= _levels.size();
+	h.n= _n;
+
+	std::vector<char> out(sizeof(h) + 2 * sizeof(Elm) + _levels.size() * sizeof(uint32_t) + _retained * sizeof(Elm));
+	char* p= out.data();
+
+	std::memcpy(p, &h, sizeof(h));
+	p+= sizeof(h);
+	std::memcpy(p, &_min, sizeof(Elm));
+	p+= sizeof(Elm);
+	std::memcpy(p, &_max, sizeof(Elm));
+	p+= sizeof(Elm);
+	for(std::vector<Elm> const& level : _levels){
+		uint32_t const size= level.size();
+
+		std::memcpy(p, &size, sizeof(size));
+		p+= sizeof(size);
+	}
+	for(std::vector<Elm> const& level : _levels){
+		if(!level.empty())
+			std::memcpy(p, level.data(), level.size() * sizeof(Elm));
+		p+= level.size() * sizeof(Elm);
+	}
+
+	return out;
+}
+
+/**
+ * serialize()したバイト列からスケッチを復元する。<br>
+ *
+ * @param data バイト列
+ * @param size バイト数
+ * @throw lib::exception::invalid_argument<> 形式が異なる場合、途中で切れている場合、値の個数が合わない場合
+ */
+template<class Elm>
+inline
+kll_sketch<Elm> kll_sketch<Elm>::deserialize(char const* data, std::size_t size){
+	static_assert(std::is_trivially_copyable<Elm>::value, "kll_sketch::deserialize() requires a trivially copyable Elm");
+
+	detail::kll_header h;
+
+	if(size < sizeof(h))
+		throw lib::exception::invalid_argument<>(L"ヘッダがありません。");
+	std::memcpy(&h, data, sizeof(h));
+	if(std::memcmp(h.magic, detail::kll_magic, sizeof(h.magic)) != 0 || h.version != detail::kll_version)
+		throw lib::exception::invalid_argument<>(L"KLLスケッチの形式ではありません。");
+	if(h.byte_order != detail::kll_byte_order)
+		throw lib::exception::invalid_argument<>(L"バイト順が異なります。");
+	if(h.element_size != sizeof(Elm))
+		throw lib::exception::invalid_argument<>(L"要素の型が異なります。");
+	if(h.levels == 0 || h.levels > 64 || size < sizeof(h) + 2 * sizeof(Elm) + h.levels * sizeof(uint32_t))
+		throw lib::exception::invalid_argument<>(L"データが途中で切れています。");
+
+	kll_sketch<Elm> s(h.k);
+	char const* p= data + sizeof(h);
+	std::size_t const remain= size - sizeof(h) - 2 * sizeof(Elm) - h.levels * sizeof(uint32_t);
+
+	std::memcpy(&s._min, p, sizeof(Elm));
+	p+= sizeof(Elm);
+	std::memcpy(&s._max, p, sizeof(Elm));
+	p+= sizeof(Elm);
+
+	// 領域を確保する前に、各段の個数がバイト列の長さと値の個数に合うことを確かめる
+	uint32_t counts[64];
+	std::size_t values= 0;
+	uint64_t total= 0;
+
+	for(uint32_t i= 0; i < h.levels; ++i){
+		uint32_t& n= counts[i];
+
+		std::memcpy(&n, p, sizeof(n));
+		p+= sizeof(n);
+		if(n > (remain / sizeof(Elm)) - values)
+			throw lib::exception::invalid_argument<>(L"データが途中で切れています。");
+		if(static_cast<uint64_t>(n) > ((UINT64_MAX - total) >> i))
+			throw lib::exception::invalid_argument<>(L"値の個数が合いません。");
+		values+= n;
+		total+= static_cast<uint64_t>(n) << i;
+	}
+	if(total != h.n)
+		throw lib::exception::invalid_argument<>(L"値の個数が合いません。");
+
+	s._levels.resize(h.levels);
+	s.update_capacity();
+	for(uint32_t i= 0; i < h.levels; ++i){
+		std::size_t const bytes= counts[i] * sizeof(Elm);
+
+		s._levels[i].resize(counts[i]);
+		if(bytes > 0)
+			std::memcpy(s._levels[i].data(), p, bytes);
+		p+= bytes;
+	}
+	s._retained= values;
+	s._n= h.n;
+
+	return s;
+}
+
+/**
+ * kに対する正規化順位誤差の目安(99%の確率での上限)。<br>
+ * Apache DataSketchesによるKLLの実測値の近似式 2.296 / k^0.9723 を使う。<br>
+ *
+ * @param k 精度
+ */
+template<class Elm>
+inline
+double kll_sketch<Elm>::rank_error(int k){
+	return 2.296 / std::pow(static_cast<double>(k), 0.9723);
+}
+
+template<class Elm>
+inline
+int kll_sketch<Elm>::capacity(int level) const{
+	return _capacities[level];
+}
+
+/**
+ * 段の容量を求め直す。最も上の段がk、そこから下へ2/3倍ずつ小さくなる。<br>
+ */
+template<class Elm>
+inline
+void kll_sketch<Elm>::update_capacity(){
+	int const levels= _levels.size();
+
+	_capacities.resize(levels);
+	_capacity= 0;
+	for(int h= 0; h < levels; ++h){
+		_capacities[h]= std::max(detail::kll_min_capacity, static_cast<int>(std::ceil(_k * std::pow(2. / 3., levels - 1 - h))));
+		_capacity+= _capacities[h];
+	}
+}
+
+/**
+ * 容量に達している最も下の段を1つ圧縮する。<br>
+ * 保持している値の数が容量の合計以上なら、そのような段は必ずある。<br>
+ */
+template<class Elm>
+inline
+void kll_sketch<Elm>::compress(){
+	int h= 0;
+
+	while(h + 1 < static_cast<int>(_levels.size()) && static_cast<int>(_levels[h].size()) < capacity(h))
+		++h;
+	compact(h);
+}
+
+/**
+ * 段levelの値を並べ替え、1つおきに上の段へ送る。<br>
+ * 奇数個の場合は最小の値を1つその段に残す。<br>
+ */
+template<class Elm>
+inline
+void kll_sketch<Elm>::compact(int level){
+	if(level + 1 == static_cast<int>(_levels.size())){
+		_levels.emplace_back();
+		update_capacity();
+	}
+
+	std::vector<Elm>& from= _levels[level];
+	std::vector<Elm>& to= _levels[level + 1];
+
+	if(level == 0)
+		std::sort(from.begin(), from.end());
+
+	std::size_t const odd= from.size() % 2;
+	std::size_t const promoted= (from.size() - odd) / 2;
+	std::size_t i= odd + random_bit(), j= 0;
+
+	// 1つおきに取り出した値と上の段を併合する。作業領域は使い回して確保を避ける
+	_scratch.clear();
+	_scratch.reserve(to.size() + promoted);
+	while(i < from.size() && j < to.size()){
+		if(from[i] < to[j]){
+			_scratch.push_back(from[i]);
+			i+= 2;
+		}
+		else
+			_scratch.push_back(to[j++]);
+	}
+	for(; i < from.size(); i+= 2)
+		_scratch.push_back(from[i]);
+	_scratch.insert(_scratch.end(), to.begin() + j, to.end());
+	to.swap(_scratch);
+	_retained-= promoted;
+	from.resize(odd);
+}
+
+template<class Elm>
+inline
+void kll_sketch<Elm>::update_bounds(Elm const& lo, Elm const& hi){
+	if(_n == 0){
+		_min= lo;
+		_max= hi;
+		return;
+	}
+	if(lo < _min)
+		_min= lo;
+	if(_max < hi)
+		_max= hi;
+}
+
+/**
+ * 保持している値を昇順に並べ、各値までの重みの累計を付けたもの。<br>
+ */
+template<class Elm>
+inline
+std::vector<typename kll_sketch<Elm>::weighted> kll_sketch<Elm>::sorted_view() const{
+	std::vector<weighted> view;
+
+	view.reserve(_retained);
+	for(std::size_t h= 0; h < _levels.size(); ++h){
+		for(Elm const& v : _levels[h])
+			view.push_back(weighted(v, 1ll << h));
+	}
+	std::sort(view.begin(), view.end(), [](weighted const& l, weighted const& r){ return l.first < r.first; });
+
+	long long cumulative= 0;
+
+	for(weighted& w : view){
+		cumulative+= w.second;
+		w.second= cumulative;
+	}
+
+	return view;
+}
+
+/**
+ * xorshift64による0か1。結果を再現できるように状態はスケッチごとに持つ。<br>
+ */
+template<class Elm>
+inline
+unsigned kll_sketch<Elm>::random_bit(){
+	_random^= _random << 13;
+	_random^= _random >> 7;
+	_random^= _random << 17;
+
+	return static_cast<unsigned>(_random >> 63);
+}
+
+}
+}
+
+#endif // #ifndef LIB_MATH_KLL_SKETCH_HPP_
@@ -0,0 +1,413 @@
+#ifndef LIB_MATH_MAPPED_HPP_
+#define LIB_MATH_MAPPED_HPP_
+
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../exception/invalid_argument.hpp"
+#include "dimension.hpp"
+#include "vector.hpp"
+#include "matrix.hpp"
+#include "view.hpp"
+
+namespace lib{
+namespace math{
+
+/**
+ * mmapで読み込むベクトル、行列のファイル形式のヘッダ<br>
+ * ファイルの先頭にこの64バイトを置き、data_offsetから要素を行優先で詰めて並べる。<br>
+ * data_offsetは64の倍数なので、マップした領域の要素はそのままカーネルに渡せる境界に揃う。<br>
+ * 要素は書き込んだ計算機のバイト順のまま保存し、byte_orderで判別する。<br>
+ *
+ * @author  kamichidu
+ */
+struct mapped_header{
+	/** "LIBMATH"と終端の0 */
+	char magic[8];
+	/** 形式の版(現在は1) */
+	uint32_t version;
+	/** 0x01020304を書き込んだ計算機のバイト順で格納したもの */
+	uint32_t byte_order;
+	/** 要素の型(mapped_element<Elm>::code) */
+	uint32_t element_type;
+	/** 要素のバイト数 */
+	uint32_t element_size;
+	/** 1ならベクトル、2なら行列 */
+	uint32_t rank;
+	uint32_t reserved0;
+	/** 行数(ベクトルの場合は要素数) */
+	uint64_t rows;
+	/** 列数(ベクトルの場合は1) */
+	uint64_t cols;
+	/** ファイル先頭から要素までのバイト数 */
+	uint64_t data_offset;
+	uint64_t reserved1;
+};
+
+static_assert(sizeof(mapped_header) == 64, "mapped_header must be 64 bytes");
+
+/**
+ * ファイル形式に保存できる要素の型と、その型番号。<br>
+ */
+template<class Elm>
+struct mapped_element;
+
+template<>
+struct mapped_element<float>{ static uint32_t const code= 1; };
+
+template<>
+struct mapped_element<double>{ static uint32_t const code= 2; };
+
+template<>
+struct mapped_element<int32_t>{ static uint32_t const code= 3; };
+
+template<>
+struct mapped_element<int64_t>{ static uint32_t const code= 4; };
+
+namespace detail{
+
+static char const mapped_magic[8]= {'L', 'I', 'B', 'M', 'A', 'T', 'H', '\0'};
+static uint32_t const mapped_version= 1;
+static uint32_t const mapped_byte_order= 0x01020304;
+
+/**
+ * 読み取り専用でmmapしたファイル全体を所有する。ムーブのみ可能。<br>
+ */
+class mapped_file{
+	public:
+		explicit mapped_file(std::string const& path) : _addr(0), _size(0){
+			int const fd= ::open(path.c_str(), O_RDONLY);
+
+			if(fd < 0)
+				throw lib::exception::invalid_argument<>(L"ファイルを開けません。");
+
+			struct stat st;
+
+			if(::fstat(fd, &st) != 0){
+				::close(fd);
+				throw lib::exception::invalid_argument<>(L"ファイルの大きさを取得できません。");
+			}
+
+			_size= static_cast<std::size_t>(st.st_size);
+			if(_size > 0){
+				void* const addr= ::mmap(0, _size, PROT_READ, MAP_SHARED, fd, 0);
+
+				if(addr == MAP_FAILED){
+					::close(fd);
+					throw lib::exception::invalid_argument<>(L"ファイルをマップできません。");
+				}
+				_addr= addr;
+			}
+			// マップした領域はファイルを閉じても有効
+			::close(fd);
+		}
+		mapped_file(mapped_file&& obj) : _addr(obj._addr), _size(obj._size){
+			obj._addr= 0;
+			obj._size= 0;
+		}
+		~mapped_file(){
+			if(_addr)
+				::munmap(_addr, _size);
+		}
+		mapped_file(mapped_file const&)= delete;
+		mapped_file& operator = (mapped_file const&)= delete;
+	public:
+		char const* data() const{ return static_cast<char const*>(_addr); }
+		std::size_t size() const{ return _size; }
+	private:
+		void* _addr;
+		std::size_t _size;
+};
+
+/**
+ * ヘッダを検証し、要素の先頭を返す。<br>
+ *
+ * @throw lib::exception::invalid_argument<> 形式が異なる場合
+ */
+template<class Elm>
+inline
+Elm const* mapped_data(mapped_file const& f, uint32_t rank, mapped_header& h){
+	if(f.size() < sizeof(mapped_header))
+		throw lib::exception::invalid_argument<>(L"ヘッダがありません。");
+
+	std::memcpy(&h, f.data(), sizeof(mapped_header));
+	if(std::memcmp(h.magic, mapped_magic, sizeof(mapped_magic)) != 0 || h.version != mapped_version)
+		throw lib::exception::invalid_argument<>(L"ファイル形式が異なります。");
+	if(h.byte_order != mapped_byte_order)
+		throw lib::exception::invalid_argument<>(L"バイト順が異なります。");
+	if(h.element_type != mapped_element<Elm>::code || h.element_size != sizeof(Elm))
+		throw lib::exception::invalid_argument<>(L"要素の型が異なります。");
+	if(h.rank != rank)
+		throw lib::exception::invalid_argument<>(L"次元数が異なります。");
+	if(h.data_offset < sizeof(mapped_header) || h.data_offset % 64 != 0 || h.rows > static_cast<uint64_t>(INT32_MAX) || h.cols > static_cast<uint64_t>(INT32_MAX))
+		throw lib::exception::invalid_argument<>(L"ヘッダが不正です。");
+
+	// ヘッダの値は信用できないので、桁あふれしないよう1段ずつ確かめる
+	uint64_t const limit= UINT64_MAX;
+
+	if(h.cols != 0 && h.rows > limit / h.cols)
+		throw lib::exception::invalid_argument<>(L"ヘッダが不正です。");
+
+	uint64_t const count= h.rows * h.cols;
+
+	if(count > limit / sizeof(Elm))
+		throw lib::exception::invalid_argument<>(L"ヘッダが不正です。");
+
+	uint64_t const bytes= count * sizeof(Elm);
+
+	if(h.data_offset > f.size() || bytes > f.size() - h.data_offset)
+		throw lib::exception::invalid_argument<>(L"ファイルが途中で切れています。");
+
+	return reinterpret_cast<Elm const*>(f.data() + h.data_offset);
+}
+
+/**
+ * ヘッダを書き込む。要素はヘッダの直後(64バイト目)から始まる。<br>
+ */
+template<class Elm>
+inline
+void write_mapped_header(std::ofstream& ofs, uint32_t rank, int rows, int cols){
+	mapped_header h;
+
+	std::memset(&h, 0, sizeof(h));
+	std::memcpy(h.magic, mapped_magic, sizeof(mapped_magic));
+	h.version= mapped_version;
+	h.byte_order= mapped_byte_order;
+	h.element_type= mapped_element<Elm>::code;
+	h.element_size= sizeof(Elm);
+	h.rank= rank;
+	h.rows= rows;
+	h.cols= cols;
+	h.data_offset= sizeof(mapped_header);
+
+	ofs.write(reinterpret_cast<char const*>(&h), sizeof(h));
+}
+
+inline
+void check_written(std::ofstream& ofs){
+	ofs.flush();
+	if(!ofs)
+		throw lib::exception::invalid_argument<>(L"ファイルに書き込めません。");
+}
+
+}
+
+/**
+ * ファイルをmmapした読み取り専用のベクトル<br>
+ * 要素はアクセスしたページから順にOSが読み込むため、読み込み時間も常駐メモリも
+ * 実際に参照した分だけで済む。要素はview()でvector_viewとして式やカーネルに渡す。<br>
+ * view()で得たビューはこのオブジェクトより長く使ってはならない。<br>
+ *
+ * @author  kamichidu
+ * @param <Elm> 要素の型
+ */
+template<class Elm= double>
+class mapped_vector{
+	public:
+		typedef Elm value_type;
+	public:
+		explicit mapped_vector(std::string const& path);
+		mapped_vector(mapped_vector<Elm>&& obj)= default;
+	public:
+		vector_view<Elm const> view() const;
+		Elm const& operator [] (int i) const;
+		Elm const* data() const;
+		int size() const;
+	private:
+		detail::mapped_file _file;
+		Elm const* _data;
+		int _size;
+};
+
+/**
+ * ファイルをmmapした読み取り専用の行列<br>
+ * 要素はアクセスしたページから順にOSが読み込むため、読み込み時間も常駐メモリも
+ * 実際に参照した分だけで済む。要素はview()でmatrix_viewとして式やカーネルに渡す。<br>
+ * view()で得たビューはこのオブジェクトより長く使ってはならない。<br>
+ *
+ * @author  kamichidu
+ * @param <Elm> 要素の型
+ */
+template<class Elm= double>
+class mapped_matrix{
+	public:
+		typedef Elm value_type;
+	public:
+		explicit mapped_matrix(std::string const& path);
+		mapped_matrix(mapped_matrix<Elm>&& obj)= default;
+	public:
+		matrix_view<Elm const> view() const;
+		vector_view<Elm const> operator [] (int row) const;
+		Elm const* data() const;
+		int rows() const;
+		int cols() const;
+	private:
+		detail::mapped_file _file;
+		Elm const* _data;
+		int _rows;
+		int _cols;
+};
+
+/**
+ * pathをmmapする。<br>
+ *
+ * @param path save()で書き込んだベクトルのファイル
+ * @throw lib::exception::invalid_argument<> 開けない場合、マップに失敗した場合、形式、バイト順、要素の型が異なる場合
+ */
+template<class Elm>
+inline
+mapped_vector<Elm>::mapped_vector(std::string const& path) : _file(path){
+	mapped_header h;
+
+	_data= detail::mapped_data<Elm>(_file, 1, h);
+	_size= static_cast<int>(h.rows);
+}
+
+template<class Elm>
+inline
+vector_view<Elm const> mapped_vector<Elm>::view() const{
+	return vector_view<Elm const>(_data, _size);
+}
+
+template<class Elm>
+inline
+Elm const& mapped_vector<Elm>::operator [] (int i) const{
+	return _data[i];
+}
+
+template<class Elm>
+inline
+Elm const* mapped_vector<Elm>::data() const{
+	return _data;
+}
+
+template<class Elm>
+inline
+int mapped_vector<Elm>::size() const{
+	return _size;
+}
+
+/**
+ * pathをmmapする。<br>
+ *
+ * @param path save()で書き込んだ行列のファイル
+ * @throw lib::exception::invalid_argument<> 開けない場合、マップに失敗した場合、形式、バイト順、要素の型が異なる場合
+ */
+template<class Elm>
+inline
+mapped_matrix<Elm>::mapped_matrix(std::string const& path) : _file(path){
+	mapped_header h;
+
+	_data= detail::mapped_data<Elm>(_file, 2, h);
+	_rows= static_cast<int>(h.rows);
+	_cols= static_cast<int>(h.cols);
+}
+
+template<class Elm>
+inline
+matrix_view<Elm const> mapped_matrix<Elm>::view() const{
+	return matrix_view<Elm const>(_data, _rows, _cols, _cols);
+}
+
+template<class Elm>
+inline
+vector_view<Elm const> mapped_matrix<Elm>::operator [] (int row) const{
+	return view()[row];
+}
+
+template<class Elm>
+inline
+Elm const* mapped_matrix<Elm>::data() const{
+	return _data;
+}
+
+template<class Elm>
+inline
+int mapped_matrix<Elm>::rows() const{
+	return _rows;
+}
+
+template<class Elm>
+inline
+int mapped_matrix<Elm>::cols() const{
+	return _cols;
+}
+
+/**
+ * ベクトルをmapped_vectorで読み込める形式で書き込む。<br>
+ *
+ * @param path 書き込むファイル(既にあれば上書きする)
+ * @param v    ベクトル(ビューの場合は間隔を詰めて書き込む)
+ * @throw lib::exception::invalid_argument<> 書き込みに失敗した場合
+ */
+template<class Elm>
+inline
+void save(std::string const& path, vector_view<Elm> const& v){
+	typedef typename vector_view<Elm>::value_type value_type;
+
+	std::ofstream ofs(path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+
+	detail::write_mapped_header<value_type>(ofs, 1, v.size(), 1);
+	if(v.stride() == 1){
+		ofs.write(reinterpret_cast<char const*>(v.data()), static_cast<std::streamsize>(v.size()) * sizeof(value_type));
+	}
+	else{
+		for(int i= 0; i < v.size(); ++i)
+			ofs.write(reinterpret_cast<char const*>(&v.element(i)), sizeof(value_type));
+	}
+	detail::check_written(ofs);
+}
+
+template<int N, class Elm>
+inline
+void save(std::string const& path, vector<N, Elm> const& v){
+	save(path, view(v));
+}
+
+/**
+ * 行列をmapped_matrixで読み込める形式で書き込む。<br>
+ *
+ * @param path 書き込むファイル(既にあれば上書きする)
+ * @param m    行列(ビューの場合は行優先に詰めて書き込む)
+ * @throw lib::exception::invalid_argument<> 書き込みに失敗した場合
+ */
+template<class Elm>
+inline
+void save(std::string const& path, matrix_view<Elm> const& m){
+	typedef typename matrix_view<Elm>::value_type value_type;
+
+	std::ofstream ofs(path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	std::vector<value_type> row;
+
+	detail::write_mapped_header<value_type>(ofs, 2, m.rows(), m.cols());
+	for(int i= 0; i < m.rows(); ++i){
+		value_type const* p= m.data() + static_cast<std::ptrdiff_t>(i) * m.row_stride();
+
+		if(m.col_stride() != 1){
+			row.resize(m.cols());
+			for(int j= 0; j < m.cols(); ++j)
+				row[j]= m.element(i, j);
+			p= row.data();
+		}
+		ofs.write(reinterpret_cast<char const*>(p), static_cast<std::streamsize>(m.cols()) * sizeof(value_type));
+	}
+	detail::check_written(ofs);
+}
+
+template<int N, int M, class Elm>
+inline
+void save(std::string const& path, matrix<N, M, Elm> const& m){
+	save(path, view(m));
+}
+
+}
+}
+
+#endif // #ifndef LIB_MATH_MAPPED_HPP_
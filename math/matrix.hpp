@@ -1,14 +1,126 @@
 #ifndef LIB_MATH_MATRIX_HPP_
 #define LIB_MATH_MATRIX_HPP_
 
-#include <memory>
+#include <algorithm>
+#include <initializer_list>
+#include <stdexcept>
+#include <vector>
+#include "dimension.hpp"
 #include "vector.hpp"
+#include "kernel/gemm.hpp"
+#include "kernel/level2.hpp"
+#include "kernel/transpose.hpp"
+#include "../memory/aligned_allocator.hpp"
 
 namespace lib{
 namespace math{
 
+/**
+ * matrixの要素の保持方法。<br>
+ * 行はvector<M, Elm>として、64バイト境界に揃えた1つの連続領域に並べる。<br>
+ *
+ * @param <N>     行数
+ * @param <M>     列数
+ * @param <Elm>   要素の型
+ * @param <Small> 要素をオブジェクト内に直接保持するか
+ */
+template<int N, int M, class Elm, bool Small= small_dimension(N, M)>
+class matrix_storage{
+	public:
+		typedef vector<M, Elm> row_type;
+		typedef row_type& row_reference;
+		typedef row_type const& const_row_reference;
+	public:
+		matrix_storage() : _mat(N){}
+		matrix_storage(int n, int m) : _mat(N){ check_dimension(N, n); check_dimension(M, m); }
+	public:
+		int rows() const{ return N; }
+		int cols() const{ return M; }
+		void resize(int n, int m){ check_dimension(N, n); check_dimension(M, m); }
+		Elm const* data() const{ return reinterpret_cast<Elm const*>(_mat.data()); }
+		Elm* data(){ return reinterpret_cast<Elm*>(_mat.data()); }
+		const_row_reference row(int i) const{ return _mat[i]; }
+		row_reference row(int i){ return _mat[i]; }
+	private:
+		static_assert(sizeof(row_type) == sizeof(Elm) * M, "rows must be laid out contiguously");
+
+		std::vector<row_type, memory::aligned_allocator<row_type>> _mat;
+};
+
+/**
+ * 4×4以下のmatrixの要素の保持方法。<br>
+ * 行をオブジェクト内に直接並べるため、生成・コピー時にヒープ確保は発生せず、
+ * constexprで扱える。<br>
+ *
+ * @param <N>   行数
+ * @param <M>   列数
+ * @param <Elm> 要素の型
+ */
+template<int N, int M, class Elm>
+class matrix_storage<N, M, Elm, true>{
+	public:
+		typedef vector<M, Elm> row_type;
+		typedef row_type& row_reference;
+		typedef row_type const& const_row_reference;
+	public:
+		constexpr matrix_storage() : _mat(){}
+		constexpr matrix_storage(int n, int m) : _mat(){ check_dimension(N, n); check_dimension(M, m); }
+	public:
+		constexpr int rows() const{ return N; }
+		constexpr int cols() const{ return M; }
+		constexpr void resize(int n, int m){ check_dimension(N, n); check_dimension(M, m); }
+		Elm const* data() const{ return reinterpret_cast<Elm const*>(_mat); }
+		Elm* data(){ return reinterpret_cast<Elm*>(_mat); }
+		constexpr const_row_reference row(int i) const{ return _mat[i]; }
+		constexpr row_reference row(int i){ return _mat[i]; }
+	private:
+		static_assert(sizeof(row_type) == sizeof(Elm) * M, "rows must be laid out contiguously");
+
+		row_type _mat[N];
+};
+
+/**
+ * 行数と列数が実行時に決まるmatrixの要素の保持方法。<br>
+ * 要素は64バイト境界に揃えた1つの連続領域に行優先で並べ、
+ * 行は先頭要素へのポインタとして参照する。<br>
+ *
+ * @param <Elm> 要素の型
+ */
+template<class Elm>
+class matrix_storage<dynamic, dynamic, Elm, false>{
+	public:
+		typedef Elm* row_reference;
+		typedef Elm const* const_row_reference;
+	public:
+		matrix_storage() : _rows(0), _cols(0){}
+		matrix_storage(int n, int m) : _rows(n), _cols(m), _mat(static_cast<std::size_t>(n) * m){}
+	public:
+		int rows() const{ return _rows; }
+		int cols() const{ return _cols; }
+		void resize(int n, int m){ _mat.resize(static_cast<std::size_t>(n) * m); _rows= n; _cols= m; }
+		Elm const* data() const{ return _mat.data(); }
+		Elm* data(){ return _mat.data(); }
+		const_row_reference row(int i) const{ return data() + static_cast<std::size_t>(i) * _cols; }
+		row_reference row(int i){ return data() + static_cast<std::size_t>(i) * _cols; }
+	private:
+		int _rows;
+		int _cols;
+		std::vector<Elm, memory::aligned_allocator<Elm>> _mat;
+};
+
 /**
  * N行M列の行列クラス<br>
+ * 要素は64バイト境界に揃えた1つの連続領域に行優先で保持する。<br>
+ * 行数、列数とも4以下の場合は要素をオブジェクト内に直接保持する。
+ * この場合はtrivially copyableで、生成、要素アクセス、積、転置、行列式、逆行列を
+ * constexprで評価できる。<br>
+ * operator []はその領域上の1行をvectorとして参照する。<br>
+ * NとMがdynamicの場合は実行時に行数と列数を決める(dynamic_matrix)。
+ * この場合operator []は行の先頭要素へのポインタを返すので、m[i][j]の形で同様に使える。<br>
+ * 加減算とスカラー倍は式テンプレートとして組み立てられ、matrixへ代入する時点で
+ * 1回のループにまとめて評価される。<br>
+ * operator []は範囲チェックを行わない。LIB_MATH_DEBUGを定義した場合と
+ * at()はstd::out_of_rangeを投げる。<br>
  *
  * @author  kamichidu
  * @version 2012-05-20 (日)
@@ -17,77 +129,721 @@ namespace math{
  * @param <Elm> 要素の型
  */
 template<int N, int M, class Elm= double>
-class matrix{
+class matrix : public matrix_expression<matrix<N, M, Elm>>{
+	static_assert((N > 0 && M > 0) || (N == dynamic && M == dynamic), "dimensions must be both positive or both dynamic");
+	private:
+		typedef matrix_storage<N, M, Elm> storage_type;
 	public:
-		matrix();
-		~matrix();
+		typedef Elm value_type;
+		typedef typename storage_type::row_reference row_reference;
+		typedef typename storage_type::const_row_reference const_row_reference;
+
+		static int const row_dimension= N;
+		static int const col_dimension= M;
+	public:
+		constexpr matrix();
+		constexpr matrix(int rows, int cols);
+		constexpr matrix(std::initializer_list<vector<M, Elm>> rows);
+		template<class E>
+			matrix(matrix_expression<E> const& e);
+		~matrix()= default;
 	public:
-		matrix<N, M, Elm> const operator + (matrix<N, M, Elm> const& r) const;
-		matrix<N, M, Elm> const operator - (matrix<N, M, Elm> const& r) const;
+		template<class E>
+			matrix<N, M, Elm>& operator = (matrix_expression<E> const& r);
+		template<class E>
+			matrix<N, M, Elm>& operator += (matrix_expression<E> const& r);
+		template<class E>
+			matrix<N, M, Elm>& operator -= (matrix_expression<E> const& r);
 		template<int O>
-			matrix<N, O, Elm> const operator * (matrix<M, O, Elm> const& r) const;
-		vector<M> const& operator [] (int row) const;
-		vector<M>& operator [] (int row);
+			constexpr matrix<N, O, Elm> const operator * (matrix<M, O, Elm> const& r) const;
+		constexpr vector<N, Elm> const operator * (vector<M, Elm> const& x) const;
+		constexpr const_row_reference operator [] (int row) const;
+		constexpr row_reference operator [] (int row);
+		constexpr const_row_reference at(int row) const;
+		constexpr row_reference at(int row);
+		Elm const* data() const;
+		Elm* data();
+		constexpr int rows() const;
+		constexpr int cols() const;
+		constexpr Elm const& element(int i, int j) const;
+		bool overlaps(void const* first, void const* last) const;
 	public: // copy semantics
-		matrix(matrix<N, M, Elm> const& obj);
-		matrix<N, M, Elm>& operator = (matrix<N, M, Elm> const& r);
+		matrix(matrix<N, M, Elm> const& obj)= default;
+		matrix<N, M, Elm>& operator = (matrix<N, M, Elm> const& r)= default;
 	public: // move semantics
-		matrix(matrix<N, M, Elm>&& obj);
-		matrix<N, M, Elm>& operator = (matrix<N, M, Elm>&& r);
+		matrix(matrix<N, M, Elm>&& obj)= default;
+		matrix<N, M, Elm>& operator = (matrix<N, M, Elm>&& r)= default;
 	private:
-		std::unique_ptr<vector<N, vector<M, Elm>>> _mat;
+		storage_type _mat;
 };
 
+/**
+ * dynamic_matrix<Elm>はmatrix<dynamic, dynamic, Elm>の別名。<br>
+ */
+template<class Elm= double>
+using dynamic_matrix= matrix<dynamic, dynamic, Elm>;
+
+/**
+ * 要素を値初期化する。N、Mがdynamicの場合は0行0列になる。<br>
+ */
 template<int N, int M, class Elm>
-inline
+constexpr
 matrix<N, M, Elm>::matrix(){
-	_mat= std::unique_ptr<vector<N, vector<M, Elm>>>(new vector<N, vector<M, Elm>>());
 }
 
+/**
+ * rows行cols列で初期化する。要素は値初期化される。<br>
+ *
+ * @param rows 行数(Nが正の場合はNと等しくなければならない)
+ * @param cols 列数(Mが正の場合はMと等しくなければならない)
+ */
+template<int N, int M, class Elm>
+constexpr
+matrix<N, M, Elm>::matrix(int rows, int cols) : _mat(rows, cols){
+}
+
+/**
+ * 行を並べて初期化する。先頭からN行までを使い、足りない行は値初期化される。<br>
+ * N、Mがdynamicの場合はすべての行を使い、列数は先頭の行に合わせる。<br>
+ *
+ * @param mat 各行
+ * @throw lib::exception::invalid_argument<> 行の次元が揃っていない場合
+ */
+template<int N, int M, class Elm>
+constexpr
+matrix<N, M, Elm>::matrix(std::initializer_list<vector<M, Elm>> mat)
+	: _mat(N == dynamic ? static_cast<int>(mat.size()) : N, (M == dynamic && mat.size() > 0) ? mat.begin()->size() : (M == dynamic ? 0 : M)){
+	vector<M, Elm> const* const src= mat.begin();
+	int const n= std::min<int>(rows(), mat.size());
+	int const m= cols();
+
+	for(int i= 0; i < n; ++i){
+		check_dimension(m, src[i].size());
+
+		for(int j= 0; j < m; ++j)
+			(*this)[i][j]= src[i].element(j);
+	}
+}
+
+/**
+ * 式を評価して初期化する。<br>
+ *
+ * @param e 行列式
+ */
 template<int N, int M, class Elm>
+template<class E>
 inline
-matrix<N, M, Elm>::~matrix(){
-	_mat= std::unique_ptr<vector<N, vector<M, Elm>>>();
+matrix<N, M, Elm>::matrix(matrix_expression<E> const& e) : _mat(e.self().rows(), e.self().cols()){
+	static_assert(compatible_dimension(E::row_dimension, N) && compatible_dimension(E::col_dimension, M), "dimension mismatch");
+
+	E const& x= e.self();
+	Elm* const dest= data();
+	int const n= rows();
+	int const m= cols();
+
+	for(int i= 0; i < n; ++i){
+		Elm* const row= dest + static_cast<std::size_t>(i) * m;
+
+		for(int j= 0; j < m; ++j)
+			row[j]= x.element(i, j);
+	}
 }
 
+/**
+ * 式を評価して代入する。<br>
+ * 右辺に*thisを含んでもよい。matrix同士の式は同じ位置の要素しか参照しないのでそのまま書き込み、
+ * transpose_viewのように別の位置を参照し得る式は一時オブジェクトに評価してから写す。<br>
+ *
+ * @param r 行列式
+ * @return
+ *     *this
+ */
 template<int N, int M, class Elm>
+template<class E>
 inline
-matrix<N, M, Elm> const matrix<N, M, Elm>::operator + (matrix<N, M, Elm> const& r) const{
-	matrix<N, M, Elm> buf;
+matrix<N, M, Elm>& matrix<N, M, Elm>::operator = (matrix_expression<E> const& r){
+	static_assert(compatible_dimension(E::row_dimension, N) && compatible_dimension(E::col_dimension, M), "dimension mismatch");
 
-	for(int i= 0; i < N; ++i)
+	if(expression::may_alias<E>::value)
+		return *this= matrix<N, M, Elm>(r);
+
+	E const& x= r.self();
+
+	_mat.resize(x.rows(), x.cols());
+
+	Elm* const dest= data();
+	int const n= rows();
+	int const m= cols();
+
+	for(int i= 0; i < n; ++i){
+		Elm* const row= dest + static_cast<std::size_t>(i) * m;
+
+		for(int j= 0; j < m; ++j)
+			row[j]= x.element(i, j);
+	}
+
+	return *this;
+}
+
+template<int N, int M, class Elm>
+template<class E>
+inline
+matrix<N, M, Elm>& matrix<N, M, Elm>::operator += (matrix_expression<E> const& r){
+	static_assert(compatible_dimension(E::row_dimension, N) && compatible_dimension(E::col_dimension, M), "dimension mismatch");
+
+	if(expression::may_alias<E>::value)
+		return *this= matrix<N, M, Elm>(*this + r);
+
+	E const& x= r.self();
+
+	check_dimension(rows(), x.rows());
+	check_dimension(cols(), x.cols());
+
+	Elm* const dest= data();
+	int const n= rows();
+	int const m= cols();
+
+	for(int i= 0; i < n; ++i){
+		Elm* const row= dest + static_cast<std::size_t>(i) * m;
+
+		for(int j= 0; j < m; ++j)
+			row[j]+= x.element(i, j);
+	}
+
+	return *this;
+}
+
+template<int N, int M, class Elm>
+template<class E>
+inline
+matrix<N, M, Elm>& matrix<N, M, Elm>::operator -= (matrix_expression<E> const& r){
+	static_assert(compatible_dimension(E::row_dimension, N) && compatible_dimension(E::col_dimension, M), "dimension mismatch");
+
+	if(expression::may_alias<E>::value)
+		return *this= matrix<N, M, Elm>(*this - r);
+
+	E const& x= r.self();
+
+	check_dimension(rows(), x.rows());
+	check_dimension(cols(), x.cols());
+
+	Elm* const dest= data();
+	int const n= rows();
+	int const m= cols();
+
+	for(int i= 0; i < n; ++i){
+		Elm* const row= dest + static_cast<std::size_t>(i) * m;
+
+		for(int j= 0; j < m; ++j)
+			row[j]-= x.element(i, j);
+	}
+
+	return *this;
+}
+
+namespace detail{
+
+template<int N, int M, int O, class Elm>
+constexpr
+matrix<N, O, Elm> small_product(matrix<N, M, Elm> const& l, matrix<M, O, Elm> const& r){
+	matrix<N, O, Elm> buf;
+
+	LIB_MATH_KERNEL_UNROLL(4)
+	for(int i= 0; i < N; ++i){
+		LIB_MATH_KERNEL_UNROLL(4)
+		for(int j= 0; j < O; ++j){
+			Elm acc= Elm();
+
+			LIB_MATH_KERNEL_UNROLL(4)
+			for(int k= 0; k < M; ++k)
+				acc+= l.element(i, k) * r.element(k, j);
+
+			buf[i][j]= acc;
+		}
+	}
+
+	return buf;
+}
+
+template<int N, int M, int O, class Elm>
+inline
+matrix<N, O, Elm> gemm_product(matrix<N, M, Elm> const& l, matrix<M, O, Elm> const& r){
+	check_dimension(l.cols(), r.rows());
+
+	matrix<N, O, Elm> buf(l.rows(), r.cols());
+
+	kernel::gemm(l.rows(), r.cols(), l.cols(), Elm(1), l.data(), l.cols(), r.data(), r.cols(), Elm(), buf.data(), buf.cols());
+
+	return buf;
+}
+
+template<int N, int M, class Elm>
+constexpr
+vector<N, Elm> small_product(matrix<N, M, Elm> const& a, vector<M, Elm> const& x){
+	vector<N, Elm> buf;
+
+	LIB_MATH_KERNEL_UNROLL(4)
+	for(int i= 0; i < N; ++i){
+		Elm acc= Elm();
+
+		LIB_MATH_KERNEL_UNROLL(4)
 		for(int j= 0; j < M; ++j)
-			buf[i][j]= (*this)[i][j] + r[i][j];
+			acc+= a.element(i, j) * x.element(j);
+
+		buf[i]= acc;
+	}
+
+	return buf;
+}
+
+template<int N, int M, class Elm>
+inline
+vector<N, Elm> gemv_product(matrix<N, M, Elm> const& a, vector<M, Elm> const& x){
+	check_dimension(a.cols(), x.size());
+
+	vector<N, Elm> buf(a.rows());
+
+	kernel::gemv(a.rows(), a.cols(), Elm(1), a.data(), a.cols(), x.data(), 1, Elm(), buf.data(), 1);
 
 	return buf;
 }
 
+}
+
+/**
+ * 行列積を計算する。<br>
+ * 両辺とも4×4以下の場合は展開したループで計算し、constexprで評価できる。<br>
+ *
+ * @param r 右辺(M行O列)
+ * @return
+ *     N行O列の積
+ * @see kernel::gemm
+ */
+template<int N, int M, class Elm>
+template<int O>
+constexpr
+matrix<N, O, Elm> const matrix<N, M, Elm>::operator * (matrix<M, O, Elm> const& r) const{
+	return (small_dimension(N, M) && small_dimension(M, O)) ? detail::small_product(*this, r) : detail::gemm_product(*this, r);
+}
+
+/**
+ * 行列とベクトルの積を計算する。<br>
+ * 4×4以下の場合は展開したループで計算し、constexprで評価できる。<br>
+ *
+ * @param x 右辺(M次元)
+ * @return
+ *     N次元の積
+ * @see kernel::gemv
+ */
+template<int N, int M, class Elm>
+constexpr
+vector<N, Elm> const matrix<N, M, Elm>::operator * (vector<M, Elm> const& x) const{
+	return small_dimension(N, M) ? detail::small_product(*this, x) : detail::gemv_product(*this, x);
+}
+
+template<int N, int M, class Elm>
+constexpr
+typename matrix<N, M, Elm>::const_row_reference matrix<N, M, Elm>::operator [] (int row) const{
+#ifdef LIB_MATH_DEBUG
+	return at(row);
+#else
+	return _mat.row(row);
+#endif
+}
+
+template<int N, int M, class Elm>
+constexpr
+typename matrix<N, M, Elm>::row_reference matrix<N, M, Elm>::operator [] (int row){
+#ifdef LIB_MATH_DEBUG
+	return at(row);
+#else
+	return _mat.row(row);
+#endif
+}
+
+/**
+ * 範囲チェック付きの行アクセス。<br>
+ *
+ * @param row 行
+ * @throw std::out_of_range 行が範囲外の場合
+ */
+template<int N, int M, class Elm>
+constexpr
+typename matrix<N, M, Elm>::const_row_reference matrix<N, M, Elm>::at(int row) const{
+	if(row < 0 || row >= rows())
+		throw std::out_of_range("lib::math::matrix");
+
+	return _mat.row(row);
+}
+
+template<int N, int M, class Elm>
+constexpr
+typename matrix<N, M, Elm>::row_reference matrix<N, M, Elm>::at(int row){
+	if(row < 0 || row >= rows())
+		throw std::out_of_range("lib::math::matrix");
+
+	return _mat.row(row);
+}
+
+template<int N, int M, class Elm>
+constexpr
+int matrix<N, M, Elm>::rows() const{
+	return _mat.rows();
+}
+
+template<int N, int M, class Elm>
+constexpr
+int matrix<N, M, Elm>::cols() const{
+	return _mat.cols();
+}
+
+/**
+ * 範囲チェックなしの要素アクセス。式の評価に使う。<br>
+ *
+ * @param i 行
+ * @param j 列
+ * @return
+ *     i行j列の要素
+ */
+template<int N, int M, class Elm>
+constexpr
+Elm const& matrix<N, M, Elm>::element(int i, int j) const{
+	return _mat.row(i)[j];
+}
+
+/**
+ * 要素の領域がアドレス[first, last)と重なるか。<br>
+ */
+template<int N, int M, class Elm>
+inline
+bool matrix<N, M, Elm>::overlaps(void const* first, void const* last) const{
+	return expression::intersects(first, last, data(), data() + static_cast<std::size_t>(rows()) * cols());
+}
+
+/**
+ * 行優先に並んだ要素の先頭を返す。<br>
+ *
+ * @return
+ *     (i, j)要素がdata()[i * cols() + j]にある連続領域
+ */
+template<int N, int M, class Elm>
+inline
+Elm const* matrix<N, M, Elm>::data() const{
+	return _mat.data();
+}
+
+template<int N, int M, class Elm>
+inline
+Elm* matrix<N, M, Elm>::data(){
+	return _mat.data();
+}
+
+/**
+ * y= alpha*A*x + beta*y を計算する。<br>
+ * beta == 0の場合、yの元の値は参照しない。<br>
+ *
+ * @param alpha A*xに掛ける係数
+ * @param a     N行M列の行列
+ * @param x     M次元のベクトル
+ * @param beta  yに掛ける係数
+ * @param y     更新されるN次元のベクトル
+ * @throw lib::exception::invalid_argument 次元が合わない場合
+ */
+template<int N, int M, class Elm>
+inline
+void gemv(Elm const& alpha, matrix<N, M, Elm> const& a, vector<M, Elm> const& x, Elm const& beta, vector<N, Elm>& y){
+	check_dimension(a.cols(), x.size());
+	check_dimension(a.rows(), y.size());
+
+	kernel::gemv(a.rows(), a.cols(), alpha, a.data(), a.cols(), x.data(), 1, beta, y.data(), 1);
+}
+
+/**
+ * y= alpha*A^T*x + beta*y を計算する。<br>
+ * 転置行列は作らず、Aを行ごとに1回だけ走査する。<br>
+ *
+ * @param alpha A^T*xに掛ける係数
+ * @param a     N行M列の行列
+ * @param x     N次元のベクトル
+ * @param beta  yに掛ける係数
+ * @param y     更新されるM次元のベクトル
+ * @throw lib::exception::invalid_argument 次元が合わない場合
+ */
+template<int N, int M, class Elm>
+inline
+void gemv_t(Elm const& alpha, matrix<N, M, Elm> const& a, vector<N, Elm> const& x, Elm const& beta, vector<M, Elm>& y){
+	check_dimension(a.rows(), x.size());
+	check_dimension(a.cols(), y.size());
+
+	kernel::gemv_t(a.rows(), a.cols(), alpha, a.data(), a.cols(), x.data(), 1, beta, y.data(), 1);
+}
+
+/**
+ * 転置行列とベクトルの積 A^T*x を計算する。<br>
+ *
+ * @param a N行M列の行列
+ * @param x N次元のベクトル
+ * @return
+ *     M次元の積
+ * @throw lib::exception::invalid_argument 次元が合わない場合
+ */
+template<int N, int M, class Elm>
+inline
+vector<M, Elm> transpose_product(matrix<N, M, Elm> const& a, vector<N, Elm> const& x){
+	vector<M, Elm> y(a.cols());
+
+	gemv_t(Elm(1), a, x, Elm(), y);
+
+	return y;
+}
+
+/**
+ * 階数1の更新 A+= alpha*x*y^T を計算する。<br>
+ *
+ * @param alpha 係数
+ * @param x     N次元のベクトル
+ * @param y     M次元のベクトル
+ * @param a     更新されるN行M列の行列
+ * @throw lib::exception::invalid_argument 次元が合わない場合
+ */
 template<int N, int M, class Elm>
 inline
-matrix<N, M, Elm> const matrix<N, M, Elm>::operator - (matrix<N, M, Elm> const& r) const{
-	matrix<N, M, Elm> buf(*this);
+void ger(Elm const& alpha, vector<N, Elm> const& x, vector<M, Elm> const& y, matrix<N, M, Elm>& a){
+	check_dimension(a.rows(), x.size());
+	check_dimension(a.cols(), y.size());
+
+	kernel::ger(a.rows(), a.cols(), alpha, x.data(), 1, y.data(), 1, a.data(), a.cols());
+}
+
+namespace detail{
+
+template<int N, int M, class Elm>
+constexpr
+matrix<M, N, Elm> small_transpose(matrix<N, M, Elm> const& a){
+	matrix<M, N, Elm> buf;
 
 	for(int i= 0; i < N; ++i)
 		for(int j= 0; j < M; ++j)
-			buf[i][j]-= r[i][j];
+			buf[j][i]= a.element(i, j);
 
 	return buf;
 }
 
 template<int N, int M, class Elm>
 inline
-vector<M> const& matrix<N, M, Elm>::operator [] (int row) const{
-	return _mat->operator [] (row);
+matrix<M, N, Elm> blocked_transpose(matrix<N, M, Elm> const& a){
+	matrix<M, N, Elm> buf(a.cols(), a.rows());
+
+	kernel::transpose(a.rows(), a.cols(), a.data(), a.cols(), buf.data(), buf.cols());
+
+	return buf;
 }
 
+}
+
+/**
+ * 転置行列を計算する。<br>
+ * 4×4以下の場合はconstexprで評価できる。
+ * それ以外はキャッシュ非依存の再帰分割で入れ替える。<br>
+ *
+ * @param a N行M列の行列
+ * @return
+ *     M行N列の転置行列
+ * @see kernel::transpose
+ */
 template<int N, int M, class Elm>
-inline
-vector<M>& matrix<N, M, Elm>::operator [] (int row){
-	return _mat->operator [] (row);
+constexpr
+matrix<M, N, Elm> transpose(matrix<N, M, Elm> const& a){
+	return small_dimension(N, M) ? detail::small_transpose(a) : detail::blocked_transpose(a);
 }
 
+/**
+ * 2×2行列の行列式を計算する。<br>
+ *
+ * @param a 行列
+ * @return
+ *     aの行列式
+ */
+template<class Elm>
+constexpr
+Elm determinant(matrix<2, 2, Elm> const& a){
+	return a[0][0] * a[1][1] - a[0][1] * a[1][0];
 }
+
+/**
+ * 3×3行列の行列式を計算する。<br>
+ *
+ * @param a 行列
+ * @return
+ *     aの行列式
+ */
+template<class Elm>
+constexpr
+Elm determinant(matrix<3, 3, Elm> const& a){
+	return a[0][0] * (a[1][1] * a[2][2] - a[1][2] * a[2][1])
+		 - a[0][1] * (a[1][0] * a[2][2] - a[1][2] * a[2][0])
+		 + a[0][2] * (a[1][0] * a[2][1] - a[1][1] * a[2][0]);
 }
 
-#endif // #ifndef LIB_MATH_MATRIX_HPP_
+namespace detail{
+
+/**
+ * 4×4行列の上2行、下2行から作る2×2小行列式。<br>
+ * 行列式と逆行列の両方で使う。<br>
+ */
+template<class Elm>
+struct minors4{
+	Elm s[6];
+	Elm c[6];
+};
+
+template<class Elm>
+constexpr
+minors4<Elm> make_minors4(matrix<4, 4, Elm> const& a){
+	minors4<Elm> r= {};
+
+	r.s[0]= a[0][0] * a[1][1] - a[1][0] * a[0][1];
+	r.s[1]= a[0][0] * a[1][2] - a[1][0] * a[0][2];
+	r.s[2]= a[0][0] * a[1][3] - a[1][0] * a[0][3];
+	r.s[3]= a[0][1] * a[1][2] - a[1][1] * a[0][2];
+	r.s[4]= a[0][1] * a[1][3] - a[1][1] * a[0][3];
+	r.s[5]= a[0][2] * a[1][3] - a[1][2] * a[0][3];
+	r.c[5]= a[2][2] * a[3][3] - a[3][2] * a[2][3];
+	r.c[4]= a[2][1] * a[3][3] - a[3][1] * a[2][3];
+	r.c[3]= a[2][1] * a[3][2] - a[3][1] * a[2][2];
+	r.c[2]= a[2][0] * a[3][3] - a[3][0] * a[2][3];
+	r.c[1]= a[2][0] * a[3][2] - a[3][0] * a[2][2];
+	r.c[0]= a[2][0] * a[3][1] - a[3][0] * a[2][1];
+
+	return r;
+}
 
+template<class Elm>
+constexpr
+Elm determinant(minors4<Elm> const& m){
+	return m.s[0] * m.c[5] - m.s[1] * m.c[4] + m.s[2] * m.c[3] + m.s[3] * m.c[2] - m.s[4] * m.c[1] + m.s[5] * m.c[0];
+}
+
+template<class Elm>
+constexpr
+Elm checked_reciprocal(Elm const& det){
+	if(det == Elm())
+		throw lib::exception::invalid_argument<>(L"特異行列です。");
+
+	return Elm(1) / det;
+}
+
+}
+
+/**
+ * 4×4行列の行列式を計算する。<br>
+ *
+ * @param a 行列
+ * @return
+ *     aの行列式
+ */
+template<class Elm>
+constexpr
+Elm determinant(matrix<4, 4, Elm> const& a){
+	return detail::determinant(detail::make_minors4(a));
+}
+
+/**
+ * 2×2行列の逆行列を余因子行列から計算する。<br>
+ *
+ * @param a 行列
+ * @return
+ *     aの逆行列
+ * @throw lib::exception::invalid_argument<> 行列式が0の場合
+ */
+template<class Elm>
+constexpr
+matrix<2, 2, Elm> inverse(matrix<2, 2, Elm> const& a){
+	Elm const inv= detail::checked_reciprocal(determinant(a));
+
+	return matrix<2, 2, Elm>{
+		{ a[1][1] * inv, -a[0][1] * inv},
+		{-a[1][0] * inv,  a[0][0] * inv},
+	};
+}
+
+/**
+ * 3×3行列の逆行列を余因子行列から計算する。<br>
+ *
+ * @param a 行列
+ * @return
+ *     aの逆行列
+ * @throw lib::exception::invalid_argument<> 行列式が0の場合
+ */
+template<class Elm>
+constexpr
+matrix<3, 3, Elm> inverse(matrix<3, 3, Elm> const& a){
+	Elm const inv= detail::checked_reciprocal(determinant(a));
+
+	return matrix<3, 3, Elm>{
+		{
+			(a[1][1] * a[2][2] - a[1][2] * a[2][1]) * inv,
+			(a[0][2] * a[2][1] - a[0][1] * a[2][2]) * inv,
+			(a[0][1] * a[1][2] - a[0][2] * a[1][1]) * inv,
+		},
+		{
+			(a[1][2] * a[2][0] - a[1][0] * a[2][2]) * inv,
+			(a[0][0] * a[2][2] - a[0][2] * a[2][0]) * inv,
+			(a[0][2] * a[1][0] - a[0][0] * a[1][2]) * inv,
+		},
+		{
+			(a[1][0] * a[2][1] - a[1][1] * a[2][0]) * inv,
+			(a[0][1] * a[2][0] - a[0][0] * a[2][1]) * inv,
+			(a[0][0] * a[1][1] - a[0][1] * a[1][0]) * inv,
+		},
+	};
+}
+
+/**
+ * 4×4行列の逆行列を2×2小行列式から計算する。<br>
+ *
+ * @param a 行列
+ * @return
+ *     aの逆行列
+ * @throw lib::exception::invalid_argument<> 行列式が0の場合
+ */
+template<class Elm>
+constexpr
+matrix<4, 4, Elm> inverse(matrix<4, 4, Elm> const& a){
+	detail::minors4<Elm> const m= detail::make_minors4(a);
+	Elm const* const s= m.s;
+	Elm const* const c= m.c;
+	Elm const inv= detail::checked_reciprocal(detail::determinant(m));
+
+	return matrix<4, 4, Elm>{
+		{
+			( a[1][1] * c[5] - a[1][2] * c[4] + a[1][3] * c[3]) * inv,
+			(-a[0][1] * c[5] + a[0][2] * c[4] - a[0][3] * c[3]) * inv,
+			( a[3][1] * s[5] - a[3][2] * s[4] + a[3][3] * s[3]) * inv,
+			(-a[2][1] * s[5] + a[2][2] * s[4] - a[2][3] * s[3]) * inv,
+		},
+		{
+			(-a[1][0] * c[5] + a[1][2] * c[2] - a[1][3] * c[1]) * inv,
+			( a[0][0] * c[5] - a[0][2] * c[2] + a[0][3] * c[1]) * inv,
+			(-a[3][0] * s[5] + a[3][2] * s[2] - a[3][3] * s[1]) * inv,
+			( a[2][0] * s[5] - a[2][2] * s[2] + a[2][3] * s[1]) * inv,
+		},
+		{
+			( a[1][0] * c[4] - a[1][1] * c[2] + a[1][3] * c[0]) * inv,
+			(-a[0][0] * c[4] + a[0][1] * c[2] - a[0][3] * c[0]) * inv,
+			( a[3][0] * s[4] - a[3][1] * s[2] + a[3][3] * s[0]) * inv,
+			(-a[2][0] * s[4] + a[2][1] * s[2] - a[2][3] * s[0]) * inv,
+		},
+		{
+			(-a[1][0] * c[3] + a[1][1] * c[1] - a[1][2] * c[0]) * inv,
+			( a[0][0] * c[3] - a[0][1] * c[1] + a[0][2] * c[0]) * inv,
+			(-a[3][0] * s[3] + a[3][1] * s[1] - a[3][2] * s[0]) * inv,
+			( a[2][0] * s[3] - a[2][1] * s[1] + a[2][2] * s[0]) * inv,
+		},
+	};
+}
+
+}
+}
+
+#endif // #ifndef LIB_MATH_MATRIX_HPP_
@@ -0,0 +1,229 @@
+#ifndef LIB_MATH_RUNNING_STATISTIC_HPP_
+#define LIB_MATH_RUNNING_STATISTIC_HPP_
+
+#include <cmath>
+#include <limits>
+#include "kernel/moments.hpp"
+
+namespace lib{
+namespace math{
+
+/**
+ * 値を1つずつ受け取りながら基本統計量を求めるクラス<br>
+ * 値は保持せず、個数、最小値、最大値、和、平均、偏差平方和だけを更新する(Welfordの方法)。<br>
+ * 平均と偏差平方和を直接更新するので、sum(x^2) - n*mean^2 のような桁落ちが起きない。<br>
+ * merge()で別々に集計した結果をまとめられるので、スレッドごとに集計してから合わせることができる。<br>
+ * 中央値などの順序統計量が必要な場合はstatisticを使う。<br>
+ *
+ * @author  kamichidu
+ * @param <Elm> 値の型
+ */
+template<class Elm= double>
+class running_statistic{
+	public:
+		running_statistic();
+	public:
+		void push(Elm const& x);
+		template<class InputIterator>
+			void push(InputIterator first, InputIterator last);
+		void push(Elm const* data, int n);
+		void merge(running_statistic<Elm> const& r);
+		void clear();
+		long long size() const;
+		Elm const& max() const;
+		Elm const& min() const;
+		double sum() const;
+		double mean() const;
+		double variance() const;
+		double sample_variance() const;
+		double standard_deviation() const;
+	private:
+		long long _count;
+		Elm _min;
+		Elm _max;
+		double _sum;
+		double _mean;
+		double _m2;
+};
+
+/**
+ * 値を1つも受け取っていない状態で初期化する。<br>
+ */
+template<class Elm>
+inline
+running_statistic<Elm>::running_statistic() :
+	_count(0), _min(std::numeric_limits<Elm>::max()), _max(std::numeric_limits<Elm>::lowest()), _sum(0.), _mean(0.), _m2(0.){
+}
+
+/**
+ * 値を1つ加える。<br>
+ *
+ * @param x 値
+ */
+template<class Elm>
+inline
+void running_statistic<Elm>::push(Elm const& x){
+	double const v= static_cast<double>(x);
+	double const delta= v - _mean;
+
+	++_count;
+	_mean+= delta / static_cast<double>(_count);
+	_m2+= delta * (v - _mean);
+	_sum+= v;
+	if(x < _min)
+		_min= x;
+	if(x > _max)
+		_max= x;
+}
+
+/**
+ * [first, last)の値を順に加える。<br>
+ */
+template<class Elm>
+template<class InputIterator>
+inline
+void running_statistic<Elm>::push(InputIterator first, InputIterator last){
+	for(; first != last; ++first)
+		push(*first);
+}
+
+/**
+ * 連続したn個の値をまとめて加える。<br>
+ * 和と偏差平方和をkernel::momentsで求めてからmerge()するので、
+ * 1つずつpush()するより速く、誤差も小さい。<br>
+ *
+ * @param data 値の配列
+ * @param n    個数
+ */
+template<class Elm>
+inline
+void running_statistic<Elm>::push(Elm const* data, int n){
+	if(n <= 0)
+		return;
+
+	running_statistic<Elm> batch;
+	kernel::moments_result const m= kernel::moments(n, data, 1);
+	Elm lo= data[0], hi= data[0];
+
+	for(int i= 1; i < n; ++i){
+		lo= (data[i] < lo) ? data[i] : lo;
+		hi= (data[i] > hi) ? data[i] : hi;
+	}
+
+	batch._count= n;
+	batch._min= lo;
+	batch._max= hi;
+	batch._sum= m.sum;
+	batch._mean= m.mean;
+	batch._m2= m.m2;
+	merge(batch);
+}
+
+/**
+ * 別に集計した結果を合わせる。<br>
+ * 合わせた結果は、両方の値をすべてこのオブジェクトにpush()した場合と(丸め誤差を除き)同じになる。<br>
+ *
+ * @param r 合わせる集計結果
+ */
+template<class Elm>
+inline
+void running_statistic<Elm>::merge(running_statistic<Elm> const& r){
+	if(r._count == 0)
+		return;
+	if(_count == 0){
+		*this= r;
+		return;
+	}
+
+	double const n= static_cast<double>(_count + r._count);
+	double const delta= r._mean - _mean;
+
+	_m2+= r._m2 + delta * delta * (static_cast<double>(_count) * static_cast<double>(r._count) / n);
+	_mean+= delta * (static_cast<double>(r._count) / n);
+	_sum+= r._sum;
+	_count+= r._count;
+	if(r._min < _min)
+		_min= r._min;
+	if(r._max > _max)
+		_max= r._max;
+}
+
+/**
+ * 値を1つも受け取っていない状態に戻す。<br>
+ */
+template<class Elm>
+inline
+void running_statistic<Elm>::clear(){
+	*this= running_statistic<Elm>();
+}
+
+template<class Elm>
+inline
+long long running_statistic<Elm>::size() const{
+	return _count;
+}
+
+/**
+ * 最大値。size() == 0の場合はElmの最小値。<br>
+ */
+template<class Elm>
+inline
+Elm const& running_statistic<Elm>::max() const{
+	return _max;
+}
+
+/**
+ * 最小値。size() == 0の場合はElmの最大値。<br>
+ */
+template<class Elm>
+inline
+Elm const& running_statistic<Elm>::min() const{
+	return _min;
+}
+
+template<class Elm>
+inline
+double running_statistic<Elm>::sum() const{
+	return _sum;
+}
+
+/**
+ * 平均。size() == 0の場合は0。<br>
+ */
+template<class Elm>
+inline
+double running_statistic<Elm>::mean() const{
+	return _mean;
+}
+
+/**
+ * 分散(偏差平方和 / n)。statistic::variance()と同じ定義。size() == 0の場合は0。<br>
+ */
+template<class Elm>
+inline
+double running_statistic<Elm>::variance() const{
+	return (_count > 0) ? _m2 / static_cast<double>(_count) : 0.;
+}
+
+/**
+ * 不偏分散(偏差平方和 / (n - 1))。size() < 2の場合は0。<br>
+ */
+template<class Elm>
+inline
+double running_statistic<Elm>::sample_variance() const{
+	return (_count > 1) ? _m2 / static_cast<double>(_count - 1) : 0.;
+}
+
+/**
+ * 標準偏差(variance()の平方根)。<br>
+ */
+template<class Elm>
+inline
+double running_statistic<Elm>::standard_deviation() const{
+	return std::sqrt(variance());
+}
+
+}
+}
+
+#endif // #ifndef LIB_MATH_RUNNING_STATISTIC_HPP_
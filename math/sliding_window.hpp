@@ -0,0 +1,193 @@
+#ifndef LIB_MATH_SLIDING_WINDOW_HPP_
+#define LIB_MATH_SLIDING_WINDOW_HPP_
+
+#include <cmath>
+#include <utility>
+#include <vector>
+#include <stdint.h>
+#include "../exception/invalid_argument.hpp"
+
+namespace lib{
+namespace math{
+
+/**
+ * 直近の一定時間に加えた値だけを集計する、小区間のリング<br>
+ * 窓をbuckets個の幅widthの小区間に分け、小区間ごとにAccumulatorを持つ。
+ * 時刻が進むと古い小区間をprototypeの状態に戻して使い回すので、値を保持し直すことはなく、
+ * メモリは小区間の数で決まる。窓の集計はsnapshot()で全小区間をmerge()して求める。<br>
+ * Accumulatorはコピー代入でき、push()とmerge()を持つ型(running_statistic、kll_sketchなど)。
+ * 例えば直近60秒の平均、分散、p99は次のように求める。<br>
+ * <pre>
+ *     lib::math::sliding_window<lib::math::running_statistic<>> moments(60, 1.);
+ *     lib::math::sliding_window<lib::math::kll_sketch<>> tail(60, 1.);
+ *
+ *     moments.push(now, latency);
+ *     tail.push(now, latency);
+ *     ...
+ *     moments.advance(now);
+ *     tail.advance(now);
+ *     double const mean= moments.snapshot().mean();
+ *     double const p99= tail.snapshot().quantile(.99);
+ * </pre>
+ * 窓の端は小区間の幅の単位で動くので、窓の長さにはwidth分の揺らぎがある。<br>
+ *
+ * @author  kamichidu
+ * @param <Accumulator> 小区間ごとの集計の型
+ */
+template<class Accumulator>
+class sliding_window{
+	public:
+		sliding_window(int buckets, double width, Accumulator const& prototype= Accumulator());
+	public:
+		template<class... Args>
+			void push(double now, Args&&... args);
+		void advance(double now);
+		void clear();
+		Accumulator snapshot() const;
+		Accumulator const& bucket(int age) const;
+		int buckets() const;
+		double width() const;
+	private:
+		int64_t bucket_id(double now) const;
+		int slot(int64_t id) const;
+	private:
+		double _width;
+		Accumulator _prototype;
+		std::vector<Accumulator> _buckets;
+		/** 最も新しい小区間の番号(時刻 / width) */
+		int64_t _head;
+		bool _started;
+};
+
+/**
+ * 空の窓を作る。窓の長さはbuckets * width。<br>
+ *
+ * @param buckets   小区間の数
+ * @param width     小区間の時間幅。時刻と同じ単位
+ * @param prototype 空の小区間の状態(kll_sketchの精度など)
+ * @throw lib::exception::invalid_argument<> bucketsかwidthが正でない場合
+ */
+template<class Accumulator>
+inline
+sliding_window<Accumulator>::sliding_window(int buckets, double width, Accumulator const& prototype) :
+	_width(width), _prototype(prototype), _buckets(), _head(0), _started(false){
+	if(buckets <= 0 || !(width > 0.))
+		throw lib::exception::invalid_argument<>(L"小区間の数と幅は正でなければなりません。");
+
+	_buckets.assign(buckets, prototype);
+}
+
+/**
+ * 時刻nowに値を加える。argsはAccumulator::push()にそのまま渡す。<br>
+ * nowが最も新しい小区間より後なら先にadvance(now)する。
+ * 窓の中の過去の時刻ならその小区間に加え、窓より古い時刻なら捨てる。<br>
+ *
+ * @param now  時刻
+ * @param args push()の引数
+ */
+template<class Accumulator>
+template<class... Args>
+inline
+void sliding_window<Accumulator>::push(double now, Args&&... args){
+	advance(now);
+
+	int64_t const id= bucket_id(now);
+
+	if(id <= _head - static_cast<int64_t>(_buckets.size()))
+		return;
+	_buckets[slot(id)].push(std::forward<Args>(args)...);
+}
+
+/**
+ * 時刻をnowまで進め、窓から外れた小区間を空にする。<br>
+ * 空にする小区間は進んだ時間の分だけ(最大でbuckets個)なので、償却O(1)。
+ * nowが最も新しい小区間より前なら何もしない。<br>
+ *
+ * @param now 時刻
+ */
+template<class Accumulator>
+inline
+void sliding_window<Accumulator>::advance(double now){
+	int64_t const id= bucket_id(now);
+
+	if(!_started){
+		_head= id;
+		_started= true;
+		return;
+	}
+	if(id <= _head)
+		return;
+
+	int64_t const steps= (id - _head < static_cast<int64_t>(_buckets.size())) ? id - _head : _buckets.size();
+
+	for(int64_t i= 1; i <= steps; ++i)
+		_buckets[slot(id - steps + i)]= _prototype;
+	_head= id;
+}
+
+/**
+ * すべての小区間を空にする。<br>
+ */
+template<class Accumulator>
+inline
+void sliding_window<Accumulator>::clear(){
+	_buckets.assign(_buckets.size(), _prototype);
+	_started= false;
+}
+
+/**
+ * 窓全体の集計。最後にadvance()またはpush()した時刻での窓を、古い小区間から順にmerge()したもの。<br>
+ */
+template<class Accumulator>
+inline
+Accumulator sliding_window<Accumulator>::snapshot() const{
+	Accumulator result= _prototype;
+	int const n= _buckets.size();
+
+	for(int age= n - 1; age >= 0; --age)
+		result.merge(bucket(age));
+
+	return result;
+}
+
+/**
+ * 小区間の集計。ageは最も新しい小区間を0として、いくつ前の小区間か。<br>
+ *
+ * @param age 0以上buckets()未満
+ */
+template<class Accumulator>
+inline
+Accumulator const& sliding_window<Accumulator>::bucket(int age) const{
+	return _buckets[slot(_head - age)];
+}
+
+template<class Accumulator>
+inline
+int sliding_window<Accumulator>::buckets() const{
+	return _buckets.size();
+}
+
+template<class Accumulator>
+inline
+double sliding_window<Accumulator>::width() const{
+	return _width;
+}
+
+template<class Accumulator>
+inline
+int64_t sliding_window<Accumulator>::bucket_id(double now) const{
+	return static_cast<int64_t>(std::floor(now / _width));
+}
+
+template<class Accumulator>
+inline
+int sliding_window<Accumulator>::slot(int64_t id) const{
+	int64_t const n= _buckets.size();
+
+	return static_cast<int>(((id % n) + n) % n);
+}
+
+}
+}
+
+#endif // #ifndef LIB_MATH_SLIDING_WINDOW_HPP_
@@ -0,0 +1,126 @@
+#ifndef LIB_MATH_SOLVER_BICGSTAB_HPP_
+#define LIB_MATH_SOLVER_BICGSTAB_HPP_
+
+#include "iterative.hpp"
+
+namespace lib{
+namespace math{
+
+/**
+ * 右前処理付きBiCGSTAB法で A*x= b を解く。<br>
+ * Aは正則であればよく、対称でなくてもよい。Aの渡し方はconjugate_gradientと同じ。<br>
+ * 1回の反復でAと前処理をそれぞれ2回ずつ適用する。
+ * 途中で内積が0になって続けられなくなった場合は、収束していなければconvergedがfalseになる。<br>
+ *
+ * @param a       係数行列(作用素)
+ * @param b       右辺
+ * @param x       初期値。解で上書きされる
+ * @param precond z= M^-1 * rを計算するapply(r, z)を持つ前処理(jacobi_preconditionerなど)
+ * @param opt     停止条件
+ * @return
+ *     反復回数と相対残差の履歴
+ * @throw lib::exception::invalid_argument<> 次元が合わない場合
+ */
+template<class Op, int N, class Elm, class Preconditioner>
+inline
+solver_result<Elm> bicgstab(Op const& a, vector<N, Elm> const& b, vector<N, Elm>& x, Preconditioner const& precond, solver_options<Elm> const& opt= solver_options<Elm>()){
+	check_dimension(b.size(), x.size());
+
+	int const n= b.size();
+	int const max_iterations= detail::max_iterations(opt, n);
+	vector<N, Elm> r(n), r0(n), p(n), v(n), s(n), t(n), ph(n), sh(n);
+	solver_result<Elm> result= {false, 0, std::vector<Elm>()};
+	Elm const bn= kernel::norm2(n, b.data(), 1);
+
+	if(bn == Elm()){
+		x= b;
+		result.converged= true;
+		result.residuals.push_back(Elm());
+		return result;
+	}
+
+	detail::residual(a, b, x, r);
+	result.residuals.push_back(kernel::norm2(n, r.data(), 1) / bn);
+	if(result.residuals.back() <= opt.tolerance){
+		result.converged= true;
+		return result;
+	}
+
+	r0= r;
+
+	Elm rho= Elm(1), alpha= Elm(1), omega= Elm(1);
+
+	while(result.iterations < max_iterations){
+		Elm const rho_next= kernel::dot(n, r0.data(), 1, r.data(), 1);
+
+		if(rho_next == Elm())
+			break;
+
+		// p= r + beta * (p - omega * v)
+		kernel::axpy(n, -omega, v.data(), 1, p.data(), 1);
+		kernel::scale(n, (rho_next / rho) * (alpha / omega), p.data(), 1);
+		kernel::axpy(n, Elm(1), r.data(), 1, p.data(), 1);
+
+		precond.apply(p, ph);
+		detail::apply_operator(a, ph, v);
+
+		Elm const r0v= kernel::dot(n, r0.data(), 1, v.data(), 1);
+
+		if(r0v == Elm())
+			break;
+		alpha= rho_next / r0v;
+
+		// s= r - alpha * v
+		s= r;
+		kernel::axpy(n, -alpha, v.data(), 1, s.data(), 1);
+		++result.iterations;
+
+		Elm const sn= kernel::norm2(n, s.data(), 1) / bn;
+
+		if(sn <= opt.tolerance){
+			kernel::axpy(n, alpha, ph.data(), 1, x.data(), 1);
+			result.residuals.push_back(sn);
+			result.converged= true;
+			break;
+		}
+
+		precond.apply(s, sh);
+		detail::apply_operator(a, sh, t);
+
+		Elm const tt= kernel::dot(n, t.data(), 1, t.data(), 1);
+
+		omega= (tt == Elm()) ? Elm() : kernel::dot(n, t.data(), 1, s.data(), 1) / tt;
+		kernel::axpy(n, alpha, ph.data(), 1, x.data(), 1);
+		kernel::axpy(n, omega, sh.data(), 1, x.data(), 1);
+
+		// r= s - omega * t
+		r= s;
+		kernel::axpy(n, -omega, t.data(), 1, r.data(), 1);
+		result.residuals.push_back(kernel::norm2(n, r.data(), 1) / bn);
+		if(result.residuals.back() <= opt.tolerance){
+			result.converged= true;
+			break;
+		}
+		if(omega == Elm())
+			break;
+		rho= rho_next;
+	}
+
+	return result;
+}
+
+/**
+ * BiCGSTAB法で A*x= b を解く。<br>
+ *
+ * @see bicgstab(Op const&, vector<N, Elm> const&, vector<N, Elm>&, Preconditioner const&, solver_options<Elm> const&)
+ */
+template<class Op, int N, class Elm>
+inline
+solver_result<Elm> bicgstab(Op const& a, vector<N, Elm> const& b, vector<N, Elm>& x, solver_options<Elm> const& opt= solver_options<Elm>()){
+	return bicgstab(a, b, x, identity_preconditioner(), opt);
+}
+
+}
+}
+
+#endif // #ifndef LIB_MATH_SOLVER_BICGSTAB_HPP_
@@ -0,0 +1,100 @@
+#ifndef LIB_MATH_SOLVER_CG_HPP_
+#define LIB_MATH_SOLVER_CG_HPP_
+
+#include "iterative.hpp"
+
+namespace lib{
+namespace math{
+
+/**
+ * 前処理付き共役勾配法で A*x= b を解く。<br>
+ * Aは対称正定値でなければならない。Aは行列を作らずy= A*xを計算できればよく、
+ * matrix、sparse_matrix、またはf(x, y)としてyにA*xを書き込む関数を渡せる。<br>
+ * 1回の反復はAの適用1回と、kernel::dot/axpyによるベクトル演算数回で済む。<br>
+ *
+ * @param a       係数行列(作用素)
+ * @param b       右辺
+ * @param x       初期値。解で上書きされる
+ * @param precond z= M^-1 * rを計算するapply(r, z)を持つ前処理(jacobi_preconditionerなど)
+ * @param opt     停止条件
+ * @return
+ *     反復回数と相対残差の履歴
+ * @throw lib::exception::invalid_argument<> 次元が合わない場合、Aが正定値でないと分かった場合
+ */
+template<class Op, int N, class Elm, class Preconditioner>
+inline
+solver_result<Elm> conjugate_gradient(Op const& a, vector<N, Elm> const& b, vector<N, Elm>& x, Preconditioner const& precond, solver_options<Elm> const& opt= solver_options<Elm>()){
+	check_dimension(b.size(), x.size());
+
+	int const n= b.size();
+	int const max_iterations= detail::max_iterations(opt, n);
+	vector<N, Elm> r(n), z(n), p(n), ap(n);
+	solver_result<Elm> result= {false, 0, std::vector<Elm>()};
+	Elm const bn= kernel::norm2(n, b.data(), 1);
+
+	if(bn == Elm()){
+		x= b;
+		result.converged= true;
+		result.residuals.push_back(Elm());
+		return result;
+	}
+
+	detail::residual(a, b, x, r);
+	result.residuals.push_back(kernel::norm2(n, r.data(), 1) / bn);
+	if(result.residuals.back() <= opt.tolerance){
+		result.converged= true;
+		return result;
+	}
+
+	precond.apply(r, z);
+	p= z;
+
+	Elm rz= kernel::dot(n, r.data(), 1, z.data(), 1);
+
+	while(result.iterations < max_iterations){
+		detail::apply_operator(a, p, ap);
+
+		Elm const pap= kernel::dot(n, p.data(), 1, ap.data(), 1);
+
+		if(!(pap > Elm()))
+			throw lib::exception::invalid_argument<>(L"正定値行列ではありません。");
+
+		Elm const alpha= rz / pap;
+
+		kernel::axpy(n, alpha, p.data(), 1, x.data(), 1);
+		kernel::axpy(n, -alpha, ap.data(), 1, r.data(), 1);
+		++result.iterations;
+		result.residuals.push_back(kernel::norm2(n, r.data(), 1) / bn);
+		if(result.residuals.back() <= opt.tolerance){
+			result.converged= true;
+			break;
+		}
+
+		precond.apply(r, z);
+
+		Elm const rz_next= kernel::dot(n, r.data(), 1, z.data(), 1);
+
+		// p= z + (rz_next / rz) * p
+		kernel::scale(n, rz_next / rz, p.data(), 1);
+		kernel::axpy(n, Elm(1), z.data(), 1, p.data(), 1);
+		rz= rz_next;
+	}
+
+	return result;
+}
+
+/**
+ * 共役勾配法で A*x= b を解く。<br>
+ *
+ * @see conjugate_gradient(Op const&, vector<N, Elm> const&, vector<N, Elm>&, Preconditioner const&, solver_options<Elm> const&)
+ */
+template<class Op, int N, class Elm>
+inline
+solver_result<Elm> conjugate_gradient(Op const& a, vector<N, Elm> const& b, vector<N, Elm>& x, solver_options<Elm> const& opt= solver_options<Elm>()){
+	return conjugate_gradient(a, b, x, identity_preconditioner(), opt);
+}
+
+}
+}
+
+#endif // #ifndef LIB_MATH_SOLVER_CG_HPP_
@@ -0,0 +1,205 @@
+#ifndef LIB_MATH_SOLVER_ITERATIVE_HPP_
+#define LIB_MATH_SOLVER_ITERATIVE_HPP_
+
+#include <cmath>
+#include <limits>
+#include <vector>
+#include "../../exception/invalid_argument.hpp"
+#include "../dimension.hpp"
+#include "../vector.hpp"
+#include "../matrix.hpp"
+#include "../sparse_matrix.hpp"
+#include "../kernel/level1.hpp"
+#include "../kernel/level2.hpp"
+
+namespace lib{
+namespace math{
+
+/**
+ * 反復法の停止条件。<br>
+ *
+ * @param <Elm> 要素の型
+ */
+template<class Elm= double>
+struct solver_options{
+	/** 相対残差 ||b - A*x|| / ||b|| がこの値以下になったら収束とみなす */
+	Elm tolerance;
+	/** 反復回数の上限。0以下なら方程式の次数の2倍 */
+	int max_iterations;
+
+	solver_options() : tolerance(std::sqrt(std::numeric_limits<Elm>::epsilon())), max_iterations(0){}
+	solver_options(Elm tolerance, int max_iterations) : tolerance(tolerance), max_iterations(max_iterations){}
+};
+
+/**
+ * 反復法の結果。<br>
+ *
+ * @param <Elm> 要素の型
+ */
+template<class Elm= double>
+struct solver_result{
+	/** 収束したか */
+	bool converged;
+	/** 行った反復回数 */
+	int iterations;
+	/** 初期値と各反復後の相対残差。iterations + 1個の要素を持つ */
+	std::vector<Elm> residuals;
+};
+
+/**
+ * 前処理を行わない前処理。z= r。<br>
+ */
+struct identity_preconditioner{
+	template<int N, class Elm>
+		void apply(vector<N, Elm> const& r, vector<N, Elm>& z) const{ z= r; }
+};
+
+/**
+ * ヤコビ(対角スケーリング)前処理。z= D^-1 * r。<br>
+ * 対角要素の大きさがばらついている場合に反復回数を減らせる。<br>
+ *
+ * @author  kamichidu
+ * @param <Elm> 要素の型
+ */
+template<class Elm= double>
+class jacobi_preconditioner{
+	public:
+		template<int N, int M>
+			explicit jacobi_preconditioner(matrix<N, M, Elm> const& a);
+		template<sparse_format Format>
+			explicit jacobi_preconditioner(sparse_matrix<Elm, Format> const& a);
+		template<int N>
+			explicit jacobi_preconditioner(vector<N, Elm> const& diagonal);
+	public:
+		template<int N>
+			void apply(vector<N, Elm> const& r, vector<N, Elm>& z) const;
+		int size() const;
+	private:
+		void invert();
+	private:
+		vector<dynamic, Elm> _inv;
+};
+
+/**
+ * 密行列の対角要素から作る。<br>
+ *
+ * @throw lib::exception::invalid_argument<> 正方行列でない場合、対角要素に0がある場合
+ */
+template<class Elm>
+template<int N, int M>
+inline
+jacobi_preconditioner<Elm>::jacobi_preconditioner(matrix<N, M, Elm> const& a) : _inv(a.rows()){
+	check_dimension(a.rows(), a.cols());
+
+	for(int i= 0; i < a.rows(); ++i)
+		_inv[i]= a.element(i, i);
+	invert();
+}
+
+/**
+ * 疎行列の対角要素から作る。<br>
+ *
+ * @throw lib::exception::invalid_argument<> 正方行列でない場合、対角要素に0がある場合
+ */
+template<class Elm>
+template<sparse_format Format>
+inline
+jacobi_preconditioner<Elm>::jacobi_preconditioner(sparse_matrix<Elm, Format> const& a) : _inv(a.rows()){
+	check_dimension(a.rows(), a.cols());
+
+	for(int i= 0; i < a.rows(); ++i)
+		_inv[i]= a(i, i);
+	invert();
+}
+
+/**
+ * 対角要素を直接与える。作用素をコールバックで与える場合向け。<br>
+ *
+ * @throw lib::exception::invalid_argument<> 0の要素がある場合
+ */
+template<class Elm>
+template<int N>
+inline
+jacobi_preconditioner<Elm>::jacobi_preconditioner(vector<N, Elm> const& diagonal) : _inv(diagonal){
+	invert();
+}
+
+/**
+ * z= D^-1 * r を計算する。<br>
+ *
+ * @throw lib::exception::invalid_argument<> 次元が合わない場合
+ */
+template<class Elm>
+template<int N>
+inline
+void jacobi_preconditioner<Elm>::apply(vector<N, Elm> const& r, vector<N, Elm>& z) const{
+	check_dimension(size(), r.size());
+
+	kernel::multiply(size(), _inv.data(), 1, r.data(), 1, z.data(), 1);
+}
+
+template<class Elm>
+inline
+int jacobi_preconditioner<Elm>::size() const{
+	return _inv.size();
+}
+
+template<class Elm>
+inline
+void jacobi_preconditioner<Elm>::invert(){
+	for(int i= 0; i < _inv.size(); ++i){
+		if(_inv[i] == Elm())
+			throw lib::exception::invalid_argument<>(L"対角要素に0があります。");
+		_inv[i]= Elm(1) / _inv[i];
+	}
+}
+
+namespace detail{
+
+/**
+ * y= A*x を計算する。Aは密行列、疎行列、またはf(x, y)としてy= A*xを書き込む関数。<br>
+ */
+template<int N, int M, class Elm, int K>
+inline
+void apply_operator(matrix<N, M, Elm> const& a, vector<K, Elm> const& x, vector<K, Elm>& y){
+	check_dimension(a.cols(), x.size());
+	check_dimension(a.rows(), y.size());
+
+	kernel::gemv(a.rows(), a.cols(), Elm(1), a.data(), a.cols(), x.data(), 1, Elm(), y.data(), 1);
+}
+
+template<class Elm, sparse_format Format, int K>
+inline
+void apply_operator(sparse_matrix<Elm, Format> const& a, vector<K, Elm> const& x, vector<K, Elm>& y){
+	y= a * x;
+}
+
+template<class F, int K, class Elm>
+inline
+void apply_operator(F const& f, vector<K, Elm> const& x, vector<K, Elm>& y){
+	f(x, y);
+}
+
+/**
+ * r= b - A*x を計算する。<br>
+ */
+template<class Op, int N, class Elm>
+inline
+void residual(Op const& a, vector<N, Elm> const& b, vector<N, Elm> const& x, vector<N, Elm>& r){
+	apply_operator(a, x, r);
+	kernel::scale(r.size(), Elm(-1), r.data(), 1);
+	kernel::axpy(r.size(), Elm(1), b.data(), 1, r.data(), 1);
+}
+
+template<class Elm>
+inline
+int max_iterations(solver_options<Elm> const& opt, int n){
+	return (opt.max_iterations > 0) ? opt.max_iterations : 2 * n;
+}
+
+}
+
+}
+}
+
+#endif // #ifndef LIB_MATH_SOLVER_ITERATIVE_HPP_
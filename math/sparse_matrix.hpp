@@ -0,0 +1,535 @@
+#ifndef LIB_MATH_SPARSE_MATRIX_HPP_
+#define LIB_MATH_SPARSE_MATRIX_HPP_
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include "dimension.hpp"
+#include "matrix.hpp"
+#include "vector.hpp"
+#include "kernel/level1.hpp"
+#include "../memory/aligned_allocator.hpp"
+#include "../thread/pool.hpp"
+
+namespace lib{
+namespace math{
+
+/**
+ * 疎行列の圧縮形式。<br>
+ */
+enum sparse_format{
+	csr, ///< 行ごとに圧縮(Compressed Sparse Row)
+	csc, ///< 列ごとに圧縮(Compressed Sparse Column)
+};
+
+/**
+ * 疎行列を組み立てるための(行, 列, 値)の組。<br>
+ */
+template<class Elm= double>
+struct triplet{
+	int row;
+	int col;
+	Elm value;
+};
+
+namespace detail{
+
+/**
+ * この非零要素数以上の積は複数スレッドで計算する。<br>
+ */
+static std::size_t const sparse_parallel_threshold= 1 << 16;
+
+/**
+ * cscの積で作業領域を合わせる時に、1回のkernel::axpyで扱う要素数。<br>
+ */
+static std::size_t const sparse_sum_chunk= 1 << 30;
+
+/**
+ * [0, n)をnum_blocks個に分け、各ブロックについてf(first, last)をthread::default_pool()で並列に実行する。<br>
+ * 分割位置はbounds(i)で与える(bounds(0) == 0, bounds(num_blocks) == n)。<br>
+ */
+template<class Bounds, class F>
+inline
+void sparse_parallel_blocks(int num_blocks, Bounds const& bounds, F const& f){
+	if(num_blocks <= 1){
+		f(bounds(0), bounds(1));
+		return;
+	}
+
+	thread::default_pool().parallel_for(0, num_blocks, 1, [&](int b0, int b1){
+		for(int b= b0; b < b1; ++b)
+			f(bounds(b), bounds(b + 1));
+	});
+}
+}
+
+/**
+ * 圧縮形式の疎行列クラス。<br>
+ * Formatがcsrの場合は行ごと、cscの場合は列ごとに、非零要素の位置と値を保持する。<br>
+ * 外側の添字o(csrなら行、cscなら列)の要素は[pointers()[o], pointers()[o + 1])の
+ * 範囲にあり、内側の添字(csrなら列、cscなら行)の昇順に並ぶ。<br>
+ * 密ベクトル・密行列との積は、非零要素数が多い場合に複数スレッドで計算する。
+ * csrは行ブロックごとに結果の別々の行へ書き込む。cscは列ブロックごとに結果と同じ大きさの
+ * 作業領域へ足し込み、最後に合わせるので、スレッド数×結果の大きさの一時領域を使う。<br>
+ *
+ * @author  kamichidu
+ * @param <Elm>    要素の型
+ * @param <Format> 圧縮形式
+ */
+template<class Elm= double, sparse_format Format= csr>
+class sparse_matrix{
+	public:
+		typedef Elm value_type;
+
+		static sparse_format const format= Format;
+	public:
+		sparse_matrix();
+		sparse_matrix(int rows, int cols);
+		template<class InputIterator>
+			sparse_matrix(int rows, int cols, InputIterator first, InputIterator last);
+		template<int N, int M>
+			explicit sparse_matrix(matrix<N, M, Elm> const& dense);
+		template<sparse_format F>
+			explicit sparse_matrix(sparse_matrix<Elm, F> const& obj);
+	public:
+		int rows() const;
+		int cols() const;
+		int non_zeros() const;
+		Elm operator () (int row, int col) const;
+		template<int N>
+			vector<dynamic, Elm> const operator * (vector<N, Elm> const& x) const;
+		template<int N, int M>
+			matrix<dynamic, dynamic, Elm> const operator * (matrix<N, M, Elm> const& x) const;
+		template<int N= dynamic, int M= dynamic>
+			matrix<N, M, Elm> to_dense() const;
+		int const* pointers() const;
+		int const* indices() const;
+		Elm const* values() const;
+	private:
+		int outer_size() const;
+		int inner_size() const;
+		template<class F>
+			void column_blocks(int num_blocks, std::size_t size, Elm* out, F const& f) const;
+		int parallel_blocks() const;
+		int outer_bound(int block, int num_blocks) const;
+	private:
+		int _rows;
+		int _cols;
+		std::vector<int> _pointers;
+		std::vector<int> _indices;
+		std::vector<Elm> _values;
+};
+
+/**
+ * csr_matrix<Elm>はsparse_matrix<Elm, csr>の別名。<br>
+ */
+template<class Elm= double>
+using csr_matrix= sparse_matrix<Elm, csr>;
+
+/**
+ * csc_matrix<Elm>はsparse_matrix<Elm, csc>の別名。<br>
+ */
+template<class Elm= double>
+using csc_matrix= sparse_matrix<Elm, csc>;
+
+/**
+ * 0行0列で初期化する。<br>
+ */
+template<class Elm, sparse_format Format>
+inline
+sparse_matrix<Elm, Format>::sparse_matrix() : _rows(0), _cols(0), _pointers(1, 0){
+}
+
+/**
+ * rows行cols列の零行列で初期化する。<br>
+ */
+template<class Elm, sparse_format Format>
+inline
+sparse_matrix<Elm, Format>::sparse_matrix(int rows, int cols) : _rows(rows), _cols(cols), _pointers(outer_size() + 1, 0){
+}
+
+/**
+ * triplet<Elm>の列から組み立てる。<br>
+ * 同じ位置の要素が複数ある場合は和をとる。順序は任意でよい。<br>
+ *
+ * @param rows  行数
+ * @param cols  列数
+ * @param first triplet<Elm>の列の先頭
+ * @param last  triplet<Elm>の列の終端
+ * @throw lib::exception::invalid_argument<> 位置が範囲外の要素がある場合
+ */
+template<class Elm, sparse_format Format>
+template<class InputIterator>
+inline
+sparse_matrix<Elm, Format>::sparse_matrix(int rows, int cols, InputIterator first, InputIterator last) : _rows(rows), _cols(cols){
+	std::vector<triplet<Elm>> const entries(first, last);
+	int const outer= outer_size();
+
+	// 外側の添字ごとに数え上げて振り分ける
+	std::vector<int> counts(outer + 1, 0);
+	for(auto const& e : entries){
+		if(e.row < 0 || e.row >= rows || e.col < 0 || e.col >= cols)
+			throw lib::exception::invalid_argument<>(L"範囲外の要素が指定されました。");
+
+		++counts[(Format == csr ? e.row : e.col) + 1];
+	}
+	for(int o= 0; o < outer; ++o)
+		counts[o + 1]+= counts[o];
+
+	std::vector<std::pair<int, Elm>> buf(entries.size());
+	{
+		std::vector<int> cursor(counts.begin(), counts.end() - 1);
+
+		for(auto const& e : entries){
+			int const o= (Format == csr) ? e.row : e.col;
+			int const in= (Format == csr) ? e.col : e.row;
+
+			buf[cursor[o]++]= std::make_pair(in, e.value);
+		}
+	}
+
+	// 内側の添字で整列し、重複をまとめる
+	_pointers.assign(outer + 1, 0);
+	_indices.reserve(buf.size());
+	_values.reserve(buf.size());
+	for(int o= 0; o < outer; ++o){
+		auto const seg_first= buf.begin() + counts[o];
+		auto const seg_last= buf.begin() + counts[o + 1];
+
+		std::sort(seg_first, seg_last, [](std::pair<int, Elm> const& l, std::pair<int, Elm> const& r){ return l.first < r.first; });
+		for(auto it= seg_first; it != seg_last; ++it){
+			if(static_cast<int>(_indices.size()) > _pointers[o] && _indices.back() == it->first)
+				_values.back()+= it->second;
+			else{
+				_indices.push_back(it->first);
+				_values.push_back(it->second);
+			}
+		}
+		_pointers[o + 1]= static_cast<int>(_indices.size());
+	}
+}
+
+/**
+ * 密行列の非零要素から組み立てる。<br>
+ *
+ * @param dense 密行列
+ */
+template<class Elm, sparse_format Format>
+template<int N, int M>
+inline
+sparse_matrix<Elm, Format>::sparse_matrix(matrix<N, M, Elm> const& dense) : _rows(dense.rows()), _cols(dense.cols()){
+	int const outer= outer_size();
+	int const inner= inner_size();
+
+	_pointers.assign(outer + 1, 0);
+	for(int o= 0; o < outer; ++o){
+		for(int in= 0; in < inner; ++in){
+			Elm const& v= (Format == csr) ? dense.element(o, in) : dense.element(in, o);
+
+			if(!(v == Elm())){
+				_indices.push_back(in);
+				_values.push_back(v);
+			}
+		}
+		_pointers[o + 1]= static_cast<int>(_indices.size());
+	}
+}
+
+/**
+ * 別の圧縮形式から変換する。<br>
+ *
+ * @param obj 変換元
+ */
+template<class Elm, sparse_format Format>
+template<sparse_format F>
+inline
+sparse_matrix<Elm, Format>::sparse_matrix(sparse_matrix<Elm, F> const& obj) : _rows(obj.rows()), _cols(obj.cols()){
+	int const src_outer= (F == csr) ? obj.rows() : obj.cols();
+	int const outer= outer_size();
+	int const nnz= obj.non_zeros();
+
+	if(F == Format){
+		_pointers.assign(obj.pointers(), obj.pointers() + outer + 1);
+		_indices.assign(obj.indices(), obj.indices() + nnz);
+		_values.assign(obj.values(), obj.values() + nnz);
+		return;
+	}
+
+	// 転置と同じ手順で外側と内側を入れ替える。元の外側の昇順に走査するので内側は整列済みになる
+	_pointers.assign(outer + 1, 0);
+	_indices.resize(nnz);
+	_values.resize(nnz);
+	for(int k= 0; k < nnz; ++k)
+		++_pointers[obj.indices()[k] + 1];
+	for(int o= 0; o < outer; ++o)
+		_pointers[o + 1]+= _pointers[o];
+
+	std::vector<int> cursor(_pointers.begin(), _pointers.end() - 1);
+	for(int so= 0; so < src_outer; ++so){
+		for(int k= obj.pointers()[so]; k < obj.pointers()[so + 1]; ++k){
+			int const dest= cursor[obj.indices()[k]]++;
+
+			_indices[dest]= so;
+			_values[dest]= obj.values()[k];
+		}
+	}
+}
+
+template<class Elm, sparse_format Format>
+inline
+int sparse_matrix<Elm, Format>::rows() const{
+	return _rows;
+}
+
+template<class Elm, sparse_format Format>
+inline
+int sparse_matrix<Elm, Format>::cols() const{
+	return _cols;
+}
+
+template<class Elm, sparse_format Format>
+inline
+int sparse_matrix<Elm, Format>::non_zeros() const{
+	return static_cast<int>(_values.size());
+}
+
+/**
+ * 要素を取り出す。格納されていない要素は0を返す。<br>
+ * 内側の添字を二分探索するため、走査には向かない。<br>
+ *
+ * @param row 行
+ * @param col 列
+ * @return
+ *     row行col列の要素
+ */
+template<class Elm, sparse_format Format>
+inline
+Elm sparse_matrix<Elm, Format>::operator () (int row, int col) const{
+	int const o= (Format == csr) ? row : col;
+	int const in= (Format == csr) ? col : row;
+	int const* const first= _indices.data() + _pointers[o];
+	int const* const last= _indices.data() + _pointers[o + 1];
+	int const* const it= std::lower_bound(first, last, in);
+
+	if(it != last && *it == in)
+		return _values[it - _indices.data()];
+
+	return Elm();
+}
+
+/**
+ * 密ベクトルとの積 y= A*x を計算する。<br>
+ *
+ * @param x cols()次元のベクトル
+ * @return
+ *     rows()次元のベクトル
+ */
+template<class Elm, sparse_format Format>
+template<int N>
+inline
+vector<dynamic, Elm> const sparse_matrix<Elm, Format>::operator * (vector<N, Elm> const& x) const{
+	check_dimension(cols(), x.size());
+
+	vector<dynamic, Elm> y(rows());
+	Elm const* const xp= x.data();
+	Elm* const yp= y.data();
+	int const num_blocks= parallel_blocks();
+
+	if(Format == csc){
+		column_blocks(num_blocks, rows(), yp, [&](int first, int last, Elm* out){
+			for(int j= first; j < last; ++j)
+				for(int k= _pointers[j]; k < _pointers[j + 1]; ++k)
+					out[_indices[k]]+= _values[k] * xp[j];
+		});
+		return y;
+	}
+
+	detail::sparse_parallel_blocks(num_blocks,
+		[&](int b){ return outer_bound(b, num_blocks); },
+		[&](int first, int last){
+			for(int i= first; i < last; ++i){
+				Elm acc= Elm();
+
+				for(int k= _pointers[i]; k < _pointers[i + 1]; ++k)
+					acc+= _values[k] * xp[_indices[k]];
+				yp[i]= acc;
+			}
+		});
+
+	return y;
+}
+
+/**
+ * 密行列との積 C= A*B を計算する。<br>
+ * Aの非零要素ごとに、Bの1行をCの1行へaxpyで加える。<br>
+ *
+ * @param x cols()行の行列
+ * @return
+ *     rows()行x.cols()列の行列
+ */
+template<class Elm, sparse_format Format>
+template<int N, int M>
+inline
+matrix<dynamic, dynamic, Elm> const sparse_matrix<Elm, Format>::operator * (matrix<N, M, Elm> const& x) const{
+	check_dimension(cols(), x.rows());
+
+	int const m= x.cols();
+	matrix<dynamic, dynamic, Elm> c(rows(), m);
+	Elm const* const bp= x.data();
+	Elm* const cp= c.data();
+	int const num_blocks= parallel_blocks();
+
+	if(Format == csc){
+		column_blocks(num_blocks, static_cast<std::size_t>(rows()) * m, cp, [&](int first, int last, Elm* out){
+			for(int j= first; j < last; ++j)
+				for(int k= _pointers[j]; k < _pointers[j + 1]; ++k)
+					kernel::axpy(m, _values[k], bp + static_cast<std::size_t>(j) * m, 1, out + static_cast<std::size_t>(_indices[k]) * m, 1);
+		});
+		return c;
+	}
+
+	detail::sparse_parallel_blocks(num_blocks,
+		[&](int b){ return outer_bound(b, num_blocks); },
+		[&](int first, int last){
+			for(int i= first; i < last; ++i)
+				for(int k= _pointers[i]; k < _pointers[i + 1]; ++k)
+					kernel::axpy(m, _values[k], bp + static_cast<std::size_t>(_indices[k]) * m, 1, cp + static_cast<std::size_t>(i) * m, 1);
+		});
+
+	return c;
+}
+
+/**
+ * 密行列に変換する。<br>
+ *
+ * @param <N> 行数(dynamicなら実行時の行数)
+ * @param <M> 列数(dynamicなら実行時の列数)
+ * @return
+ *     同じ要素を持つ密行列
+ */
+template<class Elm, sparse_format Format>
+template<int N, int M>
+inline
+matrix<N, M, Elm> sparse_matrix<Elm, Format>::to_dense() const{
+	matrix<N, M, Elm> buf(rows(), cols());
+	Elm* const dest= buf.data();
+
+	for(int o= 0; o < outer_size(); ++o){
+		for(int k= _pointers[o]; k < _pointers[o + 1]; ++k){
+			int const i= (Format == csr) ? o : _indices[k];
+			int const j= (Format == csr) ? _indices[k] : o;
+
+			dest[static_cast<std::size_t>(i) * cols() + j]= _values[k];
+		}
+	}
+
+	return buf;
+}
+
+/**
+ * 外側の添字ごとの開始位置。outer_size() + 1個の要素を持つ。<br>
+ */
+template<class Elm, sparse_format Format>
+inline
+int const* sparse_matrix<Elm, Format>::pointers() const{
+	return _pointers.data();
+}
+
+/**
+ * 非零要素の内側の添字。<br>
+ */
+template<class Elm, sparse_format Format>
+inline
+int const* sparse_matrix<Elm, Format>::indices() const{
+	return _indices.data();
+}
+
+/**
+ * 非零要素の値。<br>
+ */
+template<class Elm, sparse_format Format>
+inline
+Elm const* sparse_matrix<Elm, Format>::values() const{
+	return _values.data();
+}
+
+template<class Elm, sparse_format Format>
+inline
+int sparse_matrix<Elm, Format>::outer_size() const{
+	return (Format == csr) ? _rows : _cols;
+}
+
+template<class Elm, sparse_format Format>
+inline
+int sparse_matrix<Elm, Format>::inner_size() const{
+	return (Format == csr) ? _cols : _rows;
+}
+
+/**
+ * 列をnum_blocks個に分け、f(先頭列, 終端列, 出力)を並列に呼ぶ。csc用。<br>
+ * 先頭のブロックはoutへ、それ以外はブロックごとに0で初期化したsize要素の作業領域へ足し込み、
+ * 最後に作業領域をoutへ加える。各非零要素は1回だけ走査する。<br>
+ */
+template<class Elm, sparse_format Format>
+template<class F>
+inline
+void sparse_matrix<Elm, Format>::column_blocks(int num_blocks, std::size_t size, Elm* out, F const& f) const{
+	if(num_blocks <= 1){
+		f(0, _cols, out);
+		return;
+	}
+
+	std::vector<Elm, memory::aligned_allocator<Elm>> partial(static_cast<std::size_t>(num_blocks - 1) * size);
+
+	thread::default_pool().parallel_for(0, num_blocks, 1, [&](int b0, int b1){
+		for(int b= b0; b < b1; ++b)
+			f(outer_bound(b, num_blocks), outer_bound(b + 1, num_blocks), (b == 0) ? out : partial.data() + (b - 1) * size);
+	});
+	for(int b= 1; b < num_blocks; ++b){
+		Elm const* const p= partial.data() + (b - 1) * size;
+
+		for(std::size_t first= 0; first < size; first+= detail::sparse_sum_chunk)
+			kernel::axpy(static_cast<int>(std::min<std::size_t>(size - first, detail::sparse_sum_chunk)), Elm(1), p + first, 1, out + first, 1);
+	}
+}
+
+/**
+ * 積の計算で外側の添字を分けるブロック数。<br>
+ * cscはブロックごとに結果と同じ大きさの作業領域を使うので、並列度と同じ数に抑える。<br>
+ */
+template<class Elm, sparse_format Format>
+inline
+int sparse_matrix<Elm, Format>::parallel_blocks() const{
+	if(_values.size() < detail::sparse_parallel_threshold)
+		return 1;
+
+	int const concurrency= thread::default_pool().concurrency();
+
+	if(concurrency <= 1)
+		return 1;
+
+	// csrは盗み合いで負荷を均せるよう、並列度より多めに分ける
+	int const blocks= (Format == csr) ? 4 * concurrency : concurrency;
+
+	return std::max(1, std::min(blocks, outer_size()));
+}
+
+/**
+ * block番目のブロックの先頭の外側の添字(csrなら行、cscなら列)。<br>
+ * 非零要素数がほぼ均等になるように分ける。<br>
+ */
+template<class Elm, sparse_format Format>
+inline
+int sparse_matrix<Elm, Format>::outer_bound(int block, int num_blocks) const{
+	if(block >= num_blocks)
+		return outer_size();
+
+	long long const target= static_cast<long long>(_values.size()) * block / num_blocks;
+
+	return static_cast<int>(std::lower_bound(_pointers.begin(), _pointers.end(), target) - _pointers.begin());
+}
+
+}
+}
+
+#endif // #ifndef LIB_MATH_SPARSE_MATRIX_HPP_
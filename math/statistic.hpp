@@ -6,12 +6,49 @@
 #include <memory>
 #include <map>
 #include <algorithm>
+#include <stdexcept>
+#include "../exception/invalid_argument.hpp"
+#include "../thread/pool.hpp"
+#include "kernel/moments.hpp"
+#include "view.hpp"
 
 namespace lib{
 namespace math{
 
+namespace detail{
+
+/**
+ * 和などの畳み込みを並列に計算する範囲の大きさ。<br>
+ */
+static int const statistic_parallel_grain= 1 << 15;
+
+/**
+ * 間隔strideで並んだn個の値の和、平均、偏差平方和を求める。<br>
+ * 範囲ごとにkernel::momentsで求めた結果を順に合わせるので、結果はスレッド数によらない。
+ * statistic_parallel_grain個以下ならスレッドプールを使わず、メモリも確保しない。<br>
+ */
+template<class Elm>
+inline
+kernel::moments_result statistic_moments(Elm const* data, int n, int stride){
+	if(n <= statistic_parallel_grain)
+		return kernel::moments(n, data, stride);
+
+	kernel::moments_result const identity= {0., 0., 0., 0.};
+
+	return thread::parallel_reduce(0, n, statistic_parallel_grain, identity,
+		[&](int first, int last){ return kernel::moments(last - first, data + static_cast<long>(first) * stride, stride); },
+		[](kernel::moments_result const& l, kernel::moments_result const& r){ return kernel::merge_moments(l, r); });
+}
+
+}
+
 /**
  *	統計処理クラス。.<br>
+ *	入力をすべて保持するので、平均や分散だけが必要な場合はrunning_statisticを、
+ *	保持しきれない量の分位数を求める場合はkll_sketchを使う。<br>
+ *	構築時には並べ替えず、中央値や分位数はnth_elementで必要な順位だけを確定させる。
+ *	全体を並べ替えるのはmode()のように全順序が要る場合だけで、一度並べ替えた後はそれを使う。<br>
+ *	そのためconstのメンバ関数も内部の並び順を変えることがあり、同じオブジェクトを複数のスレッドから同時に使ってはいけない。<br>
  *
  *	@version 2012-05-22 (火)
  *	@author  kamichidu
@@ -22,6 +59,7 @@ class statistic{
 		template<class InputIterator>
 			statistic(InputIterator first, InputIterator last);
 		statistic(std::initializer_list<Elm> const& init);
+		explicit statistic(vector_view<Elm const> const& v);
 		explicit statistic(statistic const& obj);
 		~statistic();
 	public:
@@ -32,28 +70,60 @@ class statistic{
 		double mean() const;
 		Elm const& mode() const;
 		double median() const;
+		double quantile(double p) const;
+		std::vector<double> quantiles(std::vector<double> const& ps) const;
 		double variance() const;
 		double standard_deviation() const;
+	private:
+		void init();
+		void sort() const;
+		kernel::moments_result const& moments() const;
+		void select(typename std::vector<Elm>::iterator first, typename std::vector<Elm>::iterator last,
+			std::vector<int>::const_iterator rfirst, std::vector<int>::const_iterator rlast) const;
 	private:
 		typedef std::unique_ptr<std::vector<Elm>> lp_vector;
 		lp_vector _data;
+		Elm _min;
+		Elm _max;
+		mutable bool _sorted;
+		mutable bool _has_moments;
+		mutable kernel::moments_result _moments;
 };
 
 template<class Elm>
 template<class InputIterator>
 inline
 statistic<Elm>::statistic(InputIterator first, InputIterator last) : 
-	_data(lp_vector(new std::vector<Elm>(first, last))){
-	
-	std::sort(_data->begin(), _data->end());
+	_data(lp_vector(new std::vector<Elm>(first, last))), _min(), _max(), _sorted(false), _has_moments(false), _moments(){
+
+	init();
 }
 
 template<class Elm>
 inline
 statistic<Elm>::statistic(std::initializer_list<Elm> const& init) : 
-	_data(lp_vector(new std::vector<Elm>(init.begin(), init.end()))){
+	_data(lp_vector(new std::vector<Elm>(init.begin(), init.end()))), _min(), _max(), _sorted(false), _has_moments(false), _moments(){
 
-	std::sort(_data->begin(), _data->end());
+	this->init();
+}
+
+/**
+ * ビューの要素を写して作る。間隔の空いた列なども詰めて保持する。<br>
+ */
+template<class Elm>
+inline
+statistic<Elm>::statistic(vector_view<Elm const> const& v) :
+	_data(lp_vector(new std::vector<Elm>(v.size()))), _min(), _max(), _sorted(false), _has_moments(false), _moments(){
+
+	for(int i= 0; i < v.size(); ++i)
+		(*_data)[i]= v[i];
+	init();
+}
+
+template<class Elm>
+inline
+statistic<Elm>::statistic(statistic const& obj) :
+	_data(lp_vector(new std::vector<Elm>(*obj._data))), _min(obj._min), _max(obj._max), _sorted(obj._sorted), _has_moments(obj._has_moments), _moments(obj._moments){
 }
 
 template<class Elm>
@@ -71,58 +141,143 @@ int statistic<Elm>::size() const{
 template<class Elm>
 inline
 Elm const& statistic<Elm>::max() const{
-	return _data->back();
+	return _max;
 }
 
 template<class Elm>
 inline
 Elm const& statistic<Elm>::min() const{
-	return _data->front();
+	return _min;
 }
 
 template<class Elm>
 inline
 double statistic<Elm>::sum() const{
-	double sum;
-
-	sum= 0.;
-	for(auto const& elm : *_data)
-		sum+= elm;
-
-	return sum;
+	return moments().sum;
 }
 
 template<class Elm>
 inline
 double statistic<Elm>::mean() const{
-	return sum() / static_cast<double>(size());
+	return moments().mean;
 }
 
+/**
+ * 最頻値。最も多く現れる値が複数ある場合は、そのうち最小のもの。<br>
+ * 全体を並べ替える。<br>
+ *
+ * @throw std::out_of_range 要素がない場合
+ */
+template<class Elm>
+inline
+Elm const& statistic<Elm>::mode() const{
+	if(_data->empty())
+		throw std::out_of_range("lib::math::statistic");
+
+	sort();
+
+	std::vector<Elm> const& data= *_data;
+	int best= 0, best_count= 0;
+
+	for(int i= 0; i < size(); ){
+		int j= i + 1;
+
+		while(j < size() && !(data[i] < data[j]))
+			++j;
+		if(j - i > best_count){
+			best= i;
+			best_count= j - i;
+		}
+		i= j;
+	}
+
+	return data[best];
+}
+
+/**
+ * 中央値。要素数が偶数の場合は中央の2つの平均。<br>
+ *
+ * @throw std::out_of_range 要素がない場合
+ */
 template<class Elm>
 inline
 double statistic<Elm>::median() const{
-	double const med= _data->at(size() / 2);
+	return quantile(.5);
+}
 
-	if(size() % 2 == 0)
-		return (med + _data->at(size() / 2 + 1)) / 2.;
+/**
+ * p分位数。並べ替えた列の(size() - 1) * p番目の値を、前後の要素から線形補間して求める。<br>
+ * quantile(0)はmin()、quantile(1)はmax()、quantile(.5)はmedian()と同じ。<br>
+ * 並べ替え済みでなければ、nth_elementで必要な2つの順位だけを確定させるのでO(n)で済む。<br>
+ *
+ * @param p 0以上1以下の割合
+ * @throw lib::exception::invalid_argument<> pが範囲外の場合
+ * @throw std::out_of_range 要素がない場合
+ */
+template<class Elm>
+inline
+double statistic<Elm>::quantile(double p) const{
+	return quantiles(std::vector<double>(1, p)).front();
+}
 
-	return med;
+/**
+ * 複数のp分位数をまとめて求める。<br>
+ * 必要な順位を並べ、中央の順位でnth_elementした左右にそれぞれ残りの順位を割り振るので、
+ * q個の分位数に対してO(n log q)で済む。quantile()をq回呼ぶより速い。<br>
+ *
+ * @param ps 0以上1以下の割合の列
+ * @return
+ *     psと同じ順の分位数
+ * @throw lib::exception::invalid_argument<> 範囲外の割合がある場合
+ * @throw std::out_of_range 要素がない場合
+ * @see quantile(double)
+ */
+template<class Elm>
+inline
+std::vector<double> statistic<Elm>::quantiles(std::vector<double> const& ps) const{
+	for(double p : ps){
+		if(!(p >= 0. && p <= 1.))
+			throw lib::exception::invalid_argument<>(L"割合は0以上1以下でなければなりません。");
+	}
+	if(_data->empty())
+		throw std::out_of_range("lib::math::statistic");
+
+	int const n= size();
+	std::vector<int> ranks;
+
+	ranks.reserve(2 * ps.size());
+	for(double p : ps){
+		int const lo= static_cast<int>(std::floor(p * (n - 1)));
+
+		ranks.push_back(lo);
+		if(lo + 1 < n)
+			ranks.push_back(lo + 1);
+	}
+	std::sort(ranks.begin(), ranks.end());
+	ranks.erase(std::unique(ranks.begin(), ranks.end()), ranks.end());
+
+	if(!_sorted)
+		select(_data->begin(), _data->end(), ranks.begin(), ranks.end());
+
+	std::vector<Elm> const& data= *_data;
+	std::vector<double> result;
+
+	result.reserve(ps.size());
+	for(double p : ps){
+		double const h= p * (n - 1);
+		int const lo= static_cast<int>(std::floor(h));
+		double const x= data[lo];
+
+		result.push_back((lo + 1 < n) ? x + (h - lo) * (static_cast<double>(data[lo + 1]) - x) : x);
+	}
+
+	return result;
 }
 
 template<class Elm>
 inline
 double statistic<Elm>::variance() const{
-	double average, variance;
-	
-	average= mean();
-	
-	variance= 0.0;
-	for(auto const& elm : *_data){
-		variance+= (elm - average) * (elm - average);
-	}
-	variance/= static_cast<double>(_data->size());
-	
-	return variance;
+	return moments().m2 / static_cast<double>(_data->size());
 }
 
 template<class Elm>
@@ -131,6 +286,266 @@ double statistic<Elm>::standard_deviation() const{
 	return sqrt(variance());
 }
 
+/**
+ * 最小値と最大値を1回の走査で求めておく。<br>
+ */
+template<class Elm>
+inline
+void statistic<Elm>::init(){
+	if(_data->empty())
+		return;
+
+	auto const mm= std::minmax_element(_data->begin(), _data->end());
+
+	_min= *mm.first;
+	_max= *mm.second;
+}
+
+/**
+ * 和、平均、偏差平方和を1回の走査で求め、以降はそれを使う。<br>
+ */
+template<class Elm>
+inline
+kernel::moments_result const& statistic<Elm>::moments() const{
+	if(_has_moments)
+		return _moments;
+
+	_moments= detail::statistic_moments(_data->data(), size(), 1);
+	_has_moments= true;
+
+	return _moments;
+}
+
+template<class Elm>
+inline
+void statistic<Elm>::sort() const{
+	if(_sorted)
+		return;
+
+	std::sort(_data->begin(), _data->end());
+	_sorted= true;
+}
+
+/**
+ * [rfirst, rlast)の順位(昇順)にある要素を確定させる。<br>
+ * 中央の順位でnth_elementし、それより前の順位は左側、後の順位は右側だけを対象に繰り返す。<br>
+ */
+template<class Elm>
+inline
+void statistic<Elm>::select(typename std::vector<Elm>::iterator first, typename std::vector<Elm>::iterator last,
+	std::vector<int>::const_iterator rfirst, std::vector<int>::const_iterator rlast) const{
+	while(rfirst != rlast){
+		std::vector<int>::const_iterator const mid= rfirst + (rlast - rfirst) / 2;
+		typename std::vector<Elm>::iterator const nth= _data->begin() + *mid;
+
+		std::nth_element(first, nth, last);
+		select(first, nth, rfirst, mid);
+		first= nth + 1;
+		rfirst= mid + 1;
+	}
+}
+
+/**
+ *	呼び出し側のメモリをそのまま使う統計処理クラス<br>
+ *	vector_viewで渡すので、連続した配列のほか、行優先の表の1列(column_view)のような
+ *	間隔の空いた列も写さずに扱える。<br>
+ *	和、平均、分散、最小値、最大値は要素を直接走査し、写しもメモリの確保もしない
+ *	(要素数がdetail::statistic_parallel_grainを超える場合は、スレッドごとの部分結果の分だけ確保する)。
+ *	中央値、分位数、最頻値を求めた時に初めて、並べ替え用にstatisticへ写す。<br>
+ *	要素はこのオブジェクトより長く生存し、使っている間は変更しないこと。
+ *	statisticと同じく、同じオブジェクトを複数のスレッドから同時に使ってはいけない。<br>
+ *
+ *	@author  kamichidu
+ */
+template<class Elm>
+class statistic_view{
+	public:
+		explicit statistic_view(vector_view<Elm const> const& v);
+		statistic_view(Elm const* data, int size, int stride= 1);
+	public:
+		int size() const;
+		Elm const& max() const;
+		Elm const& min() const;
+		double sum() const;
+		double mean() const;
+		Elm const& mode() const;
+		double median() const;
+		double quantile(double p) const;
+		std::vector<double> quantiles(std::vector<double> const& ps) const;
+		double variance() const;
+		double standard_deviation() const;
+		bool ordered() const;
+	private:
+		void bounds() const;
+		kernel::moments_result const& moments() const;
+		statistic<Elm> const& order() const;
+	private:
+		vector_view<Elm const> _view;
+		mutable bool _has_bounds;
+		mutable Elm _min;
+		mutable Elm _max;
+		mutable bool _has_moments;
+		mutable kernel::moments_result _moments;
+		mutable std::unique_ptr<statistic<Elm>> _order;
+};
+
+template<class Elm>
+inline
+statistic_view<Elm>::statistic_view(vector_view<Elm const> const& v) :
+	_view(v), _has_bounds(false), _min(), _max(), _has_moments(false), _moments(), _order(){
+}
+
+template<class Elm>
+inline
+statistic_view<Elm>::statistic_view(Elm const* data, int size, int stride) :
+	statistic_view(vector_view<Elm const>(data, size, stride)){
+}
+
+template<class Elm>
+inline
+int statistic_view<Elm>::size() const{
+	return _view.size();
+}
+
+/**
+ * 最大値。要素がない場合は値を初期化したもの。<br>
+ */
+template<class Elm>
+inline
+Elm const& statistic_view<Elm>::max() const{
+	bounds();
+
+	return _max;
+}
+
+/**
+ * 最小値。要素がない場合は値を初期化したもの。<br>
+ */
+template<class Elm>
+inline
+Elm const& statistic_view<Elm>::min() const{
+	bounds();
+
+	return _min;
+}
+
+template<class Elm>
+inline
+double statistic_view<Elm>::sum() const{
+	return moments().sum;
+}
+
+template<class Elm>
+inline
+double statistic_view<Elm>::mean() const{
+	return moments().mean;
+}
+
+/**
+ * 最頻値。並べ替え用の写しを作る。<br>
+ *
+ * @see statistic::mode()
+ */
+template<class Elm>
+inline
+Elm const& statistic_view<Elm>::mode() const{
+	return order().mode();
+}
+
+/**
+ * 中央値。並べ替え用の写しを作る。<br>
+ *
+ * @see statistic::median()
+ */
+template<class Elm>
+inline
+double statistic_view<Elm>::median() const{
+	return order().median();
+}
+
+/**
+ * p分位数。並べ替え用の写しを作る。<br>
+ *
+ * @see statistic::quantile(double)
+ */
+template<class Elm>
+inline
+double statistic_view<Elm>::quantile(double p) const{
+	return order().quantile(p);
+}
+
+/**
+ * 複数のp分位数。並べ替え用の写しを作る。<br>
+ *
+ * @see statistic::quantiles(std::vector<double> const&)
+ */
+template<class Elm>
+inline
+std::vector<double> statistic_view<Elm>::quantiles(std::vector<double> const& ps) const{
+	return order().quantiles(ps);
+}
+
+template<class Elm>
+inline
+double statistic_view<Elm>::variance() const{
+	return moments().m2 / static_cast<double>(size());
+}
+
+template<class Elm>
+inline
+double statistic_view<Elm>::standard_deviation() const{
+	return sqrt(variance());
+}
+
+/**
+ * 並べ替え用の写しを作ったか。<br>
+ */
+template<class Elm>
+inline
+bool statistic_view<Elm>::ordered() const{
+	return static_cast<bool>(_order);
+}
+
+template<class Elm>
+inline
+void statistic_view<Elm>::bounds() const{
+	if(_has_bounds || size() == 0)
+		return;
+
+	Elm lo= _view[0], hi= _view[0];
+
+	for(int i= 1; i < size(); ++i){
+		Elm const& x= _view[i];
+
+		lo= (x < lo) ? x : lo;
+		hi= (hi < x) ? x : hi;
+	}
+	_min= lo;
+	_max= hi;
+	_has_bounds= true;
+}
+
+template<class Elm>
+inline
+kernel::moments_result const& statistic_view<Elm>::moments() const{
+	if(_has_moments)
+		return _moments;
+
+	_moments= detail::statistic_moments(_view.data(), size(), _view.stride());
+	_has_moments= true;
+
+	return _moments;
+}
+
+template<class Elm>
+inline
+statistic<Elm> const& statistic_view<Elm>::order() const{
+	if(!_order)
+		_order.reset(new statistic<Elm>(_view));
+
+	return *_order;
+}
+
 }
 }
 
@@ -1,14 +1,69 @@
 #ifndef LIB_MATH_VECTOR_HPP_
 #define LIB_MATH_VECTOR_HPP_
 
+#include <algorithm>
+#include <initializer_list>
+#include <stdexcept>
 #include <vector>
-#include <memory>
+#include "dimension.hpp"
+#include "expression.hpp"
+#include "kernel/level1.hpp"
+#include "../memory/aligned_allocator.hpp"
 
 namespace lib{
 namespace math{
 
+/**
+ * vectorの要素の保持方法。<br>
+ * 次元がコンパイル時に決まる場合は、要素をオブジェクト内に直接保持する。<br>
+ *
+ * @param <N>   次元
+ * @param <Elm> 要素の型
+ */
+template<int N, class Elm>
+class vector_storage{
+	public:
+		constexpr vector_storage() : _vec(){}
+		constexpr explicit vector_storage(int n) : _vec(){ check_dimension(N, n); }
+	public:
+		constexpr int size() const{ return N; }
+		constexpr void resize(int n){ check_dimension(N, n); }
+		constexpr Elm const* data() const{ return _vec; }
+		constexpr Elm* data(){ return _vec; }
+	private:
+		Elm _vec[N];
+};
+
+/**
+ * 次元が実行時に決まるvectorの要素の保持方法。<br>
+ * 要素は64バイト境界に揃えた連続領域に保持する。<br>
+ *
+ * @param <Elm> 要素の型
+ */
+template<class Elm>
+class vector_storage<dynamic, Elm>{
+	public:
+		vector_storage(){}
+		explicit vector_storage(int n) : _vec(n){}
+	public:
+		int size() const{ return static_cast<int>(_vec.size()); }
+		void resize(int n){ _vec.resize(n); }
+		Elm const* data() const{ return _vec.data(); }
+		Elm* data(){ return _vec.data(); }
+	private:
+		std::vector<Elm, memory::aligned_allocator<Elm>> _vec;
+};
+
 /**
  * 多次元ベクトルクラス<br>
+ * Nが正の場合、要素はオブジェクト内に直接保持するため、生成・コピー時にヒープ確保は発生しない。
+ * この場合は要素アクセスと初期化子リストによる生成がconstexprで行える。<br>
+ * Nがdynamicの場合は実行時に次元を決める(dynamic_vector)。演算やカーネルは共通で、
+ * 次元の不一致は実行時にlib::exception::invalid_argument<>として報告される。<br>
+ * 加減算とスカラー倍は式テンプレートとして組み立てられ、vectorへ代入する時点で
+ * 1回のループにまとめて評価される。<br>
+ * operator []は範囲チェックを行わない。LIB_MATH_DEBUGを定義した場合と
+ * at()はstd::out_of_rangeを投げる。<br>
  *
  * @author  kamichidu
  * @version 2012-05-20 (日)
@@ -16,128 +71,423 @@ namespace math{
  * @param <Elm> 要素の型
  */
 template<int N, class Elm= double>
-class vector{
+class vector : public vector_expression<vector<N, Elm>>{
+	static_assert(N > 0 || N == dynamic, "dimension must be positive or dynamic");
 	public:
-		vector();
-		vector(std::initializer_list<Elm> vec);
+		typedef Elm value_type;
+
+		static int const dimension= N;
+	public:
+		constexpr vector();
+		constexpr explicit vector(int n);
+		constexpr vector(std::initializer_list<Elm> vec);
 		template<class InputIterator>
 			vector(InputIterator first, InputIterator last);
-		~vector();
+		template<class E>
+			vector(vector_expression<E> const& e);
+		~vector()= default;
 	public:
-		vector<N, Elm> const operator + (vector<N, Elm> const& r) const;
-		vector<N, Elm> const operator - (vector<N, Elm> const& r) const;
-		Elm const dot_product(vector<N, Elm> const& r) const;
-		Elm const& operator [] (int i) const;
-		Elm& operator [] (int i);
+		template<class E>
+			vector<N, Elm>& operator = (vector_expression<E> const& r);
+		template<class E>
+			vector<N, Elm>& operator += (vector_expression<E> const& r);
+		template<class E>
+			vector<N, Elm>& operator -= (vector_expression<E> const& r);
+		constexpr Elm const dot_product(vector<N, Elm> const& r) const;
+		constexpr Elm const& operator [] (int i) const;
+		constexpr Elm& operator [] (int i);
+		constexpr Elm const& at(int i) const;
+		constexpr Elm& at(int i);
+		constexpr Elm const* data() const;
+		constexpr Elm* data();
+		constexpr int size() const;
+		constexpr Elm const& element(int i) const;
+		bool overlaps(void const* first, void const* last) const;
 	public: // copy semantics
-		vector(vector<N, Elm> const& obj);
-		vector<N, Elm>& operator = (vector<N, Elm> const& r);
+		vector(vector<N, Elm> const& obj)= default;
+		vector<N, Elm>& operator = (vector<N, Elm> const& r)= default;
 	public: // move semantics
-		vector(vector<N, Elm>&& obj);
-		vector<N, Elm>& operator = (vector<N, Elm>&& r);
+		vector(vector<N, Elm>&& obj)= default;
+		vector<N, Elm>& operator = (vector<N, Elm>&& r)= default;
 	private:
-		std::unique_ptr<std::vector<Elm>> _vec;
+		vector_storage<N, Elm> _vec;
 };
 
+/**
+ * dynamic_vector<Elm>はvector<dynamic, Elm>の別名。<br>
+ */
+template<class Elm= double>
+using dynamic_vector= vector<dynamic, Elm>;
+
+/**
+ * 要素を値初期化する。Nがdynamicの場合は0次元になる。<br>
+ */
 template<int N, class Elm>
-inline
+constexpr
 vector<N, Elm>::vector(){
-	_vec= std::unique_ptr<std::vector<Elm>>(new std::vector<Elm>(N));
 }
 
+/**
+ * n次元で初期化する。要素は値初期化される。<br>
+ *
+ * @param n 次元(Nが正の場合はNと等しくなければならない)
+ */
+template<int N, class Elm>
+constexpr
+vector<N, Elm>::vector(int n) : _vec(n){
+}
+
+/**
+ * 先頭からN個までの要素で初期化する。足りない要素は値初期化される。<br>
+ * Nがdynamicの場合はすべての要素で初期化する。<br>
+ */
 template<int N, class Elm>
-inline
-vector<N, Elm>::vector(std::initializer_list<Elm> vec){
-	_vec= std::unique_ptr<std::vector<Elm>>(new std::vector<Elm>(vec.begin(), vec.end()));
+constexpr
+vector<N, Elm>::vector(std::initializer_list<Elm> vec) : _vec(N == dynamic ? static_cast<int>(vec.size()) : N){
+	int const n= std::min<int>(size(), vec.size());
+	Elm const* const src= vec.begin();
+
+	for(int i= 0; i < n; ++i)
+		data()[i]= src[i];
 }
 
+/**
+ * 先頭からN個までの要素で初期化する。足りない要素は値初期化される。<br>
+ * Nがdynamicの場合はすべての要素で初期化する。<br>
+ */
 template<int N, class Elm>
 template<class InputIterator>
 inline
 vector<N, Elm>::vector(InputIterator first, InputIterator last){
-	_vec= std::unique_ptr<std::vector<Elm>>(new std::vector<Elm>(first, last));
+	if(N == dynamic){
+		std::vector<Elm> const buf(first, last);
+
+		_vec.resize(static_cast<int>(buf.size()));
+		std::copy(buf.begin(), buf.end(), data());
+	}
+	else{
+		Elm* const dest= data();
+
+		for(int i= 0; i < N && first != last; ++i, ++first)
+			dest[i]= *first;
+	}
 }
 
+/**
+ * 式を評価して初期化する。<br>
+ *
+ * @param e ベクトル式
+ */
 template<int N, class Elm>
+template<class E>
 inline
-vector<N, Elm>::~vector(){
-	_vec= std::unique_ptr<std::vector<Elm>>();
+vector<N, Elm>::vector(vector_expression<E> const& e) : _vec(e.self().size()){
+	static_assert(compatible_dimension(E::dimension, N), "dimension mismatch");
+
+	E const& x= e.self();
+	Elm* const dest= data();
+	int const n= size();
+
+	for(int i= 0; i < n; ++i)
+		dest[i]= x.element(i);
 }
 
+/**
+ * 式を評価して代入する。<br>
+ * 右辺に*thisを含んでもよい。vector同士の式は同じ添字の要素しか参照しないのでそのまま書き込み、
+ * vector_viewのように別の位置を参照し得る式は一時オブジェクトに評価してから写す。<br>
+ *
+ * @param r ベクトル式
+ * @return
+ *     *this
+ */
 template<int N, class Elm>
+template<class E>
 inline
-vector<N, Elm> const vector<N, Elm>::operator + (vector<N, Elm> const& r) const{
-	vector<N, Elm> buf(_vec->begin(), _vec->end());
+vector<N, Elm>& vector<N, Elm>::operator = (vector_expression<E> const& r){
+	static_assert(compatible_dimension(E::dimension, N), "dimension mismatch");
 
-	for(int i= 0; i < N; ++i)
-		buf[i]+= r._vec->at(i);
+	if(expression::may_alias<E>::value)
+		return *this= vector<N, Elm>(r);
 
-	return buf;
+	E const& x= r.self();
+
+	_vec.resize(x.size());
+
+	Elm* const dest= data();
+	int const n= size();
+
+	for(int i= 0; i < n; ++i)
+		dest[i]= x.element(i);
+
+	return *this;
 }
 
 template<int N, class Elm>
+template<class E>
 inline
-vector<N, Elm> const vector<N, Elm>::operator - (vector<N, Elm> const& r) const{
-	vector<N, Elm> buf(_vec->begin(), _vec->end());
+vector<N, Elm>& vector<N, Elm>::operator += (vector_expression<E> const& r){
+	static_assert(compatible_dimension(E::dimension, N), "dimension mismatch");
 
-	for(int i= 0; i < N; ++i)
-		buf[i]-= r._vec->at(i);
+	if(expression::may_alias<E>::value)
+		return *this= vector<N, Elm>(*this + r);
 
-	return buf;
+	E const& x= r.self();
+
+	check_dimension(size(), x.size());
+
+	Elm* const dest= data();
+	int const n= size();
+
+	for(int i= 0; i < n; ++i)
+		dest[i]+= x.element(i);
+
+	return *this;
 }
 
 template<int N, class Elm>
+template<class E>
 inline
+vector<N, Elm>& vector<N, Elm>::operator -= (vector_expression<E> const& r){
+	static_assert(compatible_dimension(E::dimension, N), "dimension mismatch");
+
+	if(expression::may_alias<E>::value)
+		return *this= vector<N, Elm>(*this - r);
+
+	E const& x= r.self();
+
+	check_dimension(size(), x.size());
+
+	Elm* const dest= data();
+	int const n= size();
+
+	for(int i= 0; i < n; ++i)
+		dest[i]-= x.element(i);
+
+	return *this;
+}
+
+/**
+ * 内積を計算する。<br>
+ *
+ * @param r 右辺
+ * @return
+ *     *thisとrの内積
+ * @see kernel::dot
+ */
+template<int N, class Elm>
+constexpr
 Elm const vector<N, Elm>::dot_product(vector<N, Elm> const& r) const{
-	Elm buf;
-	
-	buf= _vec->front() * r._vec->front();
-	for(int i= 1; i < N; ++i)
-		buf+= _vec->at(i) * r._vec->at(i);
+	return dot(*this, r);
+}
 
-	return buf;
+template<int N, class Elm>
+constexpr
+Elm const& vector<N, Elm>::operator [] (int i) const{
+#ifdef LIB_MATH_DEBUG
+	return at(i);
+#else
+	return data()[i];
+#endif
+}
+
+template<int N, class Elm>
+constexpr
+Elm& vector<N, Elm>::operator [] (int i){
+#ifdef LIB_MATH_DEBUG
+	return at(i);
+#else
+	return data()[i];
+#endif
+}
+
+template<int N, class Elm>
+constexpr
+Elm const* vector<N, Elm>::data() const{
+	return _vec.data();
+}
+
+template<int N, class Elm>
+constexpr
+Elm* vector<N, Elm>::data(){
+	return _vec.data();
+}
+
+template<int N, class Elm>
+constexpr
+int vector<N, Elm>::size() const{
+	return _vec.size();
+}
+
+/**
+ * 範囲チェックなしの要素アクセス。式の評価に使う。<br>
+ *
+ * @param i 添字
+ * @return
+ *     i番目の要素
+ */
+template<int N, class Elm>
+constexpr
+Elm const& vector<N, Elm>::element(int i) const{
+	return data()[i];
 }
 
+/**
+ * 要素の領域がアドレス[first, last)と重なるか。<br>
+ */
 template<int N, class Elm>
 inline
-Elm const& vector<N, Elm>::operator [] (int i) const{
-	return _vec->at(i);
+bool vector<N, Elm>::overlaps(void const* first, void const* last) const{
+	return expression::intersects(first, last, data(), data() + size());
+}
+
+/**
+ * 範囲チェック付きの要素アクセス。<br>
+ *
+ * @param i 添字
+ * @throw std::out_of_range 添字が範囲外の場合
+ */
+template<int N, class Elm>
+constexpr
+Elm const& vector<N, Elm>::at(int i) const{
+	if(i < 0 || i >= size())
+		throw std::out_of_range("lib::math::vector");
+
+	return data()[i];
+}
+
+template<int N, class Elm>
+constexpr
+Elm& vector<N, Elm>::at(int i){
+	return const_cast<Elm&>(static_cast<vector<N, Elm> const&>(*this).at(i));
+}
+
+namespace detail{
+
+template<int N, class Elm>
+constexpr
+Elm small_dot(vector<N, Elm> const& l, vector<N, Elm> const& r){
+	Elm acc= Elm();
+
+	LIB_MATH_KERNEL_UNROLL(4)
+	for(int i= 0; i < N; ++i)
+		acc+= l.element(i) * r.element(i);
+
+	return acc;
 }
 
+}
+
+/**
+ * 内積を計算する。<br>
+ * 4次元以下では展開したループで計算し、constexprで評価できる。<br>
+ *
+ * @param l 左辺
+ * @param r 右辺
+ * @return
+ *     lとrの内積
+ */
+template<int N, class Elm>
+constexpr
+Elm dot(vector<N, Elm> const& l, vector<N, Elm> const& r){
+	check_dimension(l.size(), r.size());
+
+	return small_dimension(N, 1) ? detail::small_dot(l, r) : kernel::dot(l.size(), l.data(), 1, r.data(), 1);
+}
+
+/**
+ * 3次元ベクトルの外積を計算する。<br>
+ *
+ * @param l 左辺
+ * @param r 右辺
+ * @return
+ *     l×r
+ */
+template<class Elm>
+constexpr
+vector<3, Elm> cross(vector<3, Elm> const& l, vector<3, Elm> const& r){
+	return vector<3, Elm>{
+		l[1] * r[2] - l[2] * r[1],
+		l[2] * r[0] - l[0] * r[2],
+		l[0] * r[1] - l[1] * r[0],
+	};
+}
+
+/**
+ * y+= alpha*x を計算する。<br>
+ *
+ * @param alpha 係数
+ * @param x     加えるベクトル
+ * @param y     更新されるベクトル
+ */
 template<int N, class Elm>
 inline
-Elm& vector<N, Elm>::operator [] (int i){
-	return _vec->at(i);
+void axpy(Elm const& alpha, vector<N, Elm> const& x, vector<N, Elm>& y){
+	check_dimension(y.size(), x.size());
+
+	kernel::axpy(y.size(), alpha, x.data(), 1, y.data(), 1);
 }
 
+/**
+ * x*= alpha を計算する。<br>
+ *
+ * @param alpha 係数
+ * @param x     更新されるベクトル
+ */
 template<int N, class Elm>
 inline
-vector<N, Elm>::vector(vector<N, Elm> const& obj){
-	_vec= std::unique_ptr<std::vector<Elm>>(new std::vector<Elm>(obj._vec->begin(), obj._vec->end()));
+void scale(Elm const& alpha, vector<N, Elm>& x){
+	kernel::scale(x.size(), alpha, x.data(), 1);
 }
 
+/**
+ * 要素ごとの積を計算する。<br>
+ *
+ * @param l 左辺
+ * @param r 右辺
+ * @return
+ *     l[i]*r[i]を要素に持つベクトル
+ */
 template<int N, class Elm>
 inline
-vector<N, Elm>& vector<N, Elm>::operator = (vector<N, Elm> const& r){
-	_vec= std::unique_ptr<std::vector<Elm>>(new std::vector<Elm>(r._vec->begin(), r._vec->end()));
+vector<N, Elm> hadamard_product(vector<N, Elm> const& l, vector<N, Elm> const& r){
+	check_dimension(l.size(), r.size());
+
+	vector<N, Elm> buf(l);
+
+	kernel::multiply(buf.size(), buf.data(), 1, r.data(), 1, buf.data(), 1);
+
+	return buf;
 }
 
+/**
+ * L1ノルムを計算する。<br>
+ */
 template<int N, class Elm>
 inline
-vector<N, Elm>::vector(vector<N, Elm>&& obj){
-	_vec= std::move(obj._vec);
+Elm norm1(vector<N, Elm> const& v){
+	return kernel::norm1(v.size(), v.data(), 1);
 }
 
+/**
+ * L2ノルムを計算する。<br>
+ */
 template<int N, class Elm>
 inline
-vector<N, Elm>& vector<N, Elm>::operator = (vector<N, Elm>&& r){
-	_vec= std::move(r._vec);
+Elm norm2(vector<N, Elm> const& v){
+	return kernel::norm2(v.size(), v.data(), 1);
+}
 
-	return *this;
+/**
+ * 最大値ノルムを計算する。<br>
+ */
+template<int N, class Elm>
+inline
+Elm norm_inf(vector<N, Elm> const& v){
+	return kernel::norm_inf(v.size(), v.data(), 1);
 }
 
 }
 }
 
 #endif // #ifndef LIB_MATH_VECTOR_HPP_
-
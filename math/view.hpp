@@ -0,0 +1,945 @@
+#ifndef LIB_MATH_VIEW_HPP_
+#define LIB_MATH_VIEW_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include "dimension.hpp"
+#include "expression.hpp"
+#include "vector.hpp"
+#include "matrix.hpp"
+#include "kernel/level1.hpp"
+#include "kernel/level2.hpp"
+#include "kernel/gemm.hpp"
+#include "kernel/transpose.hpp"
+#include "../memory/aligned_allocator.hpp"
+
+namespace lib{
+namespace math{
+
+/**
+ * 要素を所有しない、等間隔に並んだ要素のベクトルとしての参照<br>
+ * vectorそのもの、matrixの行や列などを、コピーせずにベクトル式やカーネルに渡すためのもの。<br>
+ * コピーは参照先を共有する。代入は参照先の要素に書き込む。<br>
+ * Elmをconstにすると読み取り専用になる。<br>
+ * 参照先より長く使ってはならない。<br>
+ *
+ * @author  kamichidu
+ * @param <Elm> 要素の型(読み取り専用の場合はconst付き)
+ */
+template<class Elm>
+class vector_view : public vector_expression<vector_view<Elm>>{
+	public:
+		typedef void is_expression_node;
+		typedef typename std::remove_const<Elm>::type value_type;
+
+		static int const dimension= dynamic;
+	public:
+		vector_view(Elm* data, int size, int stride= 1);
+		template<int N>
+			vector_view(vector<N, value_type>& v);
+		template<int N, class T= Elm, class= typename std::enable_if<std::is_const<T>::value>::type>
+			vector_view(vector<N, value_type> const& v);
+		vector_view(vector_view<Elm> const& obj)= default;
+	public:
+		vector_view<Elm> const& operator = (vector_view<Elm> const& r) const;
+		template<class E>
+			vector_view<Elm> const& operator = (vector_expression<E> const& r) const;
+		template<class E>
+			vector_view<Elm> const& operator += (vector_expression<E> const& r) const;
+		template<class E>
+			vector_view<Elm> const& operator -= (vector_expression<E> const& r) const;
+		operator vector_view<value_type const> () const;
+		Elm& operator [] (int i) const;
+		Elm& at(int i) const;
+		Elm* data() const;
+		int size() const;
+		int stride() const;
+		value_type const& element(int i) const;
+		bool overlaps(void const* first, void const* last) const;
+	private:
+		template<class E>
+			bool aliased(E const& x) const;
+	private:
+		Elm* _data;
+		int _size;
+		int _stride;
+};
+
+/**
+ * 要素を所有しない、行と列の間隔を指定した行列としての参照<br>
+ * matrixの部分行列や転置をコピーせずに行列式やカーネルに渡すためのもの。<br>
+ * (i, j)要素はdata()[i * row_stride() + j * col_stride()]にある。
+ * matrixをそのまま参照するとrow_stride()は列数、col_stride()は1になり、
+ * 転置するとこの2つが入れ替わる。<br>
+ * コピーは参照先を共有する。代入は参照先の要素に書き込む。<br>
+ * Elmをconstにすると読み取り専用になる。<br>
+ * 参照先より長く使ってはならない。<br>
+ *
+ * @author  kamichidu
+ * @param <Elm> 要素の型(読み取り専用の場合はconst付き)
+ */
+template<class Elm>
+class matrix_view : public matrix_expression<matrix_view<Elm>>{
+	public:
+		typedef void is_expression_node;
+		typedef typename std::remove_const<Elm>::type value_type;
+
+		static int const row_dimension= dynamic;
+		static int const col_dimension= dynamic;
+	public:
+		matrix_view(Elm* data, int rows, int cols, int row_stride, int col_stride= 1);
+		template<int N, int M>
+			matrix_view(matrix<N, M, value_type>& m);
+		template<int N, int M, class T= Elm, class= typename std::enable_if<std::is_const<T>::value>::type>
+			matrix_view(matrix<N, M, value_type> const& m);
+		matrix_view(matrix_view<Elm> const& obj)= default;
+	public:
+		matrix_view<Elm> const& operator = (matrix_view<Elm> const& r) const;
+		template<class E>
+			matrix_view<Elm> const& operator = (matrix_expression<E> const& r) const;
+		template<class E>
+			matrix_view<Elm> const& operator += (matrix_expression<E> const& r) const;
+		template<class E>
+			matrix_view<Elm> const& operator -= (matrix_expression<E> const& r) const;
+		operator matrix_view<value_type const> () const;
+		vector_view<Elm> operator [] (int row) const;
+		vector_view<Elm> at(int row) const;
+		vector_view<Elm> row(int i) const;
+		vector_view<Elm> column(int j) const;
+		matrix_view<Elm> block(int row, int col, int rows, int cols) const;
+		matrix_view<Elm> transpose() const;
+		Elm* data() const;
+		int rows() const;
+		int cols() const;
+		int row_stride() const;
+		int col_stride() const;
+		bool row_major() const;
+		value_type const& element(int i, int j) const;
+		bool overlaps(void const* first, void const* last) const;
+	private:
+		template<class E>
+			bool aliased(E const& x) const;
+	private:
+		Elm* _data;
+		int _rows;
+		int _cols;
+		int _rs;
+		int _cs;
+};
+
+namespace detail{
+
+/**
+ * data[i * a + j * b](0 <= i < rows、0 <= j < cols)が収まるアドレスの範囲[lo, hi)を求める。<br>
+ */
+template<class Elm>
+inline
+void view_extent(Elm* data, int rows, int cols, int a, int b, Elm*& lo, Elm*& hi){
+	if(rows <= 0 || cols <= 0){
+		lo= hi= data;
+		return;
+	}
+
+	std::ptrdiff_t const da= static_cast<std::ptrdiff_t>(rows - 1) * a;
+	std::ptrdiff_t const db= static_cast<std::ptrdiff_t>(cols - 1) * b;
+
+	lo= data + std::min<std::ptrdiff_t>(da, 0) + std::min<std::ptrdiff_t>(db, 0);
+	hi= data + std::max<std::ptrdiff_t>(da, 0) + std::max<std::ptrdiff_t>(db, 0) + 1;
+}
+
+}
+
+namespace expression{
+
+template<class Elm>
+struct may_alias<vector_view<Elm>> : std::true_type{};
+
+template<class Elm>
+struct may_alias<matrix_view<Elm>> : std::true_type{};
+
+}
+
+/**
+ * data[0], data[stride], ..., data[(size - 1) * stride]を参照する。<br>
+ *
+ * @param data   先頭要素
+ * @param size   要素数
+ * @param stride 要素の間隔
+ */
+template<class Elm>
+inline
+vector_view<Elm>::vector_view(Elm* data, int size, int stride) : _data(data), _size(size), _stride(stride){
+}
+
+/**
+ * vectorの全要素を参照する。<br>
+ */
+template<class Elm>
+template<int N>
+inline
+vector_view<Elm>::vector_view(vector<N, value_type>& v) : _data(v.data()), _size(v.size()), _stride(1){
+}
+
+template<class Elm>
+template<int N, class T, class>
+inline
+vector_view<Elm>::vector_view(vector<N, value_type> const& v) : _data(v.data()), _size(v.size()), _stride(1){
+}
+
+/**
+ * rの要素を参照先に書き込む。参照先が重なっていてもよい。<br>
+ *
+ * @param r 複写元
+ * @return
+ *     *this
+ * @throw lib::exception::invalid_argument<> 要素数が一致しない場合
+ */
+template<class Elm>
+inline
+vector_view<Elm> const& vector_view<Elm>::operator = (vector_view<Elm> const& r) const{
+	return *this= static_cast<vector_expression<vector_view<Elm>> const&>(r);
+}
+
+/**
+ * 式を評価して参照先に書き込む。<br>
+ * 右辺が参照先と重なる要素を参照する場合は、一時オブジェクトに評価してから写す。<br>
+ *
+ * @param r ベクトル式
+ * @return
+ *     *this
+ * @throw lib::exception::invalid_argument<> 要素数が一致しない場合
+ */
+template<class Elm>
+template<class E>
+inline
+vector_view<Elm> const& vector_view<Elm>::operator = (vector_expression<E> const& r) const{
+	E const& x= r.self();
+
+	check_dimension(size(), x.size());
+	if(aliased(x))
+		return *this= vector<dynamic, value_type>(x);
+
+	for(int i= 0; i < _size; ++i)
+		_data[static_cast<std::ptrdiff_t>(i) * _stride]= x.element(i);
+
+	return *this;
+}
+
+template<class Elm>
+template<class E>
+inline
+vector_view<Elm> const& vector_view<Elm>::operator += (vector_expression<E> const& r) const{
+	E const& x= r.self();
+
+	check_dimension(size(), x.size());
+	if(aliased(x))
+		return *this+= vector<dynamic, value_type>(x);
+
+	for(int i= 0; i < _size; ++i)
+		_data[static_cast<std::ptrdiff_t>(i) * _stride]+= x.element(i);
+
+	return *this;
+}
+
+template<class Elm>
+template<class E>
+inline
+vector_view<Elm> const& vector_view<Elm>::operator -= (vector_expression<E> const& r) const{
+	E const& x= r.self();
+
+	check_dimension(size(), x.size());
+	if(aliased(x))
+		return *this-= vector<dynamic, value_type>(x);
+
+	for(int i= 0; i < _size; ++i)
+		_data[static_cast<std::ptrdiff_t>(i) * _stride]-= x.element(i);
+
+	return *this;
+}
+
+/**
+ * 読み取り専用のビューに変換する。<br>
+ */
+template<class Elm>
+inline
+vector_view<Elm>::operator vector_view<value_type const> () const{
+	return vector_view<value_type const>(_data, _size, _stride);
+}
+
+template<class Elm>
+inline
+Elm& vector_view<Elm>::operator [] (int i) const{
+#ifdef LIB_MATH_DEBUG
+	return at(i);
+#else
+	return _data[static_cast<std::ptrdiff_t>(i) * _stride];
+#endif
+}
+
+/**
+ * 範囲チェック付きの要素アクセス。<br>
+ *
+ * @param i 添字
+ * @throw std::out_of_range 添字が範囲外の場合
+ */
+template<class Elm>
+inline
+Elm& vector_view<Elm>::at(int i) const{
+	if(i < 0 || i >= _size)
+		throw std::out_of_range("lib::math::vector_view");
+
+	return _data[static_cast<std::ptrdiff_t>(i) * _stride];
+}
+
+template<class Elm>
+inline
+Elm* vector_view<Elm>::data() const{
+	return _data;
+}
+
+template<class Elm>
+inline
+int vector_view<Elm>::size() const{
+	return _size;
+}
+
+template<class Elm>
+inline
+int vector_view<Elm>::stride() const{
+	return _stride;
+}
+
+template<class Elm>
+inline
+typename vector_view<Elm>::value_type const& vector_view<Elm>::element(int i) const{
+	return _data[static_cast<std::ptrdiff_t>(i) * _stride];
+}
+
+/**
+ * 参照先がアドレス[first, last)と重なるか。<br>
+ */
+template<class Elm>
+inline
+bool vector_view<Elm>::overlaps(void const* first, void const* last) const{
+	Elm* lo;
+	Elm* hi;
+
+	detail::view_extent(_data, _size, 1, _stride, 0, lo, hi);
+
+	return expression::intersects(first, last, lo, hi);
+}
+
+/**
+ * 式xが参照先の要素を参照するか。<br>
+ */
+template<class Elm>
+template<class E>
+inline
+bool vector_view<Elm>::aliased(E const& x) const{
+	Elm* lo;
+	Elm* hi;
+
+	detail::view_extent(_data, _size, 1, _stride, 0, lo, hi);
+
+	return x.overlaps(lo, hi);
+}
+
+/**
+ * (i, j)要素がdata[i * row_stride + j * col_stride]にある行列を参照する。<br>
+ *
+ * @param data       (0, 0)要素
+ * @param rows       行数
+ * @param cols       列数
+ * @param row_stride 行の間隔
+ * @param col_stride 列の間隔
+ */
+template<class Elm>
+inline
+matrix_view<Elm>::matrix_view(Elm* data, int rows, int cols, int row_stride, int col_stride)
+	: _data(data), _rows(rows), _cols(cols), _rs(row_stride), _cs(col_stride){
+}
+
+/**
+ * matrix全体を参照する。<br>
+ */
+template<class Elm>
+template<int N, int M>
+inline
+matrix_view<Elm>::matrix_view(matrix<N, M, value_type>& m) : _data(m.data()), _rows(m.rows()), _cols(m.cols()), _rs(m.cols()), _cs(1){
+}
+
+template<class Elm>
+template<int N, int M, class T, class>
+inline
+matrix_view<Elm>::matrix_view(matrix<N, M, value_type> const& m) : _data(m.data()), _rows(m.rows()), _cols(m.cols()), _rs(m.cols()), _cs(1){
+}
+
+/**
+ * rの要素を参照先に書き込む。参照先が重なっていてもよい。<br>
+ *
+ * @param r 複写元
+ * @return
+ *     *this
+ * @throw lib::exception::invalid_argument<> 行数か列数が一致しない場合
+ */
+template<class Elm>
+inline
+matrix_view<Elm> const& matrix_view<Elm>::operator = (matrix_view<Elm> const& r) const{
+	return *this= static_cast<matrix_expression<matrix_view<Elm>> const&>(r);
+}
+
+/**
+ * 式を評価して参照先に書き込む。<br>
+ * 右辺が参照先と重なる要素を参照する場合は、一時オブジェクトに評価してから写す。<br>
+ *
+ * @param r 行列式
+ * @return
+ *     *this
+ * @throw lib::exception::invalid_argument<> 行数か列数が一致しない場合
+ */
+template<class Elm>
+template<class E>
+inline
+matrix_view<Elm> const& matrix_view<Elm>::operator = (matrix_expression<E> const& r) const{
+	E const& x= r.self();
+
+	check_dimension(rows(), x.rows());
+	check_dimension(cols(), x.cols());
+	if(aliased(x))
+		return *this= matrix<dynamic, dynamic, value_type>(x);
+
+	for(int i= 0; i < _rows; ++i)
+		for(int j= 0; j < _cols; ++j)
+			_data[static_cast<std::ptrdiff_t>(i) * _rs + static_cast<std::ptrdiff_t>(j) * _cs]= x.element(i, j);
+
+	return *this;
+}
+
+template<class Elm>
+template<class E>
+inline
+matrix_view<Elm> const& matrix_view<Elm>::operator += (matrix_expression<E> const& r) const{
+	E const& x= r.self();
+
+	check_dimension(rows(), x.rows());
+	check_dimension(cols(), x.cols());
+	if(aliased(x))
+		return *this+= matrix<dynamic, dynamic, value_type>(x);
+
+	for(int i= 0; i < _rows; ++i)
+		for(int j= 0; j < _cols; ++j)
+			_data[static_cast<std::ptrdiff_t>(i) * _rs + static_cast<std::ptrdiff_t>(j) * _cs]+= x.element(i, j);
+
+	return *this;
+}
+
+template<class Elm>
+template<class E>
+inline
+matrix_view<Elm> const& matrix_view<Elm>::operator -= (matrix_expression<E> const& r) const{
+	E const& x= r.self();
+
+	check_dimension(rows(), x.rows());
+	check_dimension(cols(), x.cols());
+	if(aliased(x))
+		return *this-= matrix<dynamic, dynamic, value_type>(x);
+
+	for(int i= 0; i < _rows; ++i)
+		for(int j= 0; j < _cols; ++j)
+			_data[static_cast<std::ptrdiff_t>(i) * _rs + static_cast<std::ptrdiff_t>(j) * _cs]-= x.element(i, j);
+
+	return *this;
+}
+
+/**
+ * 読み取り専用のビューに変換する。<br>
+ */
+template<class Elm>
+inline
+matrix_view<Elm>::operator matrix_view<value_type const> () const{
+	return matrix_view<value_type const>(_data, _rows, _cols, _rs, _cs);
+}
+
+/**
+ * 行を参照する。v[i][j]の形で要素を読み書きできる。<br>
+ * 範囲チェックは行わない。LIB_MATH_DEBUGを定義した場合はat()と同じ。<br>
+ */
+template<class Elm>
+inline
+vector_view<Elm> matrix_view<Elm>::operator [] (int row) const{
+#ifdef LIB_MATH_DEBUG
+	return at(row);
+#else
+	return this->row(row);
+#endif
+}
+
+/**
+ * 範囲チェック付きで行を参照する。<br>
+ *
+ * @param row 行
+ * @throw std::out_of_range 行が範囲外の場合
+ */
+template<class Elm>
+inline
+vector_view<Elm> matrix_view<Elm>::at(int row) const{
+	if(row < 0 || row >= _rows)
+		throw std::out_of_range("lib::math::matrix_view");
+
+	return this->row(row);
+}
+
+/**
+ * i行目を参照する。<br>
+ *
+ * @param i 行
+ * @return
+ *     cols()要素、間隔col_stride()のビュー
+ */
+template<class Elm>
+inline
+vector_view<Elm> matrix_view<Elm>::row(int i) const{
+	return vector_view<Elm>(_data + static_cast<std::ptrdiff_t>(i) * _rs, _cols, _cs);
+}
+
+/**
+ * j列目を参照する。<br>
+ *
+ * @param j 列
+ * @return
+ *     rows()要素、間隔row_stride()のビュー
+ */
+template<class Elm>
+inline
+vector_view<Elm> matrix_view<Elm>::column(int j) const{
+	return vector_view<Elm>(_data + static_cast<std::ptrdiff_t>(j) * _cs, _rows, _rs);
+}
+
+/**
+ * 部分行列を参照する。<br>
+ *
+ * @param row  先頭の行
+ * @param col  先頭の列
+ * @param rows 行数
+ * @param cols 列数
+ * @throw std::out_of_range 範囲がこのビューに収まらない場合
+ */
+template<class Elm>
+inline
+matrix_view<Elm> matrix_view<Elm>::block(int row, int col, int rows, int cols) const{
+	if(row < 0 || col < 0 || rows < 0 || cols < 0 || row + rows > _rows || col + cols > _cols)
+		throw std::out_of_range("lib::math::matrix_view");
+
+	return matrix_view<Elm>(_data + static_cast<std::ptrdiff_t>(row) * _rs + static_cast<std::ptrdiff_t>(col) * _cs, rows, cols, _rs, _cs);
+}
+
+/**
+ * 転置を参照する。要素は移動しない。<br>
+ *
+ * @return
+ *     行と列の間隔を入れ替えたビュー
+ */
+template<class Elm>
+inline
+matrix_view<Elm> matrix_view<Elm>::transpose() const{
+	return matrix_view<Elm>(_data, _cols, _rows, _cs, _rs);
+}
+
+template<class Elm>
+inline
+Elm* matrix_view<Elm>::data() const{
+	return _data;
+}
+
+template<class Elm>
+inline
+int matrix_view<Elm>::rows() const{
+	return _rows;
+}
+
+template<class Elm>
+inline
+int matrix_view<Elm>::cols() const{
+	return _cols;
+}
+
+template<class Elm>
+inline
+int matrix_view<Elm>::row_stride() const{
+	return _rs;
+}
+
+template<class Elm>
+inline
+int matrix_view<Elm>::col_stride() const{
+	return _cs;
+}
+
+/**
+ * 行優先に並んでいるか判定する。<br>
+ *
+ * @return
+ *     col_stride() == 1ならtrue。この場合、各行はカーネルにそのまま渡せる
+ */
+template<class Elm>
+inline
+bool matrix_view<Elm>::row_major() const{
+	return _cs == 1;
+}
+
+template<class Elm>
+inline
+typename matrix_view<Elm>::value_type const& matrix_view<Elm>::element(int i, int j) const{
+	return _data[static_cast<std::ptrdiff_t>(i) * _rs + static_cast<std::ptrdiff_t>(j) * _cs];
+}
+
+/**
+ * 参照先がアドレス[first, last)と重なるか。<br>
+ */
+template<class Elm>
+inline
+bool matrix_view<Elm>::overlaps(void const* first, void const* last) const{
+	Elm* lo;
+	Elm* hi;
+
+	detail::view_extent(_data, _rows, _cols, _rs, _cs, lo, hi);
+
+	return expression::intersects(first, last, lo, hi);
+}
+
+/**
+ * 式xが参照先の要素を参照するか。<br>
+ */
+template<class Elm>
+template<class E>
+inline
+bool matrix_view<Elm>::aliased(E const& x) const{
+	Elm* lo;
+	Elm* hi;
+
+	detail::view_extent(_data, _rows, _cols, _rs, _cs, lo, hi);
+
+	return x.overlaps(lo, hi);
+}
+
+/**
+ * vector全体を参照する。<br>
+ */
+template<int N, class Elm>
+inline
+vector_view<Elm> view(vector<N, Elm>& v){
+	return vector_view<Elm>(v);
+}
+
+template<int N, class Elm>
+inline
+vector_view<Elm const> view(vector<N, Elm> const& v){
+	return vector_view<Elm const>(v);
+}
+
+/**
+ * matrix全体を参照する。<br>
+ */
+template<int N, int M, class Elm>
+inline
+matrix_view<Elm> view(matrix<N, M, Elm>& m){
+	return matrix_view<Elm>(m);
+}
+
+template<int N, int M, class Elm>
+inline
+matrix_view<Elm const> view(matrix<N, M, Elm> const& m){
+	return matrix_view<Elm const>(m);
+}
+
+/**
+ * matrixのi行目を参照する。<br>
+ */
+template<int N, int M, class Elm>
+inline
+vector_view<Elm> row_view(matrix<N, M, Elm>& m, int i){
+	return view(m).row(i);
+}
+
+template<int N, int M, class Elm>
+inline
+vector_view<Elm const> row_view(matrix<N, M, Elm> const& m, int i){
+	return view(m).row(i);
+}
+
+/**
+ * matrixのj列目を参照する。<br>
+ */
+template<int N, int M, class Elm>
+inline
+vector_view<Elm> column_view(matrix<N, M, Elm>& m, int j){
+	return view(m).column(j);
+}
+
+template<int N, int M, class Elm>
+inline
+vector_view<Elm const> column_view(matrix<N, M, Elm> const& m, int j){
+	return view(m).column(j);
+}
+
+/**
+ * matrixの部分行列を参照する。<br>
+ *
+ * @throw std::out_of_range 範囲がmに収まらない場合
+ */
+template<int N, int M, class Elm>
+inline
+matrix_view<Elm> block_view(matrix<N, M, Elm>& m, int row, int col, int rows, int cols){
+	return view(m).block(row, col, rows, cols);
+}
+
+template<int N, int M, class Elm>
+inline
+matrix_view<Elm const> block_view(matrix<N, M, Elm> const& m, int row, int col, int rows, int cols){
+	return view(m).block(row, col, rows, cols);
+}
+
+/**
+ * matrixの転置を参照する。コピーが必要な場合はtranspose()を使う。<br>
+ */
+template<int N, int M, class Elm>
+inline
+matrix_view<Elm> transpose_view(matrix<N, M, Elm>& m){
+	return view(m).transpose();
+}
+
+template<int N, int M, class Elm>
+inline
+matrix_view<Elm const> transpose_view(matrix<N, M, Elm> const& m){
+	return view(m).transpose();
+}
+
+/**
+ * ビューの内積を計算する。<br>
+ *
+ * @throw lib::exception::invalid_argument<> 要素数が一致しない場合
+ */
+template<class L, class R>
+inline
+typename vector_view<L>::value_type dot(vector_view<L> const& l, vector_view<R> const& r){
+	check_dimension(l.size(), r.size());
+
+	return kernel::dot(l.size(), l.data(), l.stride(), r.data(), r.stride());
+}
+
+/**
+ * y+= alpha*x を計算する。<br>
+ *
+ * @throw lib::exception::invalid_argument<> 要素数が一致しない場合
+ */
+template<class X, class Elm>
+inline
+void axpy(Elm const& alpha, vector_view<X> const& x, vector_view<Elm> const& y){
+	check_dimension(y.size(), x.size());
+
+	kernel::axpy(y.size(), alpha, x.data(), x.stride(), y.data(), y.stride());
+}
+
+/**
+ * x*= alpha を計算する。<br>
+ */
+template<class Elm>
+inline
+void scale(Elm const& alpha, vector_view<Elm> const& x){
+	kernel::scale(x.size(), alpha, x.data(), x.stride());
+}
+
+template<class Elm>
+inline
+typename vector_view<Elm>::value_type norm1(vector_view<Elm> const& v){
+	return kernel::norm1(v.size(), v.data(), v.stride());
+}
+
+template<class Elm>
+inline
+typename vector_view<Elm>::value_type norm2(vector_view<Elm> const& v){
+	return kernel::norm2(v.size(), v.data(), v.stride());
+}
+
+template<class Elm>
+inline
+typename vector_view<Elm>::value_type norm_inf(vector_view<Elm> const& v){
+	return kernel::norm_inf(v.size(), v.data(), v.stride());
+}
+
+/**
+ * y= alpha*A*x + beta*y を計算する。<br>
+ * Aが行優先ならkernel::gemv、列優先(行列の転置ビューなど)ならkernel::gemv_tで、
+ * コピーせずに計算する。<br>
+ *
+ * @param alpha A*xに掛ける係数
+ * @param a     行列
+ * @param x     ベクトル
+ * @param beta  yに掛ける係数
+ * @param y     更新されるベクトル
+ * @throw lib::exception::invalid_argument<> 次元が合わない場合
+ */
+template<class A, class X, class Elm>
+inline
+void gemv(Elm const& alpha, matrix_view<A> const& a, vector_view<X> const& x, Elm const& beta, vector_view<Elm> const& y){
+	check_dimension(a.cols(), x.size());
+	check_dimension(a.rows(), y.size());
+
+	if(a.col_stride() == 1){
+		kernel::gemv(a.rows(), a.cols(), alpha, a.data(), a.row_stride(), x.data(), x.stride(), beta, y.data(), y.stride());
+	}
+	else if(a.row_stride() == 1){
+		kernel::gemv_t(a.cols(), a.rows(), alpha, a.data(), a.col_stride(), x.data(), x.stride(), beta, y.data(), y.stride());
+	}
+	else{
+		for(int i= 0; i < a.rows(); ++i){
+			Elm const s= alpha * kernel::dot(a.cols(), a.data() + static_cast<std::ptrdiff_t>(i) * a.row_stride(), a.col_stride(), x.data(), x.stride());
+
+			y[i]= (beta == Elm()) ? s : s + beta * y[i];
+		}
+	}
+}
+
+/**
+ * 行列のビューとベクトルのビューの積を計算する。<br>
+ *
+ * @throw lib::exception::invalid_argument<> 次元が合わない場合
+ */
+template<class A, class X>
+inline
+vector<dynamic, typename matrix_view<A>::value_type> operator * (matrix_view<A> const& a, vector_view<X> const& x){
+	typedef typename matrix_view<A>::value_type value_type;
+
+	vector<dynamic, value_type> y(a.rows());
+
+	gemv(value_type(1), a, x, value_type(), view(y));
+
+	return y;
+}
+
+template<class A, int N>
+inline
+vector<dynamic, typename matrix_view<A>::value_type> operator * (matrix_view<A> const& a, vector<N, typename matrix_view<A>::value_type> const& x){
+	return a * view(x);
+}
+
+template<int N, int M, class Elm, class X>
+inline
+vector<N, Elm> operator * (matrix<N, M, Elm> const& a, vector_view<X> const& x){
+	vector<N, Elm> y(a.rows());
+
+	gemv(Elm(1), view(a), x, Elm(), view(y));
+
+	return y;
+}
+
+namespace detail{
+
+/**
+ * ビューを行優先に並べ直した領域を返す。既に行優先ならコピーしない。<br>
+ */
+template<class A>
+inline
+typename matrix_view<A>::value_type const* row_major(matrix_view<A> const& a, int& ld, std::vector<typename matrix_view<A>::value_type, memory::aligned_allocator<typename matrix_view<A>::value_type>>& buf){
+	if(a.col_stride() == 1){
+		ld= a.row_stride();
+		return a.data();
+	}
+
+	buf.resize(static_cast<std::size_t>(a.rows()) * a.cols());
+	ld= a.cols();
+	if(a.row_stride() == 1){
+		kernel::transpose(a.cols(), a.rows(), a.data(), a.col_stride(), buf.data(), ld);
+	}
+	else{
+		for(int i= 0; i < a.rows(); ++i)
+			for(int j= 0; j < a.cols(); ++j)
+				buf[static_cast<std::size_t>(i) * ld + j]= a.element(i, j);
+	}
+
+	return buf.data();
+}
+
+}
+
+/**
+ * C= alpha*A*B + beta*C を計算する。<br>
+ * 行優先のビューはそのままkernel::gemmに渡し、それ以外は一度行優先に並べ直す。<br>
+ *
+ * @param alpha A*Bに掛ける係数
+ * @param a     左辺
+ * @param b     右辺
+ * @param beta  Cに掛ける係数
+ * @param c     更新される行列
+ * @throw lib::exception::invalid_argument<> 次元が合わない場合
+ */
+template<class A, class B, class Elm>
+inline
+void gemm(Elm const& alpha, matrix_view<A> const& a, matrix_view<B> const& b, Elm const& beta, matrix_view<Elm> const& c){
+	check_dimension(a.cols(), b.rows());
+	check_dimension(a.rows(), c.rows());
+	check_dimension(b.cols(), c.cols());
+
+	std::vector<Elm, memory::aligned_allocator<Elm>> abuf, bbuf;
+	int lda= 0, ldb= 0;
+	Elm const* const pa= detail::row_major(a, lda, abuf);
+	Elm const* const pb= detail::row_major(b, ldb, bbuf);
+
+	if(c.col_stride() == 1){
+		kernel::gemm(c.rows(), c.cols(), a.cols(), alpha, pa, lda, pb, ldb, beta, c.data(), c.row_stride());
+	}
+	else{
+		matrix<dynamic, dynamic, Elm> buf(c.rows(), c.cols());
+
+		buf= c;
+		kernel::gemm(c.rows(), c.cols(), a.cols(), alpha, pa, lda, pb, ldb, beta, buf.data(), buf.cols());
+		c= buf;
+	}
+}
+
+/**
+ * 行列のビュー同士の積を計算する。<br>
+ *
+ * @throw lib::exception::invalid_argument<> 次元が合わない場合
+ */
+template<class A, class B>
+inline
+matrix<dynamic, dynamic, typename matrix_view<A>::value_type> operator * (matrix_view<A> const& a, matrix_view<B> const& b){
+	typedef typename matrix_view<A>::value_type value_type;
+
+	matrix<dynamic, dynamic, value_type> c(a.rows(), b.cols());
+
+	gemm(value_type(1), a, b, value_type(), view(c));
+
+	return c;
+}
+
+/**
+ * ビューの転置をコピーとして作る。<br>
+ * 行優先のビュー(部分行列など)はキャッシュ非依存の再帰分割で入れ替える。<br>
+ *
+ * @param a 行列のビュー
+ * @return
+ *     a.cols()行a.rows()列の行列
+ * @see kernel::transpose
+ */
+template<class A>
+inline
+matrix<dynamic, dynamic, typename matrix_view<A>::value_type> transpose(matrix_view<A> const& a){
+	matrix<dynamic, dynamic, typename matrix_view<A>::value_type> buf(a.cols(), a.rows());
+
+	if(a.col_stride() == 1)
+		kernel::transpose(a.rows(), a.cols(), a.data(), a.row_stride(), buf.data(), buf.cols());
+	else
+		buf= a.transpose();
+
+	return buf;
+}
+
+}
+}
+
+#endif // #ifndef LIB_MATH_VIEW_HPP_
@@ -0,0 +1,137 @@
+#ifndef LIB_MEMORY_ALIGNED_ALLOCATOR_HPP_
+#define LIB_MEMORY_ALIGNED_ALLOCATOR_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include "arena.hpp"
+
+namespace lib{
+namespace memory{
+
+/**
+ * Alignバイト境界に揃えた領域を確保するアロケータ。<br>
+ * SIMD命令やキャッシュラインを意識したバッファ向け。<br>
+ * 作った時点で現在のスレッドにarena_scopeでarenaが設定されていれば、ヒープの代わりにそのarenaから確保する。
+ * 確保先はアロケータが覚えているので、スコープの外で作ったコンテナはスコープの中で代入したり
+ * 大きくしたりしてもヒープを使い続け、arenaのreset()の影響を受けない。
+ * コピー構築したコンテナはその時点のスコープに従い、代入やswapでは確保先を持ち替えない。<br>
+ * ヒープからの確保はallocation_counterで数えられる。<br>
+ *
+ * @author  kamichidu
+ * @param <T>     要素の型
+ * @param <Align> アライメント(2の冪)
+ */
+template<class T, std::size_t Align= 64>
+class aligned_allocator{
+	public:
+		typedef T           value_type;
+		typedef T*          pointer;
+		typedef T const*    const_pointer;
+		typedef T&          reference;
+		typedef T const&    const_reference;
+		typedef std::size_t size_type;
+		typedef std::ptrdiff_t difference_type;
+
+		template<class U>
+			struct rebind{ typedef aligned_allocator<U, Align> other; };
+
+		typedef std::false_type propagate_on_container_copy_assignment;
+		typedef std::false_type propagate_on_container_move_assignment;
+		typedef std::false_type propagate_on_container_swap;
+		typedef std::false_type is_always_equal;
+
+		static std::size_t const alignment= Align;
+
+		static_assert(Align >= sizeof(void*) && (Align & (Align - 1)) == 0, "Align must be a power of 2");
+	public:
+		aligned_allocator() : _arena(current_arena()){}
+		template<class U>
+			aligned_allocator(aligned_allocator<U, Align> const& obj) : _arena(obj.source()){}
+	public:
+		T* allocate(std::size_t n);
+		void deallocate(T* p, std::size_t n);
+		aligned_allocator<T, Align> select_on_container_copy_construction() const;
+		arena* source() const;
+	private:
+		arena* _arena;
+};
+
+/**
+ * n個分の領域を確保する。<br>
+ * 確保した領域の直前に、解放用の元ポインタ(arenaから確保した場合はnullptr)を保持する。<br>
+ *
+ * @param n 要素数
+ * @return
+ *     Alignバイト境界に揃えられた領域
+ */
+template<class T, std::size_t Align>
+inline
+T* aligned_allocator<T, Align>::allocate(std::size_t n){
+	if(n == 0)
+		return nullptr;
+	if(n > (static_cast<std::size_t>(-1) - Align) / sizeof(T))
+		throw std::bad_alloc();
+
+	if(arena* const a= _arena){
+		char* const p= static_cast<char*>(a->allocate(n * sizeof(T) + Align, Align)) + Align;
+
+		reinterpret_cast<void**>(p)[-1]= nullptr;
+
+		return reinterpret_cast<T*>(p);
+	}
+
+	void* const raw= ::operator new(n * sizeof(T) + Align);
+	std::uintptr_t const aligned= (reinterpret_cast<std::uintptr_t>(raw) + Align) & ~static_cast<std::uintptr_t>(Align - 1);
+
+	detail::count_heap(n * sizeof(T) + Align);
+	reinterpret_cast<void**>(aligned)[-1]= raw;
+
+	return reinterpret_cast<T*>(aligned);
+}
+
+template<class T, std::size_t Align>
+inline
+void aligned_allocator<T, Align>::deallocate(T* p, std::size_t){
+	// arenaから確保した領域は元ポインタをnullptrにしてあり、arenaのreset()でまとめて解放される
+	if(p == nullptr || reinterpret_cast<void**>(p)[-1] == nullptr)
+		return;
+
+	::operator delete(reinterpret_cast<void**>(p)[-1]);
+}
+
+/**
+ * コピー構築したコンテナのアロケータ。複写元の確保先ではなく、現在のスレッドのarena(なければヒープ)を使う。<br>
+ */
+template<class T, std::size_t Align>
+inline
+aligned_allocator<T, Align> aligned_allocator<T, Align>::select_on_container_copy_construction() const{
+	return aligned_allocator<T, Align>();
+}
+
+/**
+ * 確保先のarena。ヒープから確保する場合はnullptr。<br>
+ */
+template<class T, std::size_t Align>
+inline
+arena* aligned_allocator<T, Align>::source() const{
+	return _arena;
+}
+
+template<class T, class U, std::size_t Align>
+inline
+bool operator == (aligned_allocator<T, Align> const& l, aligned_allocator<U, Align> const& r){
+	return l.source() == r.source();
+}
+
+template<class T, class U, std::size_t Align>
+inline
+bool operator != (aligned_allocator<T, Align> const& l, aligned_allocator<U, Align> const& r){
+	return !(l == r);
+}
+
+}
+}
+
+#endif // #ifndef LIB_MEMORY_ALIGNED_ALLOCATOR_HPP_
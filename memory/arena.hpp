@@ -0,0 +1,277 @@
+#ifndef LIB_MEMORY_ARENA_HPP_
+#define LIB_MEMORY_ARENA_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+namespace lib{
+namespace memory{
+
+/**
+ * aligned_allocatorが行った確保の累計。<br>
+ *
+ * @see allocation_counter
+ */
+struct allocation_statistics{
+	/** ヒープからの確保回数(arenaがブロックを確保した回数を含む) */
+	std::size_t heap_allocations;
+	/** ヒープから確保したバイト数 */
+	std::size_t heap_bytes;
+	/** arenaからの確保回数 */
+	std::size_t arena_allocations;
+	/** arenaから確保したバイト数 */
+	std::size_t arena_bytes;
+};
+
+namespace detail{
+
+struct allocation_totals{
+	std::atomic<std::size_t> heap_allocations;
+	std::atomic<std::size_t> heap_bytes;
+	std::atomic<std::size_t> arena_allocations;
+	std::atomic<std::size_t> arena_bytes;
+};
+
+inline
+allocation_totals& totals(){
+	static allocation_totals instance= {{0}, {0}, {0}, {0}};
+
+	return instance;
+}
+
+inline
+void count_heap(std::size_t bytes){
+	totals().heap_allocations.fetch_add(1, std::memory_order_relaxed);
+	totals().heap_bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+inline
+void count_arena(std::size_t bytes){
+	totals().arena_allocations.fetch_add(1, std::memory_order_relaxed);
+	totals().arena_bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+}
+
+/**
+ * 全スレッドでのaligned_allocatorによる確保の累計を返す。<br>
+ */
+inline
+allocation_statistics allocation_totals(){
+	detail::allocation_totals const& t= detail::totals();
+	allocation_statistics const s= {
+		t.heap_allocations.load(std::memory_order_relaxed),
+		t.heap_bytes.load(std::memory_order_relaxed),
+		t.arena_allocations.load(std::memory_order_relaxed),
+		t.arena_bytes.load(std::memory_order_relaxed),
+	};
+
+	return s;
+}
+
+/**
+ * 生成してからの確保回数を数える。<br>
+ * ループがヒープを使っていないことを確かめるためのもの。<br>
+ * <pre>
+ *     lib::memory::allocation_counter counter;
+ *     ...
+ *     assert(counter.heap_allocations() == 0);
+ * </pre>
+ * 全スレッドの確保を数えるので、並行して動く他の処理の確保も含まれる。<br>
+ * aligned_allocatorを通した確保だけを数え、std::allocatorを使うstd::vectorなどの確保は含まれない。
+ * ライブラリのvector、matrixとカーネルの作業領域はすべてaligned_allocatorを使う。<br>
+ *
+ * @author  kamichidu
+ */
+class allocation_counter{
+	public:
+		allocation_counter() : _start(allocation_totals()){}
+	public:
+		std::size_t heap_allocations() const{ return allocation_totals().heap_allocations - _start.heap_allocations; }
+		std::size_t heap_bytes() const{ return allocation_totals().heap_bytes - _start.heap_bytes; }
+		std::size_t arena_allocations() const{ return allocation_totals().arena_allocations - _start.arena_allocations; }
+		std::size_t arena_bytes() const{ return allocation_totals().arena_bytes - _start.arena_bytes; }
+		void reset(){ _start= allocation_totals(); }
+	private:
+		allocation_statistics _start;
+};
+
+/**
+ * 一時オブジェクト用のバンプアロケータ<br>
+ * 確保はポインタを進めるだけで、個別の解放は行わない。reset()でまとめて巻き戻す。<br>
+ * 容量が足りなくなるとブロックを追加し、reset()の時に全体を1つのブロックにまとめるので、
+ * 同じ計算を繰り返す場合は2回目以降ヒープを使わない。<br>
+ * スレッドセーフではない。arena_scopeで現在のスレッドに設定して使う。<br>
+ *
+ * @author  kamichidu
+ */
+class arena{
+	public:
+		explicit arena(std::size_t block_bytes= 1 << 20);
+		~arena();
+		arena(arena const&)= delete;
+		arena& operator = (arena const&)= delete;
+	public:
+		void* allocate(std::size_t bytes, std::size_t align);
+		void reset();
+		std::size_t used() const;
+		std::size_t capacity() const;
+	private:
+		struct block{
+			char* data;
+			std::size_t size;
+		};
+	private:
+		void add_block(std::size_t bytes);
+	private:
+		std::size_t _block_bytes;
+		std::vector<block> _blocks;
+		std::size_t _current;
+		std::size_t _offset;
+		std::size_t _used;
+};
+
+/**
+ * 容量0で初期化する。最初の確保でblock_bytes以上のブロックを確保する。<br>
+ *
+ * @param block_bytes 追加するブロックの最小バイト数
+ */
+inline
+arena::arena(std::size_t block_bytes) : _block_bytes(block_bytes), _current(0), _offset(0), _used(0){
+}
+
+inline
+arena::~arena(){
+	for(auto const& b : _blocks)
+		::operator delete(b.data);
+}
+
+/**
+ * bytesバイトをalignバイト境界に揃えて確保する。<br>
+ *
+ * @param bytes バイト数
+ * @param align アライメント(2の冪)
+ * @return
+ *     reset()か破棄まで有効な領域
+ */
+inline
+void* arena::allocate(std::size_t bytes, std::size_t align){
+	while(_current < _blocks.size()){
+		block const& b= _blocks[_current];
+		std::uintptr_t const base= reinterpret_cast<std::uintptr_t>(b.data);
+		std::uintptr_t const p= (base + _offset + align - 1) & ~static_cast<std::uintptr_t>(align - 1);
+
+		if(p + bytes <= base + b.size){
+			_offset= p + bytes - base;
+			_used+= bytes;
+			detail::count_arena(bytes);
+			return reinterpret_cast<void*>(p);
+		}
+		++_current;
+		_offset= 0;
+	}
+
+	add_block(bytes + align);
+
+	return allocate(bytes, align);
+}
+
+/**
+ * 確保したすべての領域を無効にして先頭に巻き戻す。<br>
+ * 複数のブロックを使っていた場合は、合計と同じ大きさの1つのブロックに置き換える。<br>
+ */
+inline
+void arena::reset(){
+	if(_blocks.size() > 1){
+		std::size_t const total= capacity();
+
+		for(auto const& b : _blocks)
+			::operator delete(b.data);
+		_blocks.clear();
+		add_block(total);
+	}
+	_current= 0;
+	_offset= 0;
+	_used= 0;
+}
+
+/**
+ * reset()以降に確保したバイト数。<br>
+ */
+inline
+std::size_t arena::used() const{
+	return _used;
+}
+
+/**
+ * 確保済みのブロックの合計バイト数。<br>
+ */
+inline
+std::size_t arena::capacity() const{
+	std::size_t total= 0;
+
+	for(auto const& b : _blocks)
+		total+= b.size;
+
+	return total;
+}
+
+inline
+void arena::add_block(std::size_t bytes){
+	std::size_t const size= std::max(bytes, _block_bytes);
+	block const b= {static_cast<char*>(::operator new(size)), size};
+
+	detail::count_heap(size);
+	_blocks.push_back(b);
+	_current= _blocks.size() - 1;
+	_offset= 0;
+}
+
+namespace detail{
+
+inline
+arena*& current_arena(){
+	static thread_local arena* current= nullptr;
+
+	return current;
+}
+
+}
+
+/**
+ * 現在のスレッドでaligned_allocatorが使うarenaを、このオブジェクトの寿命の間だけ切り替える。<br>
+ * スコープ内で作ったvectorやmatrix、カーネルの作業領域はarenaから確保され、
+ * 解放しても何もしない。arenaをreset()するまでに破棄するか、使わなくなっていること。
+ * スコープの外で作ったものは、スコープの中で代入したり大きくしたりしてもヒープを使う。<br>
+ * スレッドプールのワーカーが確保する領域は、そのワーカーにarenaが設定されていない限りヒープから確保する。<br>
+ * 入れ子にでき、nullptrを渡すとヒープに戻す。<br>
+ *
+ * @author  kamichidu
+ */
+class arena_scope{
+	public:
+		explicit arena_scope(arena* a) : _previous(detail::current_arena()){ detail::current_arena()= a; }
+		explicit arena_scope(arena& a) : arena_scope(&a){}
+		~arena_scope(){ detail::current_arena()= _previous; }
+		arena_scope(arena_scope const&)= delete;
+		arena_scope& operator = (arena_scope const&)= delete;
+	private:
+		arena* _previous;
+};
+
+/**
+ * 現在のスレッドで有効なarena。なければnullptr。<br>
+ */
+inline
+arena* current_arena(){
+	return detail::current_arena();
+}
+
+}
+}
+
+#endif // #ifndef LIB_MEMORY_ARENA_HPP_
@@ -0,0 +1,465 @@
+#ifndef LIB_THREAD_POOL_HPP_
+#define LIB_THREAD_POOL_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lib{
+namespace thread{
+
+class pool;
+
+namespace detail{
+
+/**
+ * 1回のparallel_for/parallel_reduceで生成したタスクの完了を待つための組。<br>
+ * 最初に投げられた例外を保持し、呼び出し元で投げ直す。<br>
+ */
+struct task_group{
+	std::atomic<int> pending;
+	std::mutex mutex;
+	std::exception_ptr error;
+
+	task_group() : pending(0){}
+
+	void fail(std::exception_ptr e){
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if(!error)
+			error= e;
+	}
+};
+
+struct task{
+	std::function<void()> run;
+	task_group* group;
+};
+
+/**
+ * ワーカーごとのタスクの両端キュー。<br>
+ * 持ち主は後ろから取り出し(LIFO)、他のワーカーは前から盗む(FIFO)。
+ * 前にあるタスクほど分割前の大きな範囲なので、盗んだ側は大きな仕事を持っていく。<br>
+ */
+class task_deque{
+	public:
+		void push(task&& t){
+			std::lock_guard<std::mutex> lock(_mutex);
+
+			_tasks.push_back(std::move(t));
+		}
+		bool pop(task& t){
+			std::lock_guard<std::mutex> lock(_mutex);
+
+			if(_tasks.empty())
+				return false;
+			t= std::move(_tasks.back());
+			_tasks.pop_back();
+			return true;
+		}
+		bool steal(task& t){
+			std::lock_guard<std::mutex> lock(_mutex);
+
+			if(_tasks.empty())
+				return false;
+			t= std::move(_tasks.front());
+			_tasks.pop_front();
+			return true;
+		}
+	private:
+		std::mutex _mutex;
+		std::deque<task> _tasks;
+};
+
+/**
+ * 現在のスレッドがどのpoolの何番目のワーカーか。ワーカーでなければownerはnullptr。<br>
+ */
+struct worker_slot{
+	pool const* owner;
+	int index;
+};
+
+inline
+worker_slot& current_worker(){
+	static thread_local worker_slot slot= {nullptr, -1};
+
+	return slot;
+}
+
+}
+
+/**
+ * ワークスティーリング方式のスレッドプール<br>
+ * parallel_for/parallel_reduceは範囲を半分ずつに分けながらタスクを積み、
+ * 暇なワーカーが他のワーカーのキューから盗んで実行する。
+ * 完了を待つスレッドも待っている間はタスクを実行するので、
+ * タスクの中からさらにparallel_forを呼んでもデッドロックしない。<br>
+ * 呼び出したスレッド自身も計算に加わるため、並列度はworkers() + 1になる。
+ * workers()が0ならすべて呼び出したスレッドで順に実行する。<br>
+ * ライブラリ内の並列処理はdefault_pool()を共有する。<br>
+ *
+ * @author  kamichidu
+ */
+class pool{
+	public:
+		explicit pool(int workers);
+		~pool();
+		pool(pool const&)= delete;
+		pool& operator = (pool const&)= delete;
+	public:
+		template<class F>
+			void parallel_for(int first, int last, int grain, F const& f);
+		template<class T, class Map, class Reduce>
+			T parallel_reduce(int first, int last, int grain, T const& identity, Map const& map, Reduce const& reduce);
+		void resize(int workers);
+		int workers() const;
+		int concurrency() const;
+		int grain_size(int n) const;
+	public:
+		static int default_workers();
+	private:
+		template<class F>
+			void split(int first, int last, int grain, F const& f, detail::task_group& group);
+		void spawn(detail::task&& t);
+		void wait(detail::task_group& group);
+		bool take(int self, detail::task& t);
+		void execute(detail::task& t);
+		void start(int workers);
+		void stop();
+		void worker_loop(int index);
+		int self_index() const;
+	private:
+		std::vector<std::thread> _threads;
+		// ワーカーごとのキューと、ワーカー以外のスレッドが積むキュー(末尾)
+		std::vector<std::unique_ptr<detail::task_deque>> _deques;
+		std::atomic<int> _queued;
+		std::mutex _mutex;
+		std::condition_variable _wake;
+		bool _stopping;
+};
+
+/**
+ * workers個のワーカースレッドを起動する。<br>
+ *
+ * @param workers ワーカー数(0以上)
+ */
+inline
+pool::pool(int workers) : _queued(0), _stopping(false){
+	start(workers);
+}
+
+inline
+pool::~pool(){
+	stop();
+}
+
+/**
+ * [first, last)をgrain個以下の範囲に分け、各範囲についてf(begin, end)を並列に呼ぶ。<br>
+ * fは異なる範囲について同時に呼ばれる。例外が投げられた場合は、
+ * すべての範囲が終わった後に最初の例外を投げ直す。<br>
+ *
+ * @param first 先頭
+ * @param last  末尾の次
+ * @param grain 1つのタスクで処理する最大の個数(0以下ならgrain_size()で決める)
+ * @param f     void(int, int)として呼べる関数
+ */
+template<class F>
+inline
+void pool::parallel_for(int first, int last, int grain, F const& f){
+	if(last <= first)
+		return;
+	if(grain <= 0)
+		grain= grain_size(last - first);
+	if(_threads.empty() || last - first <= grain){
+		f(first, last);
+		return;
+	}
+
+	detail::task_group group;
+
+	try{
+		split(first, last, grain, f, group);
+	}
+	catch(...){
+		group.fail(std::current_exception());
+	}
+	wait(group);
+
+	if(group.error)
+		std::rethrow_exception(group.error);
+}
+
+/**
+ * [first, last)をgrain個ずつの範囲に分けてmap(begin, end)を並列に計算し、
+ * 結果を範囲の順にreduceで畳み込む。<br>
+ * 範囲の分け方はfirst、last、grainだけで決まるので、grainを指定すれば
+ * 浮動小数点の和でもワーカー数によらず同じ結果になる。<br>
+ *
+ * @param first    先頭
+ * @param last     末尾の次
+ * @param grain    1つの範囲の個数(0以下ならgrain_size()で決める)
+ * @param identity reduceの単位元
+ * @param map      T(int, int)として呼べる関数
+ * @param reduce   T(T, T)として呼べる結合的な関数
+ * @return
+ *     reduce(...reduce(reduce(identity, map(first, first + grain)), ...)
+ */
+template<class T, class Map, class Reduce>
+inline
+T pool::parallel_reduce(int first, int last, int grain, T const& identity, Map const& map, Reduce const& reduce){
+	if(last <= first)
+		return identity;
+	if(grain <= 0)
+		grain= grain_size(last - first);
+
+	int const chunks= static_cast<int>((static_cast<long long>(last - first) + grain - 1) / grain);
+	std::vector<T> partial(chunks, identity);
+
+	parallel_for(0, chunks, 1, [&](int c0, int c1){
+		for(int c= c0; c < c1; ++c){
+			int const b= first + static_cast<int>(static_cast<long long>(c) * grain);
+
+			partial[c]= map(b, static_cast<int>(std::min<long long>(static_cast<long long>(b) + grain, last)));
+		}
+	});
+
+	T r= identity;
+
+	for(auto const& p : partial)
+		r= reduce(r, p);
+
+	return r;
+}
+
+/**
+ * ワーカー数を変える。実行中のタスクがない時に呼ぶこと。<br>
+ *
+ * @param workers ワーカー数(0以上)
+ */
+inline
+void pool::resize(int workers){
+	stop();
+	start(workers);
+}
+
+inline
+int pool::workers() const{
+	return static_cast<int>(_threads.size());
+}
+
+/**
+ * 同時に計算に加わるスレッド数。<br>
+ *
+ * @return
+ *     workers() + 1
+ */
+inline
+int pool::concurrency() const{
+	return workers() + 1;
+}
+
+/**
+ * n個の要素を分ける既定の粒度。<br>
+ * 盗み合いで負荷が均せるよう、並列度の8倍程度のタスクになるようにする。<br>
+ */
+inline
+int pool::grain_size(int n) const{
+	return std::max(1, n / (8 * concurrency()));
+}
+
+/**
+ * 既定のワーカー数。<br>
+ * 環境変数LIB_THREAD_WORKERSがあればその値、なければハードウェアスレッド数 - 1。<br>
+ */
+inline
+int pool::default_workers(){
+	if(char const* const env= std::getenv("LIB_THREAD_WORKERS"))
+		return std::max(0, std::atoi(env));
+
+	return std::max(0, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+}
+
+template<class F>
+inline
+void pool::split(int first, int last, int grain, F const& f, detail::task_group& group){
+	while(last - first > grain){
+		int const mid= first + (last - first) / 2;
+		int const end= last;
+
+		group.pending.fetch_add(1, std::memory_order_relaxed);
+		spawn(detail::task{[this, mid, end, grain, &f, &group](){ split(mid, end, grain, f, group); }, &group});
+		last= mid;
+	}
+	f(first, last);
+}
+
+inline
+void pool::spawn(detail::task&& t){
+	_deques[self_index()]->push(std::move(t));
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		_queued.fetch_add(1, std::memory_order_release);
+	}
+	_wake.notify_one();
+}
+
+/**
+ * groupのタスクがすべて終わるまで、手近なタスクを実行しながら待つ。<br>
+ */
+inline
+void pool::wait(detail::task_group& group){
+	int const self= self_index();
+	detail::task t;
+
+	while(group.pending.load(std::memory_order_acquire) > 0){
+		if(take(self, t))
+			execute(t);
+		else
+			std::this_thread::yield();
+	}
+}
+
+/**
+ * 自分のキューの後ろから、空なら他のキューの前からタスクを取り出す。<br>
+ */
+inline
+bool pool::take(int self, detail::task& t){
+	int const n= static_cast<int>(_deques.size());
+
+	if(_deques[self]->pop(t)){
+		_queued.fetch_sub(1, std::memory_order_relaxed);
+		return true;
+	}
+	for(int i= 1; i < n; ++i){
+		if(_deques[(self + i) % n]->steal(t)){
+			_queued.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+inline
+void pool::execute(detail::task& t){
+	detail::task_group* const group= t.group;
+
+	try{
+		t.run();
+	}
+	catch(...){
+		group->fail(std::current_exception());
+	}
+	t.run= nullptr;
+	group->pending.fetch_sub(1, std::memory_order_release);
+}
+
+inline
+void pool::start(int workers){
+	workers= std::max(0, workers);
+	_stopping= false;
+	_deques.clear();
+	for(int i= 0; i <= workers; ++i)
+		_deques.push_back(std::unique_ptr<detail::task_deque>(new detail::task_deque()));
+	for(int i= 0; i < workers; ++i)
+		_threads.push_back(std::thread(&pool::worker_loop, this, i));
+}
+
+inline
+void pool::stop(){
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		_stopping= true;
+	}
+	_wake.notify_all();
+	for(auto& t : _threads)
+		t.join();
+	_threads.clear();
+}
+
+inline
+void pool::worker_loop(int index){
+	detail::current_worker()= detail::worker_slot{this, index};
+
+	detail::task t;
+
+	for(;;){
+		if(take(index, t)){
+			execute(t);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(_mutex);
+
+		_wake.wait(lock, [this]{ return _stopping || _queued.load(std::memory_order_acquire) > 0; });
+		if(_stopping && _queued.load(std::memory_order_acquire) == 0)
+			break;
+	}
+
+	detail::current_worker()= detail::worker_slot{nullptr, -1};
+}
+
+/**
+ * 現在のスレッドが使うキューの添字。このpoolのワーカーでなければ共有のキュー。<br>
+ */
+inline
+int pool::self_index() const{
+	detail::worker_slot const& slot= detail::current_worker();
+
+	return (slot.owner == this) ? slot.index : static_cast<int>(_deques.size()) - 1;
+}
+
+/**
+ * ライブラリ全体で共有するプール。<br>
+ * 最初に使われた時にpool::default_workers()個のワーカーで起動する。
+ * ワーカー数はresize()で変えられる。<br>
+ */
+inline
+pool& default_pool(){
+	static pool instance(pool::default_workers());
+
+	return instance;
+}
+
+/**
+ * default_pool()でparallel_forを呼ぶ。<br>
+ *
+ * @see pool::parallel_for
+ */
+template<class F>
+inline
+void parallel_for(int first, int last, int grain, F const& f){
+	default_pool().parallel_for(first, last, grain, f);
+}
+
+template<class F>
+inline
+void parallel_for(int first, int last, F const& f){
+	default_pool().parallel_for(first, last, 0, f);
+}
+
+/**
+ * default_pool()でparallel_reduceを呼ぶ。<br>
+ *
+ * @see pool::parallel_reduce
+ */
+template<class T, class Map, class Reduce>
+inline
+T parallel_reduce(int first, int last, int grain, T const& identity, Map const& map, Reduce const& reduce){
+	return default_pool().parallel_reduce(first, last, grain, identity, map, reduce);
+}
+
+}
+}
+
+#endif // #ifndef LIB_THREAD_POOL_HPP_
@@ -2,6 +2,7 @@
 #define LIB_CSTOPWATCH_HPP_
 
 #include <sys/time.h>
+#include "../math/hdr_histogram.hpp"
 
 namespace lib{
 namespace time{
@@ -23,6 +24,7 @@ class stop_watch{
 	public:
 		void start();
 		void stop();
+		void record_to(lib::math::hdr_histogram* histogram);
 	public:
 		time_t time() const;
 		unit_type unit() const;
@@ -32,10 +34,11 @@ class stop_watch{
 		unit_type _unit;
 		time_t _last_time;
 		timeval _snap;
+		lib::math::hdr_histogram* _histogram;
 };
 
 inline
-stop_watch::stop_watch(unit_type unit) : _unit(unit){
+stop_watch::stop_watch(unit_type unit) : _unit(unit), _histogram(nullptr){
 	_snap.tv_sec=  0;
 	_snap.tv_usec= 0;
 	_last_time=    0;
@@ -47,6 +50,7 @@ stop_watch::~stop_watch(){
 	_snap.tv_sec=  0;
 	_snap.tv_usec= 0;
 	_last_time=    0;
+	_histogram=    nullptr;
 }
 
 inline
@@ -61,6 +65,19 @@ void stop_watch::stop(){
 	gettimeofday(&_snap, nullptr);
 
 	_last_time= interval(tmp, _snap);
+	if(_histogram)
+		_histogram->record(_last_time);
+}
+
+/**
+ * 以降のstop()で計測した時間(マイクロ秒)をhistogramに記録する。<br>
+ * 計測値を保持せずに分布だけを集められる。nullptrを渡すと記録をやめる。<br>
+ *
+ * @param histogram 記録先。stop_watchより長く生存すること
+ */
+inline
+void stop_watch::record_to(lib::math::hdr_histogram* histogram){
+	_histogram= histogram;
 }
 
 inline